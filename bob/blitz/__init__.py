@@ -3,7 +3,9 @@
 # Andre Anjos <andre.anjos@idiap.ch>
 # Fri 20 Sep 14:45:01 2013
 
-from ._library import array, as_blitz
+from ._library import array, as_blitz, shared_memory, expr, set_allocator, \
+    get_allocator, set_cache_limit, cache_stats, set_num_threads, \
+    get_num_threads, stats, trace_copies, tracemalloc_domain
 from . import version
 from .version import module as __version__
 from .version import api as __api_version__
@@ -9,7 +9,25 @@
 #include <bob.blitz/cppapi.h>
 #include <bob.blitz/cleanup.h>
 #include <bob.extension/defines.h>
+#include "internal.h"
 #include <algorithm>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <utility>
+#include <functional>
+
+extern int PyBlitzExpr_Check(PyObject* o);
+extern int PyBlitzExpr_EvalInto(PyObject* o, PyBlitzArrayObject* out);
 
 /*******************
  * Non-API Helpers *
@@ -93,6 +111,12 @@ int PyBlitzArray_CheckNumpyBase(PyArrayObject* o) {
   for (Py_ssize_t i=0; i<bo->ndim; ++i)
     if (bo->shape[i] != PyArray_DIMS(o)[i]) return 0;
 
+  // views sharing the same base may still be sliced, reversed, etc.
+  if (PyArray_DATA(o) != bo->data) return 0;
+
+  for (Py_ssize_t i=0; i<bo->ndim; ++i)
+    if (bo->stride[i] != PyArray_STRIDES(o)[i]) return 0;
+
   return 1;
 }
 
@@ -165,376 +189,781 @@ PyObject* PyBlitzArray_PyBASE(PyBlitzArrayObject* o) {
   Py_RETURN_NONE;
 }
 
-/************
- * Indexing *
- ************/
+/* Not part of the C-API: stops the data of `o', and of the arrays it is a
+   view of, from being released by PyBlitzArray_SimpleInit() while it is used
+   without the GIL. Both require the GIL. */
+void PyBlitzArray_PinData(PyBlitzArrayObject* o) {
+  for (PyObject* p = reinterpret_cast<PyObject*>(o); p && PyBlitzArray_Check(p);
+      p = reinterpret_cast<PyBlitzArrayObject*>(p)->base)
+    ++reinterpret_cast<PyBlitzArrayObject*>(p)->exports;
+}
 
-template <typename T>
-PyObject* getitem_inner(PyBlitzArrayObject* o, Py_ssize_t* pos) {
+void PyBlitzArray_UnpinData(PyBlitzArrayObject* o) {
+  for (PyObject* p = reinterpret_cast<PyObject*>(o); p && PyBlitzArray_Check(p);
+      p = reinterpret_cast<PyBlitzArrayObject*>(p)->base)
+    --reinterpret_cast<PyBlitzArrayObject*>(p)->exports;
+}
 
-  Py_ssize_t tmp[BOB_BLITZ_MAXDIMS];
+/**************************
+ * Per-(T,N) Dispatching *
+ **************************/
 
-  /* Fix negative indexes and check ranges */
-  for (Py_ssize_t i=0; i<o->ndim; ++i) {
-    tmp[i] = pos[i];
-    if (tmp[i] < 0) tmp[i] += o->shape[i];
-    if (tmp[i] < 0 || tmp[i] >= o->shape[i]) {
-      PyErr_Format(PyExc_IndexError, "%s(@%" PY_FORMAT_SIZE_T "d,'%s') position %" PY_FORMAT_SIZE_T "d is out of range: %" PY_FORMAT_SIZE_T "d not in [0,%" PY_FORMAT_SIZE_T "d[", Py_TYPE(o)->tp_name, o->ndim, PyBlitzArray_TypenumAsString(o->type_num), i, pos[i], o->shape[i]);
+/**
+ * Operations on the typed blitz::Array<T,N> held by a PyBlitzArrayObject. One
+ * of these is built at compile time for each supported (T,N) pair and a
+ * pointer to it is stored in the object on construction, so operations need
+ * a single indirect call instead of switching on type_num and ndim.
+ */
+struct PyBlitzArrayVtable {
+  PyObject* (*getitem)(PyBlitzArrayObject* o, Py_ssize_t* pos);
+  int (*setitem)(PyBlitzArrayObject* o, Py_ssize_t* pos, PyObject* value);
+  void (*deallocate)(PyBlitzArrayObject* o);
+  int (*simplenew)(PyBlitzArrayObject* arr, int type_num, Py_ssize_t ndim, Py_ssize_t* shape);
+  PyObject* (*simplenewfromdata)(int type_num, Py_ssize_t ndim, Py_ssize_t* shape, Py_ssize_t* stride, void* data, int writeable);
+  void (*assign)(PyBlitzArrayObject* dst, PyBlitzArrayObject* src);
+  int (*fill)(PyBlitzArrayObject* dst, PyObject* value);
+  void (*take)(PyBlitzArrayObject* o, const npy_intp* offsets, npy_intp count, void* out);
+  void (*put)(PyBlitzArrayObject* o, const npy_intp* offsets, npy_intp count, const void* values, npy_intp step);
+  void (*arithmetic)(char op, PyBlitzArrayObject* out, PyBlitzArrayObject* a, PyBlitzArrayObject* b);
+  void (*compare)(int op, PyBlitzArrayObject* out, PyBlitzArrayObject* a, PyBlitzArrayObject* b);
+};
+
+template <typename T, int N> struct vtable_entry {
+  static const PyBlitzArrayVtable value;
+};
+
+/**
+ * Fixes negative indexes and checks ranges, returns 0 on failure
+ */
+template <int N>
+int check_position(PyBlitzArrayObject* o, Py_ssize_t* pos, blitz::TinyVector<int,N>& tmp) {
+
+  for (int i=0; i<N; ++i) {
+    Py_ssize_t k = pos[i];
+    if (k < 0) k += o->shape[i];
+    if (k < 0 || k >= o->shape[i]) {
+      PyErr_Format(PyExc_IndexError, "%s(@%" PY_FORMAT_SIZE_T "d,'%s') position %d is out of range: %" PY_FORMAT_SIZE_T "d not in [0,%" PY_FORMAT_SIZE_T "d[", Py_TYPE(o)->tp_name, o->ndim, PyBlitzArray_TypenumAsString(o->type_num), i, pos[i], o->shape[i]);
       return 0;
     }
+    tmp(i) = k;
   }
 
-  /* If you get to this point, then you known the indexing is fine */
-
-  switch (o->ndim) {
+  return 1;
+}
 
-    case 1:
-      {
-        T& val = (*reinterpret_cast<blitz::Array<T,1>*>(o->bzarr))((int)tmp[0]);
-        return PyArray_Scalar(&val, PyArray_DescrFromType(o->type_num), 0);
-      }
+/************
+ * Indexing *
+ ************/
 
-    case 2:
-      {
-        T& val = (*reinterpret_cast<blitz::Array<T,2>*>(o->bzarr))((int)tmp[0], (int)tmp[1]);
-        return PyArray_Scalar(&val, PyArray_DescrFromType(o->type_num), 0);
-      }
+template <typename T, int N>
+PyObject* getitem_inner(PyBlitzArrayObject* o, Py_ssize_t* pos) {
 
-    case 3:
-      {
-        T& val = (*reinterpret_cast<blitz::Array<T,3>*>(o->bzarr))((int)tmp[0], (int)tmp[1], (int)tmp[2]);
-        return PyArray_Scalar(&val, PyArray_DescrFromType(o->type_num), 0);
-      }
+  blitz::TinyVector<int,N> tmp;
+  if (!check_position<N>(o, pos, tmp)) return 0;
 
-    case 4:
-      {
-        T& val = (*reinterpret_cast<blitz::Array<T,2>*>(o->bzarr))((int)tmp[0], (int)tmp[1], (int)tmp[2], (int)tmp[3]);
-        return PyArray_Scalar(&val, PyArray_DescrFromType(o->type_num), 0);
-      }
+  /* If you get to this point, then you known the indexing is fine */
+  T& val = (*reinterpret_cast<blitz::Array<T,N>*>(o->bzarr))(tmp);
+  PyArray_Descr* descr = PyArray_DescrFromType(o->type_num);
+  PyObject* retval = PyArray_Scalar(&val, descr, 0);
+  Py_DECREF(descr);
+  return retval;
 
-    default:
-      PyErr_Format(PyExc_NotImplementedError, "cannot index %s(@%" PY_FORMAT_SIZE_T "d,'%s'): this number of dimensions is outside the range of supported dimensions [1,%d]", Py_TYPE(o)->tp_name, o->ndim, PyBlitzArray_TypenumAsString(o->type_num), BOB_BLITZ_MAXDIMS); return 0;
-  }
 }
 
 PyObject* PyBlitzArray_GetItem(PyBlitzArrayObject* o, Py_ssize_t* pos) {
 
-  switch (o->type_num) {
+  if (!o->vtable) {
+    PyErr_Format(PyExc_NotImplementedError, "cannot index %s(@%" PY_FORMAT_SIZE_T "d,T) with T being a data type with an unsupported numpy type number = %d", Py_TYPE(o)->tp_name, o->ndim, o->type_num);
+    return 0;
+  }
 
-    case NPY_BOOL:
-      return getitem_inner<bool>(o, pos);
+  return o->vtable->getitem(o, pos);
 
-    case NPY_INT8:
-      return getitem_inner<int8_t>(o, pos);
+}
 
-    case NPY_INT16:
-      return getitem_inner<int16_t>(o, pos);
+/**
+ * Sets a given item from the blitz::Array<>
+ */
+template <typename T, int N>
+int setitem_inner(PyBlitzArrayObject* o, Py_ssize_t* pos, PyObject* value) {
 
-    case NPY_INT32:
-      return getitem_inner<int32_t>(o, pos);
+  blitz::TinyVector<int,N> tmp;
+  if (!check_position<N>(o, pos, tmp)) return -1;
 
-    case NPY_INT64:
-      return getitem_inner<int64_t>(o, pos);
+  /* If you get to this point, then you known the indexing is fine */
+  T c_value = PyBlitzArrayCxx_AsCScalar<T>(value);
+  if (PyErr_Occurred()) return -1;
+  (*reinterpret_cast<blitz::Array<T,N>*>(o->bzarr))(tmp) = c_value;
+  return 0;
 
-    case NPY_UINT8:
-      return getitem_inner<uint8_t>(o, pos);
+}
 
-    case NPY_UINT16:
-      return getitem_inner<uint16_t>(o, pos);
+int PyBlitzArray_SetItem(PyBlitzArrayObject* o, Py_ssize_t* pos, PyObject* value) {
 
-    case NPY_UINT32:
-      return getitem_inner<uint32_t>(o, pos);
+  if (!o->writeable) {
+    PyErr_Format(PyExc_RuntimeError, "cannot set item on read-only %s(@%" PY_FORMAT_SIZE_T "d,%s) ", Py_TYPE(o)->tp_name, o->ndim, PyBlitzArray_TypenumAsString(o->type_num));
+    return -1;
+  }
 
-    case NPY_UINT64:
-      return getitem_inner<uint64_t>(o, pos);
+  if (!o->vtable) {
+    PyErr_Format(PyExc_NotImplementedError, "cannot set item on %s(@%" PY_FORMAT_SIZE_T "d,T) with T being a data type with an unsupported numpy type number = %d", Py_TYPE(o)->tp_name, o->ndim, o->type_num);
+    return -1;
+  }
 
-    case NPY_FLOAT32:
-      return getitem_inner<float>(o, pos);
+  return o->vtable->setitem(o, pos, value);
 
-    case NPY_FLOAT64:
-      return getitem_inner<double>(o, pos);
+}
 
-#ifdef NPY_FLOAT128
-    case NPY_FLOAT128:
-      return getitem_inner<long double>(o, pos);
+/**
+ * Splits the positions of `a' into (at most) `tiles' boxes, cutting along its
+ * outermost dimension with enough positions, so that tiles of C-contiguous
+ * arrays stay contiguous, or else along its largest one
+ */
+template <typename T, int N>
+std::vector<blitz::RectDomain<N>> tile_domains(const blitz::Array<T,N>& a,
+    Py_ssize_t tiles) {
+
+  int dim = 0;
+  for (int i=0; i<N; ++i) if (a.extent(i) > a.extent(dim)) dim = i;
+  for (int i=N-1; i>=0; --i) if (a.extent(i) >= tiles) dim = i;
+  tiles = std::min<Py_ssize_t>(tiles, a.extent(dim));
+
+  blitz::TinyVector<int,N> lbound;
+  blitz::TinyVector<int,N> ubound;
+  for (int i=0; i<N; ++i) {
+    lbound(i) = a.lbound(i);
+    ubound(i) = a.ubound(i);
+  }
 
-#endif
+  std::vector<blitz::RectDomain<N>> retval;
+  for (Py_ssize_t t=0; t<tiles; ++t) {
+    lbound(dim) = a.lbound(dim) + (t * a.extent(dim)) / tiles;
+    ubound(dim) = a.lbound(dim) + ((t + 1) * a.extent(dim)) / tiles - 1;
+    retval.push_back(blitz::RectDomain<N>(lbound, ubound));
+  }
+  return retval;
 
-    case NPY_COMPLEX64:
-      return getitem_inner<std::complex<float>>(o, pos);
+}
 
-    case NPY_COMPLEX128:
-      return getitem_inner<std::complex<double>>(o, pos);
+/**
+ * Views on the tiles of `a'. These do not reference the blitz::MemoryBlock of
+ * `a', whose reference count is not atomic, and which may be shared with
+ * arrays used by threads holding the GIL. Each tile gets a memory block (not
+ * owning the data) of its own instead.
+ */
+template <typename T, int N>
+std::vector<blitz::Array<T,N>> tile_views(blitz::Array<T,N>& a,
+    const std::vector<blitz::RectDomain<N>>& domains) {
+
+  blitz::TinyVector<int,N> ordering;
+  blitz::TinyVector<bool,N> ascending;
+  for (int i=0; i<N; ++i) {
+    ordering(i) = a.ordering(i);
+    ascending(i) = a.isRankStoredAscending(i);
+  }
+  blitz::GeneralArrayStorage<N> storage(ordering, ascending);
+  storage.base() = a.base();
 
-#ifdef NPY_COMPLEX256
-    case NPY_COMPLEX256:
-      return getitem_inner<std::complex<long double>>(o, pos);
+  std::vector<blitz::Array<T,N>> retval;
+  for (auto& d : domains) {
+    blitz::TinyVector<int,N> lbound;
+    blitz::TinyVector<int,N> extent;
+    for (int i=0; i<N; ++i) {
+      lbound(i) = d.lbound(i);
+      extent(i) = d.ubound(i) - d.lbound(i) + 1;
+    }
+    //blitz++ expects the lowest address of dimensions stored in descending
+    //order, instead of the address of the first element
+    T* first = &a(lbound);
+    for (int i=0; i<N; ++i)
+      if (!ascending(i) && extent(i) > 0) first += a.stride(i) * (extent(i)-1);
+    retval.push_back(blitz::Array<T,N>(first, extent, a.stride(),
+          blitz::neverDeleteData, storage));
+  }
+  return retval;
 
-#endif
+}
 
-    default:
-      PyErr_Format(PyExc_NotImplementedError, "cannot index %s(@%" PY_FORMAT_SIZE_T "d,T) with T being a data type with an unsupported numpy type number = %d", Py_TYPE(o)->tp_name, o->ndim, o->type_num);
-      return 0;
+template <typename F, typename... V>
+void run_tiles(F& kernel, Py_ssize_t tiles, std::vector<V>&&... views) {
+  PyBlitzThreads_Run(tiles, PyBlitzThreads_Get(),
+      [&](Py_ssize_t t, int) { kernel(views[t]...); });
+}
+
+/**
+ * Calls `kernel' on arrays of the same shape, the first one being written to.
+ * Large arrays are split into tiles processed in parallel by the thread pool,
+ * which must be called without holding the GIL. Views on tiles are made and
+ * destroyed by the calling thread, without touching the reference counts of
+ * the arrays (see tile_views()).
+ */
+template <int N, typename F, typename O, typename... T>
+void tiled(F kernel, blitz::Array<O,N>& out, blitz::Array<T,N>&... in) {
 
+  const Py_ssize_t tiles = PyBlitzThreads_Tiles(out.numElements(), sizeof(O));
+  if (tiles < 2) {
+    kernel(out, in...);
+    return;
   }
 
+  const std::vector<blitz::RectDomain<N>> domains = tile_domains(out, tiles);
+  run_tiles(kernel, domains.size(), tile_views(out, domains),
+      tile_views(in, domains)...);
+
 }
 
 /**
- * Sets a given item from the blitz::Array<>
+ * Copies all elements of `src' into `dst', which have the same type and shape
  */
-template <typename T>
-int setitem_inner(PyBlitzArrayObject* o, Py_ssize_t* pos, PyObject* value) {
+template <typename T, int N>
+void assign_inner(PyBlitzArrayObject* dst, PyBlitzArrayObject* src) {
 
-  Py_ssize_t tmp[BOB_BLITZ_MAXDIMS];
+  blitz::Array<T,N>& o = *reinterpret_cast<blitz::Array<T,N>*>(dst->bzarr);
+  blitz::Array<T,N>& x = *reinterpret_cast<blitz::Array<T,N>*>(src->bzarr);
 
-  /* Fix negative indexes and check ranges */
-  for (Py_ssize_t i=0; i<o->ndim; ++i) {
-    tmp[i] = pos[i];
-    if (tmp[i] < 0) tmp[i] += o->shape[i];
-    if (tmp[i] < 0 || tmp[i] >= o->shape[i]) {
-      PyErr_Format(PyExc_IndexError, "array index (tmpition %" PY_FORMAT_SIZE_T "d) is out of range: %" PY_FORMAT_SIZE_T "d not in [0,%" PY_FORMAT_SIZE_T "d[", i, pos[i], o->shape[i]);
-      return -1;
-    }
-  }
+  PyBlitzArray_PinData(dst);
+  PyBlitzArray_PinData(src);
+  Py_BEGIN_ALLOW_THREADS
+  tiled([](blitz::Array<T,N>& o, const blitz::Array<T,N>& x) { o = x; }, o, x);
+  Py_END_ALLOW_THREADS
+  PyBlitzArray_UnpinData(src);
+  PyBlitzArray_UnpinData(dst);
 
-  /* If you get to this point, then you known the indexing is fine */
+}
 
-  switch (o->ndim) {
+/**
+ * Sets all elements of `dst' to the same (Python or numpy) scalar
+ */
+template <typename T, int N>
+int fill_inner(PyBlitzArrayObject* dst, PyObject* value) {
 
-    case 1:
-      {
-        T c_value = PyBlitzArrayCxx_AsCScalar<T>(value);
-        if (PyErr_Occurred()) return -1;
-        (*reinterpret_cast<blitz::Array<T,1>*>(o->bzarr))((int)tmp[0]) = c_value;
-        return 0;
-      }
+  T c_value = PyBlitzArrayCxx_AsCScalar<T>(value);
+  if (PyErr_Occurred()) return -1;
 
-    case 2:
-      {
-        T c_value = PyBlitzArrayCxx_AsCScalar<T>(value);
-        if (PyErr_Occurred()) return -1;
-        (*reinterpret_cast<blitz::Array<T,2>*>(o->bzarr))((int)tmp[0], (int)tmp[1]) = c_value;
-        return 0;
-      }
+  blitz::Array<T,N>& o = *reinterpret_cast<blitz::Array<T,N>*>(dst->bzarr);
 
-    case 3:
-      {
-        T c_value = PyBlitzArrayCxx_AsCScalar<T>(value);
-        if (PyErr_Occurred()) return -1;
-        (*reinterpret_cast<blitz::Array<T,3>*>(o->bzarr))((int)tmp[0], (int)tmp[1], (int)tmp[2]) = c_value;
-        return 0;
-      }
+  PyBlitzArray_PinData(dst);
+  Py_BEGIN_ALLOW_THREADS
+  tiled([c_value](blitz::Array<T,N>& o) { o = c_value; }, o);
+  Py_END_ALLOW_THREADS
+  PyBlitzArray_UnpinData(dst);
 
-    case 4:
-      {
-        T c_value = PyBlitzArrayCxx_AsCScalar<T>(value);
-        if (PyErr_Occurred()) return -1;
-        (*reinterpret_cast<blitz::Array<T,4>*>(o->bzarr))((int)tmp[0], (int)tmp[1], (int)tmp[2], (int)tmp[3]) = c_value;
-        return 0;
+  return 0;
+
+}
+
+/**
+ * Evaluates `a op b' (op being one of `+', `-', `*' or `/') element-wise, in
+ * a single pass and without holding the GIL. `a' and `b' have the same type
+ * and shape as `out', which may also be `a' itself.
+ */
+template <typename T, int N>
+void arithmetic_inner(char op, PyBlitzArrayObject* out, PyBlitzArrayObject* a,
+    PyBlitzArrayObject* b) {
+
+  blitz::Array<T,N>& o = *reinterpret_cast<blitz::Array<T,N>*>(out->bzarr);
+  blitz::Array<T,N>& x = *reinterpret_cast<blitz::Array<T,N>*>(a->bzarr);
+  blitz::Array<T,N>& y = *reinterpret_cast<blitz::Array<T,N>*>(b->bzarr);
+
+  PyBlitzArray_PinData(out);
+  PyBlitzArray_PinData(a);
+  PyBlitzArray_PinData(b);
+  Py_BEGIN_ALLOW_THREADS
+  tiled([op](blitz::Array<T,N>& o, const blitz::Array<T,N>& x,
+        const blitz::Array<T,N>& y) {
+      switch (op) {
+        case '+': o = x + y; break;
+        case '-': o = x - y; break;
+        case '*': o = x * y; break;
+        case '/': o = x / y; break;
       }
+  }, o, x, y);
+  Py_END_ALLOW_THREADS
+  PyBlitzArray_UnpinData(b);
+  PyBlitzArray_UnpinData(a);
+  PyBlitzArray_UnpinData(out);
 
-    default:
-      PyErr_Format(PyExc_NotImplementedError, "cannot set item on %s(@%" PY_FORMAT_SIZE_T "d,'%s'): this number of dimensions is outside the range of supported dimensions [1,%d]", Py_TYPE(o)->tp_name, o->ndim, PyBlitzArray_TypenumAsString(o->type_num), BOB_BLITZ_MAXDIMS);
-      return -1;
+}
+
+template <typename T, int N>
+void compare_dispatch(int op, blitz::Array<bool,N>& o,
+    const blitz::Array<T,N>& x, const blitz::Array<T,N>& y,
+    std::true_type /*ordered*/) {
+
+  switch (op) {
+    case Py_LT: o = x < y; break;
+    case Py_LE: o = x <= y; break;
+    case Py_GT: o = x > y; break;
+    case Py_GE: o = x >= y; break;
+    case Py_EQ: o = x == y; break;
+    case Py_NE: o = x != y; break;
   }
 
 }
 
-int PyBlitzArray_SetItem(PyBlitzArrayObject* o, Py_ssize_t* pos, PyObject* value) {
+template <typename T, int N>
+void compare_dispatch(int op, blitz::Array<bool,N>& o,
+    const blitz::Array<T,N>& x, const blitz::Array<T,N>& y,
+    std::false_type /*complex*/) {
 
-  if (!o->writeable) {
-    PyErr_Format(PyExc_RuntimeError, "cannot set item on read-only %s(@%" PY_FORMAT_SIZE_T "d,%s) ", Py_TYPE(o)->tp_name, o->ndim, PyBlitzArray_TypenumAsString(o->type_num));
-    return -1;
+  switch (op) {
+    case Py_EQ: o = x == y; break;
+    case Py_NE: o = x != y; break;
   }
 
-  switch (o->type_num) {
+}
 
-    case NPY_BOOL:
-      return setitem_inner<bool>(o, pos, value);
+/**
+ * Compares `a' and `b' element-wise, without holding the GIL, storing the
+ * results in the boolean array `out', of the same shape. Complex numbers only
+ * support (in)equality.
+ */
+template <typename T, int N>
+void compare_inner(int op, PyBlitzArrayObject* out, PyBlitzArrayObject* a,
+    PyBlitzArrayObject* b) {
+
+  blitz::Array<bool,N>& o = *reinterpret_cast<blitz::Array<bool,N>*>(out->bzarr);
+  blitz::Array<T,N>& x = *reinterpret_cast<blitz::Array<T,N>*>(a->bzarr);
+  blitz::Array<T,N>& y = *reinterpret_cast<blitz::Array<T,N>*>(b->bzarr);
+
+  PyBlitzArray_PinData(out);
+  PyBlitzArray_PinData(a);
+  PyBlitzArray_PinData(b);
+  Py_BEGIN_ALLOW_THREADS
+  tiled([op](blitz::Array<bool,N>& o, const blitz::Array<T,N>& x,
+        const blitz::Array<T,N>& y) {
+      compare_dispatch(op, o, x, y,
+          std::integral_constant<bool, std::is_arithmetic<T>::value>());
+  }, o, x, y);
+  Py_END_ALLOW_THREADS
+  PyBlitzArray_UnpinData(b);
+  PyBlitzArray_UnpinData(a);
+  PyBlitzArray_UnpinData(out);
 
-    case NPY_INT8:
-      return setitem_inner<int8_t>(o, pos, value);
+}
 
-    case NPY_INT16:
-      return setitem_inner<int16_t>(o, pos, value);
+/**
+ * Gathers `count' elements, given by their offsets in bytes from the first
+ * element of `o', into the contiguous buffer `out'
+ */
+template <typename T>
+void take_inner(PyBlitzArrayObject* o, const npy_intp* offsets,
+    npy_intp count, void* out) {
 
-    case NPY_INT32:
-      return setitem_inner<int32_t>(o, pos, value);
+  const char* base = reinterpret_cast<const char*>(o->data);
+  T* dst = reinterpret_cast<T*>(out);
+  for (npy_intp k=0; k<count; ++k)
+    dst[k] = *reinterpret_cast<const T*>(base + offsets[k]);
 
-    case NPY_INT64:
-      return setitem_inner<int64_t>(o, pos, value);
+}
 
-    case NPY_UINT8:
-      return setitem_inner<uint8_t>(o, pos, value);
+/**
+ * Scatters `count' elements, `step' bytes apart in `values', into the
+ * positions of `o' given by their offsets in bytes from its first element
+ */
+template <typename T>
+void put_inner(PyBlitzArrayObject* o, const npy_intp* offsets,
+    npy_intp count, const void* values, npy_intp step) {
 
-    case NPY_UINT16:
-      return setitem_inner<uint16_t>(o, pos, value);
+  char* base = reinterpret_cast<char*>(o->data);
+  const char* src = reinterpret_cast<const char*>(values);
+  for (npy_intp k=0; k<count; ++k, src += step)
+    *reinterpret_cast<T*>(base + offsets[k]) = *reinterpret_cast<const T*>(src);
 
-    case NPY_UINT32:
-      return setitem_inner<uint32_t>(o, pos, value);
+}
 
-    case NPY_UINT64:
-      return setitem_inner<uint64_t>(o, pos, value);
+/*******************
+ * Data Allocators *
+ *******************/
 
-    case NPY_FLOAT32:
-      return setitem_inner<float>(o, pos, value);
+static void* malloc_allocate(size_t size, void*) {
+  return std::malloc(size);
+}
 
-    case NPY_FLOAT64:
-      return setitem_inner<double>(o, pos, value);
+static void* aligned_allocate(size_t size, void*) {
+  void* retval = 0;
+  if (posix_memalign(&retval, 64, size) != 0) return 0;
+  return retval;
+}
 
-#ifdef NPY_FLOAT128
-    case NPY_FLOAT128:
-      return setitem_inner<long double>(o, pos, value);
+/**
+ * Blocks above the threshold (in bytes) are aligned to, and padded up to, 2
+ * MiB and marked as candidates for transparent huge pages
+ */
+static size_t hugepage_threshold = 4 << 20;
+
+static void* hugepage_allocate(size_t size, void* ctx) {
+  const size_t threshold = *reinterpret_cast<size_t*>(ctx);
+  if (size < threshold) return aligned_allocate(size, 0);
+  const size_t huge = 2 << 20;
+  const size_t padded = (size + huge - 1) & ~(huge - 1);
+  void* retval = 0;
+  if (posix_memalign(&retval, huge, padded) != 0) return 0;
+# ifdef MADV_HUGEPAGE
+  madvise(retval, padded, MADV_HUGEPAGE); ///< just a hint, ignore errors
+# endif
+  return retval;
+}
 
-#endif
+static void malloc_free(void* ptr, size_t, void*) {
+  std::free(ptr);
+}
 
-    case NPY_COMPLEX64:
-      return setitem_inner<std::complex<float>>(o, pos, value);
+/* "blitz" leaves allocation to blitz::Array<T,N> itself (historical default) */
+static const PyBlitzArrayAllocator builtin_allocators[] = {
+  {"blitz", 0, 0, 0},
+  {"malloc", malloc_allocate, malloc_free, 0},
+  {"aligned64", aligned_allocate, malloc_free, 0},
+  {"hugepage", hugepage_allocate, malloc_free, &hugepage_threshold},
+};
 
-    case NPY_COMPLEX128:
-      return setitem_inner<std::complex<double>>(o, pos, value);
+static const PyBlitzArrayAllocator* current_allocator = &builtin_allocators[0];
 
-#ifdef NPY_COMPLEX256
-    case NPY_COMPLEX256:
-      return setitem_inner<std::complex<long double>>(o, pos, value);
+void PyBlitzArray_CacheFlush();
 
-#endif
+int PyBlitzArray_SetAllocator(const PyBlitzArrayAllocator* allocator) {
 
-    default:
-      PyErr_Format(PyExc_NotImplementedError, "cannot set item on %s(@%" PY_FORMAT_SIZE_T "d,T) with T being a data type with an unsupported numpy type number = %d", Py_TYPE(o)->tp_name, o->ndim, o->type_num);
-      return -1;
+  if (!allocator) allocator = &builtin_allocators[0];
 
+  if (!allocator->name || (allocator->malloc && !allocator->free) || (!allocator->malloc && allocator->free)) {
+    PyErr_SetString(PyExc_ValueError, "data allocators must have a name and either both or none of `malloc' and `free'");
+    return -1;
   }
 
+  if (allocator != current_allocator) PyBlitzArray_CacheFlush();
+  current_allocator = allocator;
+  return 0;
+
 }
 
-/********************************
- * Construction and Destruction *
- ********************************/
+const PyBlitzArrayAllocator* PyBlitzArray_GetAllocator(void) {
+  return current_allocator;
+}
 
-PyObject* PyBlitzArray_New(PyTypeObject* type, PyObject*, PyObject*) {
+const PyBlitzArrayAllocator* PyBlitzArray_AllocatorByName(const char* name) {
 
-  /* Allocates the python object itself */
-  PyBlitzArrayObject* self = (PyBlitzArrayObject*)type->tp_alloc(type, 0);
+  for (size_t i=0; i<sizeof(builtin_allocators)/sizeof(builtin_allocators[0]); ++i) {
+    if (std::strcmp(builtin_allocators[i].name, name) == 0) return &builtin_allocators[i];
+  }
 
-  self->bzarr = 0;
-  self->data = 0;
-  self->type_num = NPY_NOTYPE;
-  self->ndim = 0;
-  self->writeable = 0;
-  self->base = 0;
+  PyErr_Format(PyExc_ValueError, "unknown data allocator `%s' - choose one of `blitz', `malloc', `aligned64' or `hugepage'", name);
+  return 0;
 
-  return reinterpret_cast<PyObject*>(self);
 }
 
-template<typename T> void deallocate_inner(PyBlitzArrayObject* o) {
+/* Not part of the C-API: used by the Python bindings */
+void PyBlitzArray_SetHugepageThreshold(size_t threshold) {
+  hugepage_threshold = threshold;
+}
 
-  switch (o->ndim) {
+/**
+ * Recycling cache for data blocks obtained from allocators. Freed blocks are
+ * kept, up to a total byte limit, and handed out again to arrays of the same
+ * size class. Each thread first checks a small private cache, then a shared
+ * one. The cache is disabled (limit 0) by default.
+ */
+struct cached_block {
+  const PyBlitzArrayAllocator* allocator;
+  void* ptr;
+  size_t size; ///< the size class, in bytes
+};
 
-    case 1:
-      delete reinterpret_cast<blitz::Array<T,1>*>(o->bzarr);
-      break;
+static std::atomic<size_t> cache_limit(0);
+static std::atomic<size_t> cache_bytes(0);
+static std::atomic<unsigned long long> cache_hits(0);
+static std::atomic<unsigned long long> cache_misses(0);
+static std::atomic<unsigned long long> cache_drops(0);
 
-    case 2:
-      delete reinterpret_cast<blitz::Array<T,2>*>(o->bzarr);
-      break;
+static std::mutex shared_cache_mutex;
+static std::map<size_t, std::vector<cached_block>> shared_cache;
 
-    case 3:
-      delete reinterpret_cast<blitz::Array<T,3>*>(o->bzarr);
-      break;
+static void release_block(const cached_block& b) {
+  b.allocator->free(b.ptr, b.size, b.allocator->ctx);
+  cache_bytes -= b.size;
+}
 
-    case 4:
-      delete reinterpret_cast<blitz::Array<T,4>*>(o->bzarr);
-      break;
+#define BOB_BLITZ_FRONT_CACHE_SIZE 4
 
-    default:
-      PyErr_Format(PyExc_NotImplementedError, "cannot deallocate %s(@%" PY_FORMAT_SIZE_T "d,%s>, this number of dimensions is outside the range of supported dimensions [1,%d]", Py_TYPE(o)->tp_name, o->ndim, PyBlitzArray_TypenumAsString(o->type_num), BOB_BLITZ_MAXDIMS);
-      return;
-  }
+struct front_cache {
+  cached_block blocks[BOB_BLITZ_FRONT_CACHE_SIZE];
+  int count;
+  front_cache(): count(0) {}
+  ~front_cache() { flush(); }
+  void flush() { while (count) release_block(blocks[--count]); }
+};
 
-  Py_XDECREF(o->base);
-  Py_TYPE(o)->tp_free((PyObject*)o);
+static thread_local front_cache thread_cache;
+
+/**
+ * Rounds sizes up to one of 4 classes per power of two, so that blocks are
+ * reusable by arrays of similar size while wasting at most 25% of the space
+ */
+static size_t size_class(size_t size) {
+  if (size <= 64) return 64;
+  if (size > std::numeric_limits<size_t>::max() / 2) return size;
+  size_t p = 64;
+  while (2*p < size) p *= 2;
+  const size_t step = p / 4;
+  return (size + step - 1) / step * step;
 }
 
-void PyBlitzArray_Delete (PyBlitzArrayObject* o) {
+static void* cache_allocate(const PyBlitzArrayAllocator* allocator, size_t size, size_t* allocated) {
 
-  if (!o->bzarr) {
-    //shortcut
-    Py_XDECREF(o->base);
-    Py_TYPE(o)->tp_free((PyObject*)o);
-    return;
+  if (!cache_limit) {
+    *allocated = size;
+    return allocator->malloc(size, allocator->ctx);
   }
 
-  switch (o->type_num) {
-
-    case NPY_BOOL:
-      return deallocate_inner<bool>(o);
+  const size_t cls = size_class(size);
+  *allocated = cls;
+
+  front_cache& front = thread_cache;
+  for (int i=front.count-1; i>=0; --i) {
+    if (front.blocks[i].size == cls && front.blocks[i].allocator == allocator) {
+      void* retval = front.blocks[i].ptr;
+      front.blocks[i] = front.blocks[--front.count];
+      cache_bytes -= cls;
+      ++cache_hits;
+      return retval;
+    }
+  }
 
-    case NPY_INT8:
-      return deallocate_inner<int8_t>(o);
+  {
+    std::lock_guard<std::mutex> lock(shared_cache_mutex);
+    auto it = shared_cache.find(cls);
+    if (it != shared_cache.end()) {
+      auto& blocks = it->second;
+      for (auto b = blocks.rbegin(); b != blocks.rend(); ++b) {
+        if (b->allocator == allocator) {
+          void* retval = b->ptr;
+          blocks.erase(std::next(b).base());
+          cache_bytes -= cls;
+          ++cache_hits;
+          return retval;
+        }
+      }
+    }
+  }
 
-    case NPY_INT16:
-      return deallocate_inner<int16_t>(o);
+  ++cache_misses;
+  return allocator->malloc(cls, allocator->ctx);
 
-    case NPY_INT32:
-      return deallocate_inner<int32_t>(o);
+}
 
-    case NPY_INT64:
-      return deallocate_inner<int64_t>(o);
+static void cache_release(const PyBlitzArrayAllocator* allocator, void* ptr, size_t allocated) {
 
-    case NPY_UINT8:
-      return deallocate_inner<uint8_t>(o);
+  cached_block block = {allocator, ptr, allocated};
 
-    case NPY_UINT16:
-      return deallocate_inner<uint16_t>(o);
+  if (!cache_limit || size_class(allocated) != allocated) {
+    allocator->free(ptr, allocated, allocator->ctx);
+    return;
+  }
 
-    case NPY_UINT32:
-      return deallocate_inner<uint32_t>(o);
+  if (cache_bytes + allocated > cache_limit) {
+    ++cache_drops;
+    allocator->free(ptr, allocated, allocator->ctx);
+    return;
+  }
 
-    case NPY_UINT64:
-      return deallocate_inner<uint64_t>(o);
+  cache_bytes += allocated;
 
-    case NPY_FLOAT32:
-      return deallocate_inner<float>(o);
+  front_cache& front = thread_cache;
+  if (front.count < BOB_BLITZ_FRONT_CACHE_SIZE) {
+    front.blocks[front.count++] = block;
+    return;
+  }
 
-    case NPY_FLOAT64:
-      return deallocate_inner<double>(o);
+  std::lock_guard<std::mutex> lock(shared_cache_mutex);
+  shared_cache[allocated].push_back(block);
 
-#ifdef NPY_FLOAT128
-    case NPY_FLOAT128:
-      return deallocate_inner<long double>(o);
+}
 
-#endif
+/* Not part of the C-API: used by the Python bindings */
+void PyBlitzArray_CacheFlush() {
+  thread_cache.flush();
+  std::lock_guard<std::mutex> lock(shared_cache_mutex);
+  for (auto& k : shared_cache) for (auto& b : k.second) release_block(b);
+  shared_cache.clear();
+}
 
-    case NPY_COMPLEX64:
-      return deallocate_inner<std::complex<float>>(o);
+/* Not part of the C-API: used by the Python bindings */
+void PyBlitzArray_SetCacheLimit(size_t limit) {
+  cache_limit = limit;
+  if (cache_bytes > limit) PyBlitzArray_CacheFlush();
+}
 
-    case NPY_COMPLEX128:
-      return deallocate_inner<std::complex<double>>(o);
+/* Not part of the C-API: used by the Python bindings */
+PyObject* PyBlitzArray_CacheStats() {
+  return Py_BuildValue("{sKsKsKsnsn}",
+      "hits", cache_hits.load(),
+      "misses", cache_misses.load(),
+      "dropped", cache_drops.load(),
+      "bytes", (Py_ssize_t)cache_bytes.load(),
+      "limit", (Py_ssize_t)cache_limit.load());
+}
 
-#ifdef NPY_COMPLEX256
-    case NPY_COMPLEX256:
-      return deallocate_inner<std::complex<long double>>(o);
+/********************************
+ * Construction and Destruction *
+ ********************************/
 
-#endif
+/**
+ * Recycled PyBlitzArrayObject's (exact type only). Array objects are created
+ * and destroyed at a high pace when bindings return many small arrays, so we
+ * keep a bounded number of them around instead of going back to the Python
+ * allocator every time.
+ */
+#ifndef Py_GIL_DISABLED
+#define BOB_BLITZ_FREELIST_SIZE 64
+static PyBlitzArrayObject* free_list[BOB_BLITZ_FREELIST_SIZE];
+static int num_free = 0;
+#endif
 
-    default:
-      PyErr_Format(PyExc_NotImplementedError, "cannot deallocate %s(@%" PY_FORMAT_SIZE_T "d,T) with T having an unsupported numpy type number of %d", Py_TYPE(o)->tp_name, o->ndim, o->type_num);
-      return;
+PyObject* PyBlitzArray_New(PyTypeObject* type, PyObject*, PyObject*) {
+
+  /* Allocates the python object itself */
+  PyBlitzArrayObject* self = 0;
+
+#ifdef BOB_BLITZ_FREELIST_SIZE
+  if (type == &PyBlitzArray_Type && num_free) {
+    self = free_list[--num_free];
+    PyObject_Init(reinterpret_cast<PyObject*>(self), type);
+  }
+#endif
+
+  if (!self) self = (PyBlitzArrayObject*)type->tp_alloc(type, 0);
+  if (!self) return 0;
+  PyBlitzStats_Created();
+
+  self->bzarr = 0;
+  self->data = 0;
+  self->type_num = NPY_NOTYPE;
+  self->ndim = 0;
+  self->writeable = 0;
+  self->base = 0;
+  self->exports = 0;
+  self->viewed = 0;
+  self->npy_view = 0;
+  self->vtable = 0;
+  self->allocator = 0;
+  self->allocated = 0;
+
+  return reinterpret_cast<PyObject*>(self);
+}
+
+/**
+ * The blitz::Array<T,N> header lives inside the object, unless a particular
+ * blitz++ build makes it bigger (or more strictly aligned) than the space we
+ * reserve for it, in which case it goes to the heap.
+ */
+template<typename T, int N> struct bzarr_fits {
+  static const bool value =
+    sizeof(blitz::Array<T,N>) <= sizeof(PyBlitzArrayObject::bzarr_storage) &&
+    alignof(blitz::Array<T,N>) <= alignof(decltype(PyBlitzArrayObject::bzarr_storage));
+};
+
+template<typename T, int N, typename... Args>
+blitz::Array<T,N>* construct_bzarr(PyBlitzArrayObject* o, Args&&... args) {
+  if (bzarr_fits<T,N>::value)
+    return new (o->bzarr_storage.bytes) blitz::Array<T,N>(std::forward<Args>(args)...);
+  return new blitz::Array<T,N>(std::forward<Args>(args)...);
+}
+
+/**
+ * Data owned by arrays is reported to tracemalloc, when it is tracing, so
+ * snapshots attribute it to the Python line that created each array. Blocks
+ * kept by the recycling cache, owned by no array, are not reported.
+ */
+static void trace_data(PyBlitzArrayObject* o) {
+#if PY_VERSION_HEX >= 0x03070000
+  PyTraceMalloc_Track(BOB_BLITZ_TRACEMALLOC_DOMAIN, reinterpret_cast<uintptr_t>(o->data), o->allocated);
+#else
+  (void)o;
+#endif
+}
+
+static void untrace_data(PyBlitzArrayObject* o) {
+#if PY_VERSION_HEX >= 0x03070000
+  PyTraceMalloc_Untrack(BOB_BLITZ_TRACEMALLOC_DOMAIN, reinterpret_cast<uintptr_t>(o->data));
+#else
+  (void)o;
+#endif
+}
+
+template<typename T, int N> void deallocate_inner(PyBlitzArrayObject* o) {
+  auto bz = reinterpret_cast<blitz::Array<T,N>*>(o->bzarr);
+  if (bzarr_fits<T,N>::value) bz->~Array();
+  else delete bz;
+  o->bzarr = 0;
+  if (o->allocated) {
+    PyBlitzStats_Released(o->allocated);
+    untrace_data(o);
+  }
+  if (o->allocator) cache_release(o->allocator, o->data, o->allocated);
+  o->allocator = 0;
+  o->allocated = 0;
+}
 
+void PyBlitzArray_Delete (PyBlitzArrayObject* o) {
+
+  if (o->bzarr && o->vtable) o->vtable->deallocate(o);
+
+  Py_XDECREF(o->npy_view);
+  Py_XDECREF(o->base);
+
+#ifdef BOB_BLITZ_FREELIST_SIZE
+  if (Py_TYPE(o) == &PyBlitzArray_Type && num_free < BOB_BLITZ_FREELIST_SIZE) {
+    free_list[num_free++] = o;
+    return;
   }
+#endif
+
+  Py_TYPE(o)->tp_free((PyObject*)o);
 
 }
 
 template<typename T, int N>
 int simplenew_2(PyBlitzArrayObject* arr, int type_num, Py_ssize_t ndim, Py_ssize_t* shape) {
 
+  // computes the number of bytes required, checking for overflows
+  size_t nbytes = sizeof(T);
+  for (int i=0; i<N; ++i) {
+    if (shape[i] < 0) {
+      PyErr_Format(PyExc_ValueError, "cannot instantiate %s(@%" PY_FORMAT_SIZE_T "d,'%s') with negative dimensions", PyBlitzArray_Type.tp_name, ndim, PyBlitzArray_TypenumAsString(type_num));
+      return -1;
+    }
+    if (shape[i] && nbytes > std::numeric_limits<size_t>::max() / shape[i]) {
+      PyErr_Format(PyExc_MemoryError, "cannot instantiate %s(@%" PY_FORMAT_SIZE_T "d,'%s'): array is too big", PyBlitzArray_Type.tp_name, ndim, PyBlitzArray_TypenumAsString(type_num));
+      return -1;
+    }
+    nbytes *= shape[i];
+  }
+
+  // re-initialization: releases the previous contents first, nothing else
+  // points to them (see PyBlitzArray_SimpleInit())
+  if (arr->bzarr && arr->vtable) arr->vtable->deallocate(arr);
+  arr->vtable = 0;
+  Py_CLEAR(arr->base);
+  Py_CLEAR(arr->npy_view);
+
+  const PyBlitzArrayAllocator* allocator = current_allocator;
+  T* data = 0;
+  size_t allocated = 0;
+  if (allocator->malloc) {
+    data = reinterpret_cast<T*>(cache_allocate(allocator, nbytes ? nbytes : sizeof(T), &allocated));
+    if (!data) {
+      PyErr_Format(PyExc_MemoryError, "data allocator `%s' failed to allocate %" PY_FORMAT_SIZE_T "u bytes for %s(@%" PY_FORMAT_SIZE_T "d,'%s')", allocator->name, nbytes, PyBlitzArray_Type.tp_name, ndim, PyBlitzArray_TypenumAsString(type_num));
+      return -1;
+    }
+  }
+
   try {
 
     blitz::TinyVector<int,N> tv_shape;
     for (int i=0; i<N; ++i) tv_shape(i) = shape[i];
-    auto bz = new blitz::Array<T,N>(tv_shape);
+
+    auto bz = data ?
+      construct_bzarr<T,N>(arr, data, tv_shape, blitz::neverDeleteData) :
+      construct_bzarr<T,N>(arr, tv_shape);
     arr->bzarr = static_cast<void*>(bz);
     arr->data = bz->data();
     arr->type_num = type_num;
@@ -544,6 +973,12 @@ int simplenew_2(PyBlitzArrayObject* arr, int type_num, Py_ssize_t ndim, Py_ssize
       arr->stride[i] = sizeof(T)*bz->stride(i); ///in **bytes**
     }
     arr->writeable = 1;
+    arr->vtable = &vtable_entry<T,N>::value;
+    // data not from an allocator is owned by the blitz::Array<>
+    arr->allocator = data ? allocator : 0;
+    arr->allocated = data ? allocated : nbytes;
+    PyBlitzStats_Allocated(arr->allocated);
+    if (arr->allocated) trace_data(arr);
     return 0;
   }
 
@@ -555,132 +990,23 @@ int simplenew_2(PyBlitzArrayObject* arr, int type_num, Py_ssize_t ndim, Py_ssize
     PyErr_Format(PyExc_RuntimeError, "caught unknown exception while instantiating %s(@%" PY_FORMAT_SIZE_T "d,'%s')", PyBlitzArray_Type.tp_name, ndim, PyBlitzArray_TypenumAsString(type_num));
   }
 
-  /** some test code
-  std::cout << "allocating array" << std::endl;
-  std::shared_ptr<blitz::Array<T,N>> retval(new blitz::Array<T,N>(tv_shape),
-      &delete_array<T,N>);
-  **/
-
+  if (data) cache_release(allocator, data, allocated);
   return -1;
 
 }
 
-template<typename T>
-int simplenew_1(PyBlitzArrayObject* arr, int type_num, Py_ssize_t ndim, Py_ssize_t* shape) {
-  switch (ndim) {
-
-    case 1:
-      return simplenew_2<T,1>(arr, type_num, ndim, shape);
-
-    case 2:
-      return simplenew_2<T,2>(arr, type_num, ndim, shape);
-
-    case 3:
-      return simplenew_2<T,3>(arr, type_num, ndim, shape);
-
-    case 4:
-      return simplenew_2<T,4>(arr, type_num, ndim, shape);
-
-    default:
-      PyErr_Format(PyExc_NotImplementedError, "cannot allocate %s(@%" PY_FORMAT_SIZE_T "d,'%s'): this number of dimensions is outside the range of supported dimensions [1,%d]", PyBlitzArray_Type.tp_name, ndim, PyBlitzArray_TypenumAsString(type_num), BOB_BLITZ_MAXDIMS);
-      return -1;
-  }
-
-}
-
-// Initializes the given arr with new data of the desired size
-// No check is performed, so old data is simply overwritten!
-// Returns 0 on success and -1 on failure
-int PyBlitzArray_SimpleInit(PyBlitzArrayObject* arr, int type_num, Py_ssize_t ndim, Py_ssize_t* shape) {
-
-  if (!arr){
-    PyErr_Format(PyExc_RuntimeError, "PyBlitzArray_SimpleInit: Cannot fill an array pointing to NULL.");
-    return -1;
-  }
-
-  type_num = fix_integer_type_num(type_num);
-
-  switch (type_num) {
-
-    case NPY_BOOL:
-      return simplenew_1<bool>(arr, type_num, ndim, shape);
-
-    case NPY_INT8:
-      return simplenew_1<int8_t>(arr, type_num, ndim, shape);
-
-    case NPY_INT16:
-      return simplenew_1<int16_t>(arr, type_num, ndim, shape);
-
-    case NPY_INT32:
-      return simplenew_1<int32_t>(arr, type_num, ndim, shape);
-
-    case NPY_INT64:
-      return simplenew_1<int64_t>(arr, type_num, ndim, shape);
-
-    case NPY_UINT8:
-      return simplenew_1<uint8_t>(arr, type_num, ndim, shape);
-
-    case NPY_UINT16:
-      return simplenew_1<uint16_t>(arr, type_num, ndim, shape);
-
-    case NPY_UINT32:
-      return simplenew_1<uint32_t>(arr, type_num, ndim, shape);
-
-    case NPY_UINT64:
-      return simplenew_1<uint64_t>(arr, type_num, ndim, shape);
-
-    case NPY_FLOAT32:
-      return simplenew_1<float>(arr, type_num, ndim, shape);
-
-    case NPY_FLOAT64:
-      return simplenew_1<double>(arr, type_num, ndim, shape);
-
-#ifdef NPY_FLOAT128
-    case NPY_FLOAT128:
-      return simplenew_1<long double>(arr, type_num, ndim, shape);
-
-#endif
-
-    case NPY_COMPLEX64:
-      return simplenew_1<std::complex<float>>(arr, type_num, ndim, shape);
-
-    case NPY_COMPLEX128:
-      return simplenew_1<std::complex<double>>(arr, type_num, ndim, shape);
-
-#ifdef NPY_COMPLEX256
-    case NPY_COMPLEX256:
-      return simplenew_1<std::complex<long double>>(arr, type_num, ndim, shape);
-
-#endif
-
-    default:
-      PyErr_Format(PyExc_NotImplementedError, "cannot create %s(@%" PY_FORMAT_SIZE_T "d,T) with T having an unsupported numpy type number of %d", PyBlitzArray_Type.tp_name, ndim, type_num);
-      return -1;
-
-  }
-
-}
-
-// Creates and returns a new PyBlitzArrayObject with the desired size
-PyObject* PyBlitzArray_SimpleNew (int type_num, Py_ssize_t ndim, Py_ssize_t* shape) {
-
-  PyBlitzArrayObject* retval = (PyBlitzArrayObject*)PyBlitzArray_New(&PyBlitzArray_Type, 0, 0);
-
-  auto retval_ = make_safe(retval);
-
-  if (PyBlitzArray_SimpleInit(retval, type_num, ndim, shape) != 0)
-    return 0;
-
-  return Py_BuildValue("O", retval);
-
-}
-
-
 // N.B.: cannot use lambdas with very old versions of gcc
+// Orders dimensions from the fastest to the slowest varying one (by absolute
+// stride), keeping C-style ordering between dimensions with equal strides
 struct stride_sorter {
   Py_ssize_t* _s;
   stride_sorter(Py_ssize_t* s) { _s = s; }
-  bool operator() (int i1, int i2) { return _s[i1] <= _s[i2]; }
+  bool operator() (int i1, int i2) {
+    Py_ssize_t a1 = _s[i1] < 0 ? -_s[i1] : _s[i1];
+    Py_ssize_t a2 = _s[i2] < 0 ? -_s[i2] : _s[i2];
+    if (a1 != a2) return a1 < a2;
+    return i1 > i2;
+  }
 };
 
 template <int N>
@@ -705,15 +1031,22 @@ PyObject* simplenewfromdata_2(int type_num, Py_ssize_t ndim,
       tv_stride(i) = stride[i]/sizeof(T); ///< from **bytes**
     }
     PyBlitzArrayObject* retval = (PyBlitzArrayObject*)PyBlitzArray_New(&PyBlitzArray_Type, 0, 0);
+    if (!retval) return 0;
 
-    //get the storage right
+    //get the storage right: dimensions with negative strides are stored in
+    //descending order, in which case blitz++ expects the lowest address in
+    //memory, instead of the address of the first element
     blitz::TinyVector<bool,N> ascending;
-    ascending = true;
+    T* first = reinterpret_cast<T*>(data);
+    for (int i=0; i<N; ++i) {
+      ascending(i) = stride[i] >= 0;
+      if (!ascending(i) && shape[i] > 0) first += tv_stride(i) * (shape[i]-1);
+    }
     blitz::TinyVector<int,N> ordering;
     stride_order(stride, ordering);
     blitz::GeneralArrayStorage<N> storage(ordering, ascending);
 
-    auto bz = new blitz::Array<T,N>(reinterpret_cast<T*>(data), tv_shape, tv_stride, blitz::neverDeleteData, storage);
+    auto bz = construct_bzarr<T,N>(retval, first, tv_shape, tv_stride, blitz::neverDeleteData, storage);
     retval->bzarr = static_cast<void*>(bz);
     retval->data = data;
     retval->type_num = type_num;
@@ -723,6 +1056,7 @@ PyObject* simplenewfromdata_2(int type_num, Py_ssize_t ndim,
       retval->stride[i] = stride[i];
     }
     retval->writeable = writeable ? 1 : 0;
+    retval->vtable = &vtable_entry<T,N>::value;
     return reinterpret_cast<PyObject*>(retval);
 
   }
@@ -735,164 +1069,292 @@ PyObject* simplenewfromdata_2(int type_num, Py_ssize_t ndim,
     PyErr_Format(PyExc_RuntimeError, "caught unknown exception while instantiating %s(@%" PY_FORMAT_SIZE_T "d,'%s')", PyBlitzArray_Type.tp_name, ndim, PyBlitzArray_TypenumAsString(type_num));
   }
 
-  /** some test code
-  std::cout << "allocating array" << std::endl;
-  std::shared_ptr<blitz::Array<T,N>> retval(new blitz::Array<T,N>(tv_shape),
-      &delete_array<T,N>);
-  **/
-
   return 0;
 
 }
 
-template<typename T>
-PyObject* simplenewfromdata_1(int type_num, Py_ssize_t ndim,
-    Py_ssize_t* shape, Py_ssize_t* stride, void* data, int writeable) {
-
-  switch (ndim) {
-
-    case 1:
-      return simplenewfromdata_2<T,1>(type_num, ndim, shape, stride, data, writeable);
-
-    case 2:
-      return simplenewfromdata_2<T,2>(type_num, ndim, shape, stride, data, writeable);
+template <typename T, int N>
+const PyBlitzArrayVtable vtable_entry<T,N>::value = {
+  &getitem_inner<T,N>,
+  &setitem_inner<T,N>,
+  &deallocate_inner<T,N>,
+  &simplenew_2<T,N>,
+  &simplenewfromdata_2<T,N>,
+  &assign_inner<T,N>,
+  &fill_inner<T,N>,
+  &take_inner<T>,
+  &put_inner<T>,
+  &arithmetic_inner<T,N>,
+  &compare_inner<T,N>,
+};
 
-    case 3:
-      return simplenewfromdata_2<T,3>(type_num, ndim, shape, stride, data, writeable);
+/**
+ * Returns the operations table for a given (already fixed) type number and
+ * number of dimensions or 0, if the combination is not supported.
+ */
+template <typename T>
+const PyBlitzArrayVtable* vtable_row(Py_ssize_t ndim) {
 
-    case 4:
-      return simplenewfromdata_2<T,4>(type_num, ndim, shape, stride, data, writeable);
+  static const PyBlitzArrayVtable* const row[BOB_BLITZ_MAXDIMS] = {
+    &vtable_entry<T,1>::value,
+    &vtable_entry<T,2>::value,
+    &vtable_entry<T,3>::value,
+    &vtable_entry<T,4>::value,
+  };
 
-    default:
-      PyErr_Format(PyExc_NotImplementedError, "cannot allocate %s(@%" PY_FORMAT_SIZE_T "d,'%s'): this number of dimensions is outside the range of supported dimensions [1,%d]", PyBlitzArray_Type.tp_name, ndim, PyBlitzArray_TypenumAsString(type_num), BOB_BLITZ_MAXDIMS);
-      return 0;
-  }
+  if (ndim < 1 || ndim > BOB_BLITZ_MAXDIMS) return 0;
+  return row[ndim-1];
 
 }
 
-PyObject* PyBlitzArray_SimpleNewFromData (int type_num, Py_ssize_t ndim,
-    Py_ssize_t* shape, Py_ssize_t* stride, void* data, int writeable) {
-
-  type_num = fix_integer_type_num(type_num);
+static const PyBlitzArrayVtable* vtable_for(int type_num, Py_ssize_t ndim) {
 
   switch (type_num) {
 
     case NPY_BOOL:
-      return simplenewfromdata_1<bool>(type_num, ndim, shape, stride, data, writeable);
+      return vtable_row<bool>(ndim);
 
     case NPY_INT8:
-      return simplenewfromdata_1<int8_t>(type_num, ndim, shape, stride, data, writeable);
+      return vtable_row<int8_t>(ndim);
 
     case NPY_INT16:
-      return simplenewfromdata_1<int16_t>(type_num, ndim, shape, stride, data, writeable);
+      return vtable_row<int16_t>(ndim);
 
     case NPY_INT32:
-      return simplenewfromdata_1<int32_t>(type_num, ndim, shape, stride, data, writeable);
+      return vtable_row<int32_t>(ndim);
 
     case NPY_INT64:
-      return simplenewfromdata_1<int64_t>(type_num, ndim, shape, stride, data, writeable);
+      return vtable_row<int64_t>(ndim);
 
     case NPY_UINT8:
-      return simplenewfromdata_1<uint8_t>(type_num, ndim, shape, stride, data, writeable);
+      return vtable_row<uint8_t>(ndim);
 
     case NPY_UINT16:
-      return simplenewfromdata_1<uint16_t>(type_num, ndim, shape, stride, data, writeable);
+      return vtable_row<uint16_t>(ndim);
 
     case NPY_UINT32:
-      return simplenewfromdata_1<uint32_t>(type_num, ndim, shape, stride, data, writeable);
+      return vtable_row<uint32_t>(ndim);
 
     case NPY_UINT64:
-      return simplenewfromdata_1<uint64_t>(type_num, ndim, shape, stride, data, writeable);
+      return vtable_row<uint64_t>(ndim);
 
     case NPY_FLOAT32:
-      return simplenewfromdata_1<float>(type_num, ndim, shape, stride, data, writeable);
+      return vtable_row<float>(ndim);
 
     case NPY_FLOAT64:
-      return simplenewfromdata_1<double>(type_num, ndim, shape, stride, data, writeable);
+      return vtable_row<double>(ndim);
 
 #ifdef NPY_FLOAT128
     case NPY_FLOAT128:
-      return simplenewfromdata_1<long double>(type_num, ndim, shape, stride, data, writeable);
+      return vtable_row<long double>(ndim);
 
 #endif
 
     case NPY_COMPLEX64:
-      return simplenewfromdata_1<std::complex<float>>(type_num, ndim, shape, stride, data, writeable);
+      return vtable_row<std::complex<float>>(ndim);
 
     case NPY_COMPLEX128:
-      return simplenewfromdata_1<std::complex<double>>(type_num, ndim, shape, stride, data, writeable);
+      return vtable_row<std::complex<double>>(ndim);
 
 #ifdef NPY_COMPLEX256
     case NPY_COMPLEX256:
-      return simplenewfromdata_1<std::complex<long double>>(type_num, ndim, shape, stride, data, writeable);
+      return vtable_row<std::complex<long double>>(ndim);
 
 #endif
 
     default:
-      PyErr_Format(PyExc_NotImplementedError, "cannot create %s(@%" PY_FORMAT_SIZE_T "d,T) with T having an unsupported numpy type number of %d", PyBlitzArray_Type.tp_name, ndim, type_num);
       return 0;
 
   }
 
 }
 
+/**
+ * Sets the error for an unsupported (type_num, ndim) combination
+ */
+static void unsupported_type_or_ndim(const char* op, int type_num, Py_ssize_t ndim) {
+
+  if (ndim < 1 || ndim > BOB_BLITZ_MAXDIMS) {
+    PyErr_Format(PyExc_NotImplementedError, "cannot %s %s(@%" PY_FORMAT_SIZE_T "d,'%s'): this number of dimensions is outside the range of supported dimensions [1,%d]", op, PyBlitzArray_Type.tp_name, ndim, PyBlitzArray_TypenumAsString(type_num), BOB_BLITZ_MAXDIMS);
+    return;
+  }
+
+  PyErr_Format(PyExc_NotImplementedError, "cannot %s %s(@%" PY_FORMAT_SIZE_T "d,T) with T having an unsupported numpy type number of %d", op, PyBlitzArray_Type.tp_name, ndim, type_num);
+
+}
+
+// Initializes the given arr with new data of the desired size, releasing its
+// previous data, unless something else may still point to it
+// Returns 0 on success and -1 on failure
+int PyBlitzArray_SimpleInit(PyBlitzArrayObject* arr, int type_num, Py_ssize_t ndim, Py_ssize_t* shape) {
+
+  if (!arr){
+    PyErr_Format(PyExc_RuntimeError, "PyBlitzArray_SimpleInit: Cannot fill an array pointing to NULL.");
+    return -1;
+  }
+
+  if (arr->exports) {
+    PyErr_Format(PyExc_BufferError, "cannot re-initialize %s(@%" PY_FORMAT_SIZE_T "d,'%s') while %" PY_FORMAT_SIZE_T "d exported buffer(s), handle(s) or operation(s) use its data", Py_TYPE(arr)->tp_name, arr->ndim, PyBlitzArray_TypenumAsString(arr->type_num), arr->exports);
+    return -1;
+  }
+
+  if (arr->viewed) {
+    PyErr_Format(PyExc_BufferError, "cannot re-initialize %s(@%" PY_FORMAT_SIZE_T "d,'%s') once views of its data were handed out", Py_TYPE(arr)->tp_name, arr->ndim, PyBlitzArray_TypenumAsString(arr->type_num));
+    return -1;
+  }
+
+  type_num = fix_integer_type_num(type_num);
+
+  const PyBlitzArrayVtable* vtable = vtable_for(type_num, ndim);
+
+  if (!vtable) {
+    unsupported_type_or_ndim("create", type_num, ndim);
+    return -1;
+  }
+
+  return vtable->simplenew(arr, type_num, ndim, shape);
+
+}
+
+// Creates and returns a new PyBlitzArrayObject with the desired size
+PyObject* PyBlitzArray_SimpleNew (int type_num, Py_ssize_t ndim, Py_ssize_t* shape) {
+
+  PyBlitzArrayObject* retval = (PyBlitzArrayObject*)PyBlitzArray_New(&PyBlitzArray_Type, 0, 0);
+  if (!retval) return 0;
+
+  auto retval_ = make_safe(retval);
+
+  if (PyBlitzArray_SimpleInit(retval, type_num, ndim, shape) != 0)
+    return 0;
+
+  return Py_BuildValue("O", retval);
+
+}
+
+PyObject* PyBlitzArray_SimpleNewFromData (int type_num, Py_ssize_t ndim,
+    Py_ssize_t* shape, Py_ssize_t* stride, void* data, int writeable) {
+
+  type_num = fix_integer_type_num(type_num);
+
+  const PyBlitzArrayVtable* vtable = vtable_for(type_num, ndim);
+
+  if (!vtable) {
+    unsupported_type_or_ndim("create", type_num, ndim);
+    return 0;
+  }
+
+  return vtable->simplenewfromdata(type_num, ndim, shape, stride, data, writeable);
+
+}
+
 /****************************
  * From/To NumPy Converters *
  ****************************/
 
-PyObject* PyBlitzArray_AsNumpyArray(PyBlitzArrayObject* o, PyArray_Descr* newtype) {
+/**
+ * Returns a new reference to the last numpy.ndarray view handed out for this
+ * array, if that is still alive and was not reshaped or otherwise changed in
+ * the meanwhile. Returns 0 (without setting an error) otherwise.
+ */
+static PyObject* cached_ndarray_view(PyBlitzArrayObject* o) {
 
-  // if o->base is a numpy array, return it
-  if (o->base && PyArray_Check(o->base)) {
-    if (newtype) return PyArray_FromArray(reinterpret_cast<PyArrayObject*>(o->base), newtype,
-#       if NPY_FEATURE_VERSION >= NUMPY17_API /* NumPy C-API version >= 1.7 */
-        NPY_ARRAY_FORCECAST
-#       else
-        NPY_FORCECAST
-#       endif
-        );
-    Py_INCREF(o->base);
-    return o->base;
+  if (!o->npy_view) return 0;
+
+  PyObject* nd = PyWeakref_GET_OBJECT(o->npy_view); //borrowed
+  if (nd == Py_None) return 0;
+
+  PyArrayObject* ao = reinterpret_cast<PyArrayObject*>(nd);
+  if (PyArray_DATA(ao) != o->data) return 0;
+  if (PyArray_DESCR(ao)->type_num != o->type_num) return 0;
+  if (!PyArray_ISNOTSWAPPED(ao)) return 0;
+  if ((PyArray_ISWRITEABLE(ao) ? 1 : 0) != (o->writeable ? 1 : 0)) return 0;
+  if (PyArray_NDIM(ao) != o->ndim) return 0;
+  for (Py_ssize_t i=0; i<o->ndim; ++i) {
+    if (PyArray_DIMS(ao)[i] != o->shape[i]) return 0;
+    if (PyArray_STRIDES(ao)[i] != o->stride[i]) return 0;
   }
 
-  // creates an ndarray from the blitz::Array<>.data()
+  Py_INCREF(nd);
+  return nd;
+}
+
+/**
+ * Creates a new numpy.ndarray view on the blitz::Array<>.data(), with this
+ * object as base, and remembers it (weakly) for later conversions
+ */
+static PyObject* new_ndarray_view(PyBlitzArrayObject* o) {
+
+  // read-only arrays (e.g. read-only file mappings) give read-only views
   PyArray_Descr* dtype = PyArray_DescrFromType(o->type_num); //borrowed
   PyObject* retval = PyArray_NewFromDescr(&PyArray_Type,
       dtype,
       o->ndim, o->shape, o->stride, o->data,
 #     if NPY_FEATURE_VERSION >= NUMPY17_API /* NumPy C-API version >= 1.7 */
-      NPY_ARRAY_CARRAY,
+      o->writeable ? NPY_ARRAY_CARRAY : NPY_ARRAY_CARRAY_RO,
 #     else
-      NPY_CARRAY,
+      o->writeable ? NPY_CARRAY : NPY_CARRAY_RO,
 #     endif
       0);
 
   if (!retval) return 0;
 
   // link this object with the returned numpy ndarray
+  PyObject* pyo = reinterpret_cast<PyObject*>(o);
 
 #if NPY_FEATURE_VERSION < NUMPY17_API /* NumPy C-API version >= 1.7 */
-  PyArray_BASE(reinterpret_cast<PyArrayObject*>(retval)) = reinterpret_cast<PyObject*>(o);
+  PyArray_BASE(reinterpret_cast<PyArrayObject*>(retval)) = pyo;
 #else
-  if (PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(retval), reinterpret_cast<PyObject*>(o)) != 0) {
+  if (PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(retval), pyo) != 0) {
     Py_DECREF(retval);
     return 0;
   }
 #endif
-  Py_INCREF(reinterpret_cast<PyObject*>(o));
+  Py_INCREF(pyo);
+  o->viewed = 1;
 
-  // if newtype was specified and the types are not equivalent, cast
-  if (newtype && !PyArray_EquivTypenums(newtype->type_num, o->type_num)) {
-    PyObject* new_retval = PyArray_FromArray(reinterpret_cast<PyArrayObject*>(retval),
-        newtype,
-#       if NPY_FEATURE_VERSION >= NUMPY17_API /* NumPy C-API version >= 1.7 */
-        NPY_ARRAY_FORCECAST
-#       else
-        NPY_FORCECAST
-#       endif
-        );
-    Py_DECREF(retval);
-    retval = new_retval;
+  // note: the cache is only an optimisation, failing to set it is not fatal
+  Py_XDECREF(o->npy_view);
+  o->npy_view = PyWeakref_NewRef(retval, 0);
+  if (!o->npy_view) PyErr_Clear();
+
+  return retval;
+
+}
+
+PyObject* PyBlitzArray_AsNumpyArray(PyBlitzArrayObject* o, PyArray_Descr* newtype) {
+
+  // if o->base is a numpy array, return it
+  if (o->base && PyArray_Check(o->base)) {
+    if (newtype) return PyArray_FromArray(reinterpret_cast<PyArrayObject*>(o->base), newtype,
+#       if NPY_FEATURE_VERSION >= NUMPY17_API /* NumPy C-API version >= 1.7 */
+        NPY_ARRAY_FORCECAST
+#       else
+        NPY_FORCECAST
+#       endif
+        );
+    Py_INCREF(o->base);
+    return o->base;
+  }
+
+  // re-uses the last view handed out or creates an ndarray from the
+  // blitz::Array<>.data()
+  PyObject* retval = cached_ndarray_view(o);
+  if (!retval) retval = new_ndarray_view(o);
+
+  if (!retval) return 0;
+
+  // if newtype was specified and the types are not equivalent, cast
+  if (newtype && !PyArray_EquivTypenums(newtype->type_num, o->type_num)) {
+    PyObject* new_retval = PyArray_FromArray(reinterpret_cast<PyArrayObject*>(retval),
+        newtype,
+#       if NPY_FEATURE_VERSION >= NUMPY17_API /* NumPy C-API version >= 1.7 */
+        NPY_ARRAY_FORCECAST
+#       else
+        NPY_FORCECAST
+#       endif
+        );
+    Py_DECREF(retval);
+    retval = new_retval;
   }
 
   return retval;
@@ -905,12 +1367,17 @@ static int ndarray_behaves (PyArrayObject* o) {
 
   PyArrayObject* ao = reinterpret_cast<PyArrayObject*>(o);
 
-  // checks if the array is C-style and memory aligned
+  // checks if the array is memory aligned and in native byte order
   if (!PyArray_ISBEHAVED_RO(ao)) return 0;
 
   // checks if the number of dimensions is supported
   if (PyArray_NDIM(ao) < 1 || PyArray_NDIM(ao) > BOB_BLITZ_MAXDIMS) return 0;
 
+  // any strides (negative, transposed, sliced) are fine, as long as
+  // blitz++ can express them in number of elements
+  for (int i=0; i<PyArray_NDIM(ao); ++i)
+    if (PyArray_STRIDES(ao)[i] % PyArray_ITEMSIZE(ao)) return 0;
+
   // checks if the type number if supported
   switch(fix_integer_type_num(PyArray_DESCR(ao)->type_num)) {
     case NPY_BOOL:
@@ -950,7 +1417,7 @@ PyObject* PyBlitzArray_FromNumpyArray(PyArrayObject* o) {
   }
 
   if (!ndarray_behaves(o)) {
-    PyErr_Format(PyExc_ValueError, "cannot convert `%s' which doesn't behave (memory contiguous, aligned, C-style, minimum 1 and up to %d dimensions) into a `%s'", Py_TYPE(o)->tp_name, BOB_BLITZ_MAXDIMS, PyBlitzArray_Type.tp_name);
+    PyErr_Format(PyExc_ValueError, "cannot convert `%s' which doesn't behave (memory aligned, native byte order, strides multiple of the element size, minimum 1 and up to %d dimensions) into a `%s'", Py_TYPE(o)->tp_name, BOB_BLITZ_MAXDIMS, PyBlitzArray_Type.tp_name);
     return 0;
   }
 
@@ -980,33 +1447,15 @@ PyObject* PyBlitzArray_FromNumpyArray(PyArrayObject* o) {
 PyObject* PyBlitzArray_NUMPY_WRAP(PyObject* bz) {
 
   if (!bz) return bz;
+  PyBlitzStats_Wrapped();
 
   PyBlitzArrayObject* o = reinterpret_cast<PyBlitzArrayObject*>(bz);
 
-  // creates an ndarray from the blitz::Array<>.data()
-  PyArray_Descr* dtype = PyArray_DescrFromType(o->type_num); //borrowed
-  PyObject* retval = PyArray_NewFromDescr(&PyArray_Type,
-      dtype,
-      o->ndim, o->shape, o->stride, o->data,
-#     if NPY_FEATURE_VERSION >= NUMPY17_API /* NumPy C-API version >= 1.7 */
-      NPY_ARRAY_CARRAY,
-#     else
-      NPY_CARRAY,
-#     endif
-      0);
-
-  if (!retval) return 0;
-
-  // link this object with the returned numpy ndarray
-
-#if NPY_FEATURE_VERSION < NUMPY17_API /* NumPy C-API version >= 1.7 */
-  PyArray_BASE(reinterpret_cast<PyArrayObject*>(retval)) = bz;
-#else
-  if (PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(retval), bz) != 0) {
-    Py_DECREF(retval);
-    return 0;
-  }
-#endif
+  // creates an ndarray from the blitz::Array<>.data(), the view holds its own
+  // reference to `bz', so we release the stolen one
+  PyObject* retval = cached_ndarray_view(o);
+  if (!retval) retval = new_ndarray_view(o);
+  Py_DECREF(bz);
 
   return retval;
 
@@ -1127,8 +1576,21 @@ int PyBlitzArray_BehavedConverter(PyObject* o, PyBlitzArrayObject** a) {
 
   // check if array is behaved
   if (!PyArray_ISCARRAY_RO(arr)) { //copies and discard non-behaved
-    PyObject* tmp = PyArray_NewCopy(arr, NPY_ANYORDER);
+    int reason = PyBlitzArray_COPY_NONCONTIGUOUS;
+    if (!PyArray_ISALIGNED(arr)) reason = PyBlitzArray_COPY_MISALIGNED;
+    if (!PyArray_ISNOTSWAPPED(arr)) reason = PyBlitzArray_COPY_DTYPE;
+    // the copy is C-contiguous, aligned and in native byte order
+    PyArray_Descr* descr = PyArray_DescrNewByteorder(PyArray_DESCR(arr), NPY_NATIVE);
+    PyObject* tmp = descr ? PyArray_FromArray(arr, descr,
+#       if NPY_FEATURE_VERSION >= NUMPY17_API /* NumPy C-API version >= 1.7 */
+        NPY_ARRAY_CARRAY_RO | NPY_ARRAY_ENSURECOPY
+#       else
+        NPY_CARRAY_RO | NPY_ENSURECOPY
+#       endif
+        ) : 0; ///< steals descr
     Py_DECREF(ao);
+    if (!tmp) return 0;
+    PyBlitzStats_Copied(reason, PyArray_NBYTES(reinterpret_cast<PyArrayObject*>(tmp)));
     ao = tmp;
     arr = reinterpret_cast<PyArrayObject*>(ao);
   }
@@ -1354,17 +1816,950 @@ size_t PyBlitzArray_TypenumSize (int type_num) {
 
 }
 
-PyObject* PyBlitzArray_Cast (PyBlitzArrayObject* o, int type_num) {
-  if (o->type_num == type_num) {
-    auto pyo = (PyObject*)o;
-    Py_INCREF(pyo);
-    return pyo;
+/***********************
+ * Memory-mapped Files *
+ ***********************/
+
+struct mapped_file {
+  void* addr;
+  size_t length;
+};
+
+#define BOB_BLITZ_MAPPED_FILE BOB_BLITZ_PREFIX ".mapped_file"
+
+static void mapped_file_delete(PyObject* capsule) {
+  mapped_file* m = reinterpret_cast<mapped_file*>(PyCapsule_GetPointer(capsule, BOB_BLITZ_MAPPED_FILE));
+  munmap(m->addr, m->length);
+  delete m;
+}
+
+/**
+ * Maps `nbytes' starting at `offset' of the file at `path' and returns a
+ * capsule that owns the mapping. `data' is set to the first mapped byte.
+ */
+static PyObject* map_file(const char* path, size_t offset, size_t nbytes,
+    const char* mode, int advice, void** data, int* writeable) {
+
+  int flags = O_RDONLY;
+  int prot = PROT_READ;
+  int share = MAP_SHARED;
+  *writeable = 0;
+
+  if (std::strcmp(mode, "r") == 0) {}
+  else if (std::strcmp(mode, "r+") == 0) {
+    flags = O_RDWR;
+    prot |= PROT_WRITE;
+    *writeable = 1;
+  }
+  else if (std::strcmp(mode, "c") == 0) {
+    prot |= PROT_WRITE;
+    share = MAP_PRIVATE; ///< copy-on-write, changes never reach the file
+    *writeable = 1;
+  }
+  else {
+    PyErr_Format(PyExc_ValueError, "file mapping mode should be one of `r', `r+' or `c', not `%s'", mode);
+    return 0;
+  }
+
+  if (!nbytes) {
+    PyErr_Format(PyExc_ValueError, "cannot map an array with no elements from file `%s'", path);
+    return 0;
+  }
+
+  int fd = open(path, flags);
+  if (fd < 0) return PyErr_SetFromErrnoWithFilename(PyExc_IOError, path);
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return PyErr_SetFromErrnoWithFilename(PyExc_IOError, path);
+  }
+
+  if ((size_t)st.st_size < offset || (size_t)st.st_size - offset < nbytes) {
+    close(fd);
+    PyErr_Format(PyExc_ValueError, "file `%s' has %" PY_FORMAT_SIZE_T "d bytes, but %" PY_FORMAT_SIZE_T "u are required starting at offset %" PY_FORMAT_SIZE_T "u", path, (Py_ssize_t)st.st_size, nbytes, offset);
+    return 0;
+  }
+
+  // mappings must start at a page boundary
+  const size_t page = sysconf(_SC_PAGESIZE);
+  const size_t delta = offset % page;
+  const size_t length = nbytes + delta;
+
+  void* addr = mmap(0, length, prot, share, fd, offset - delta);
+  close(fd); ///< the mapping keeps its own reference to the file
+  if (addr == MAP_FAILED) return PyErr_SetFromErrnoWithFilename(PyExc_IOError, path);
+
+  if (advice >= 0) madvise(addr, length, advice); ///< just a hint, ignore errors
+
+  mapped_file* m = new mapped_file;
+  m->addr = addr;
+  m->length = length;
+
+  PyObject* retval = PyCapsule_New(m, BOB_BLITZ_MAPPED_FILE, mapped_file_delete);
+  if (!retval) {
+    munmap(addr, length);
+    delete m;
+    return 0;
+  }
+
+  *data = reinterpret_cast<char*>(addr) + delta;
+  return retval;
+
+}
+
+/**
+ * Maps the file and wraps it as an array with the given strides (or the
+ * C-order ones, if `stride' is NULL)
+ */
+static PyObject* from_file_inner(const char* path, int type_num,
+    Py_ssize_t ndim, Py_ssize_t* shape, Py_ssize_t* stride, Py_ssize_t offset,
+    const char* mode, int advice) {
+
+  type_num = fix_integer_type_num(type_num);
+
+  if (!vtable_for(type_num, ndim)) {
+    unsupported_type_or_ndim("map", type_num, ndim);
+    return 0;
+  }
+
+  const size_t itemsize = PyBlitzArray_TypenumSize(type_num);
+
+  if (offset < 0 || offset % itemsize) {
+    PyErr_Format(PyExc_ValueError, "offset into file `%s' should be a non-negative multiple of the element size (%" PY_FORMAT_SIZE_T "u bytes), not %" PY_FORMAT_SIZE_T "d", path, itemsize, offset);
+    return 0;
+  }
+
+  size_t nbytes = itemsize;
+  for (Py_ssize_t i=0; i<ndim; ++i) {
+    if (shape[i] < 0 || (shape[i] && nbytes > std::numeric_limits<size_t>::max() / shape[i])) {
+      PyErr_Format(PyExc_ValueError, "invalid shape for mapping file `%s'", path);
+      return 0;
+    }
+    nbytes *= shape[i];
+  }
+
+  Py_ssize_t c_stride[BOB_BLITZ_MAXDIMS];
+  if (!stride) {
+    stride = c_stride;
+    Py_ssize_t acc = itemsize;
+    for (Py_ssize_t i=ndim-1; i>=0; --i) {
+      c_stride[i] = acc;
+      acc *= shape[i];
+    }
+  }
+
+  void* data = 0;
+  int writeable = 0;
+  PyObject* owner = map_file(path, offset, nbytes, mode, advice, &data, &writeable);
+  if (!owner) return 0;
+
+  PyObject* retval = PyBlitzArray_SimpleNewFromData(type_num, ndim, shape, stride, data, writeable);
+  if (!retval) {
+    Py_DECREF(owner);
+    return 0;
+  }
+
+  // the array keeps the mapping alive
+  reinterpret_cast<PyBlitzArrayObject*>(retval)->base = owner;
+  return retval;
+
+}
+
+PyObject* PyBlitzArray_FromFile(const char* path, int type_num,
+    Py_ssize_t ndim, Py_ssize_t* shape, Py_ssize_t offset, const char* mode,
+    int advice) {
+
+  return from_file_inner(path, type_num, ndim, shape, 0, offset, mode, advice);
+
+}
+
+PyObject* PyBlitzArray_FromNpyFile(const char* path, const char* mode,
+    int advice) {
+
+  // reads the fixed part of the header
+  FILE* f = std::fopen(path, "rb");
+  if (!f) return PyErr_SetFromErrnoWithFilename(PyExc_IOError, path);
+
+  unsigned char preamble[12];
+  size_t got = std::fread(preamble, 1, sizeof(preamble), f);
+
+  if (got < 10 || std::memcmp(preamble, "\x93NUMPY", 6) != 0 ||
+      preamble[6] < 1 || preamble[6] > 3) {
+    std::fclose(f);
+    PyErr_Format(PyExc_ValueError, "file `%s' is not in a supported .npy format", path);
+    return 0;
+  }
+
+  const int major = preamble[6];
+  size_t start = 10;
+  size_t header_len = preamble[8] | (preamble[9] << 8);
+  if (major >= 2) {
+    if (got < 12) {
+      std::fclose(f);
+      PyErr_Format(PyExc_ValueError, "file `%s' is not in a supported .npy format", path);
+      return 0;
+    }
+    start = 12;
+    header_len |= (size_t(preamble[10]) << 16) | (size_t(preamble[11]) << 24);
+  }
+
+  // reads the header, a python dictionary literal
+  std::vector<char> header(header_len);
+  bool ok = std::fseek(f, start, SEEK_SET) == 0 &&
+    std::fread(header.data(), 1, header_len, f) == header_len;
+  std::fclose(f);
+
+  if (!ok) {
+    PyErr_Format(PyExc_ValueError, "file `%s' is truncated: cannot read the .npy header", path);
+    return 0;
+  }
+
+  PyObject* text = (major >= 3) ?
+    PyUnicode_DecodeUTF8(header.data(), header_len, "strict") :
+    PyUnicode_DecodeLatin1(header.data(), header_len, "strict");
+  if (!text) return 0;
+  auto text_ = make_safe(text);
+
+  PyObject* ast = PyImport_ImportModule("ast");
+  if (!ast) return 0;
+  auto ast_ = make_safe(ast);
+
+  PyObject* dict = PyObject_CallMethod(ast, const_cast<char*>("literal_eval"), const_cast<char*>("O"), text);
+  if (!dict) return 0;
+  auto dict_ = make_safe(dict);
+
+  PyObject* descr_obj = PyDict_Check(dict) ? PyDict_GetItemString(dict, "descr") : 0;
+  PyObject* fortran_obj = PyDict_Check(dict) ? PyDict_GetItemString(dict, "fortran_order") : 0;
+  PyObject* shape_obj = PyDict_Check(dict) ? PyDict_GetItemString(dict, "shape") : 0;
+
+  if (!descr_obj || !fortran_obj || !shape_obj) {
+    PyErr_Format(PyExc_ValueError, "file `%s' has an invalid .npy header", path);
+    return 0;
+  }
+
+  PyArray_Descr* descr = 0;
+  if (!PyArray_DescrConverter(descr_obj, &descr)) return 0;
+  auto descr_ = make_safe(descr);
+
+  if (!PyArray_ISNBO(descr->byteorder)) {
+    PyErr_Format(PyExc_ValueError, "file `%s' has data in non-native byte order, which cannot be mapped", path);
+    return 0;
+  }
+
+  int fortran = PyObject_IsTrue(fortran_obj);
+  if (fortran < 0) return 0;
+
+  PyBlitzArrayObject shape;
+  PyBlitzArrayObject* shape_p = &shape;
+  if (!PyBlitzArray_IndexConverter(shape_obj, &shape_p)) return 0;
+
+  const int type_num = fix_integer_type_num(descr->type_num);
+  const Py_ssize_t itemsize = PyBlitzArray_TypenumSize(type_num);
+
+  Py_ssize_t stride[BOB_BLITZ_MAXDIMS];
+  Py_ssize_t acc = itemsize;
+  for (Py_ssize_t k=0; k<shape.ndim; ++k) {
+    Py_ssize_t i = fortran ? k : shape.ndim - 1 - k;
+    stride[i] = acc;
+    acc *= shape.shape[i];
+  }
+
+  return from_file_inner(path, type_num, shape.ndim, shape.shape, stride,
+      start + header_len, mode, advice);
+
+}
+
+/***********
+ * Slicing *
+ ***********/
+
+/**
+ * What a subscript selects along one dimension of the indexed array: either a
+ * single position, in which case the dimension is dropped, or `length'
+ * positions, `step' apart from each other
+ */
+struct dim_selection {
+  Py_ssize_t start;
+  Py_ssize_t step;
+  Py_ssize_t length;
+  bool drop;
+};
+
+/**
+ * Parses a subscript (integer, slice, Ellipsis or tuple of those) against the
+ * shape of `o'. Returns the number of dimensions kept or -1 on error.
+ */
+static int parse_subscript(PyBlitzArrayObject* o, PyObject* index,
+    dim_selection* sel) {
+
+  PyObject* items = index;
+  if (PyTuple_Check(index)) Py_INCREF(items);
+  else items = PyTuple_Pack(1, index);
+  if (!items) return -1;
+  auto items_ = make_safe(items);
+
+  Py_ssize_t n = PyTuple_GET_SIZE(items);
+  Py_ssize_t ellipsis = -1;
+  for (Py_ssize_t k=0; k<n; ++k) {
+    if (PyTuple_GET_ITEM(items, k) != Py_Ellipsis) continue;
+    if (ellipsis >= 0) {
+      PyErr_SetString(PyExc_IndexError, "an index can only have a single ellipsis ('...')");
+      return -1;
+    }
+    ellipsis = k;
+  }
+
+  const Py_ssize_t given = n - (ellipsis >= 0 ? 1 : 0);
+  if (given > o->ndim) {
+    PyErr_Format(PyExc_IndexError, "too many indices for %s(@%" PY_FORMAT_SIZE_T "d,'%s'): %" PY_FORMAT_SIZE_T "d were given", Py_TYPE(o)->tp_name, o->ndim, PyBlitzArray_TypenumAsString(o->type_num), given);
+    return -1;
+  }
+
+  int kept = 0;
+  Py_ssize_t d = 0;
+  for (Py_ssize_t k=0; k<n; ++k) {
+
+    PyObject* item = PyTuple_GET_ITEM(items, k);
+
+    if (item == Py_Ellipsis) {
+      // expands to as many full slices as needed
+      for (Py_ssize_t e=0; e<o->ndim-given; ++e, ++d, ++kept)
+        sel[d] = {0, 1, o->shape[d], false};
+      continue;
+    }
+
+    if (PySlice_Check(item)) {
+      Py_ssize_t start, stop, step, length;
+#     if PY_VERSION_HEX >= 0x03020000
+      if (PySlice_GetIndicesEx(item, o->shape[d], &start, &stop, &step, &length) < 0) return -1;
+#     else
+      if (PySlice_GetIndicesEx(reinterpret_cast<PySliceObject*>(item), o->shape[d], &start, &stop, &step, &length) < 0) return -1;
+#     endif
+      sel[d++] = {start, step, length, false};
+      ++kept;
+      continue;
+    }
+
+    if (PyBob_NumberCheck(item)) {
+      const Py_ssize_t given_pos = PyNumber_AsSsize_t(item, PyExc_IndexError);
+      if (given_pos == -1 && PyErr_Occurred()) return -1;
+      const Py_ssize_t pos = given_pos < 0 ? given_pos + o->shape[d] : given_pos;
+      if (pos < 0 || pos >= o->shape[d]) {
+        PyErr_Format(PyExc_IndexError, "%s(@%" PY_FORMAT_SIZE_T "d,'%s') position %" PY_FORMAT_SIZE_T "d is out of range: %" PY_FORMAT_SIZE_T "d not in [0,%" PY_FORMAT_SIZE_T "d[", Py_TYPE(o)->tp_name, o->ndim, PyBlitzArray_TypenumAsString(o->type_num), d, given_pos, o->shape[d]);
+        return -1;
+      }
+      sel[d++] = {pos, 1, 1, true};
+      continue;
+    }
+
+    PyErr_Format(PyExc_TypeError, "%s(@%" PY_FORMAT_SIZE_T "d,'%s') can only be indexed by integers, slices and ellipsis ('...'), not `%s'", Py_TYPE(o)->tp_name, o->ndim, PyBlitzArray_TypenumAsString(o->type_num), Py_TYPE(item)->tp_name);
+    return -1;
+
+  }
+
+  // dimensions not indexed are taken entirely
+  for (; d<o->ndim; ++d, ++kept) sel[d] = {0, 1, o->shape[d], false};
+
+  return kept;
+
+}
+
+/**
+ * Builds a view of `o' given a parsed subscript, with `o' as its base
+ */
+static PyObject* subscript_view(PyBlitzArrayObject* o, dim_selection* sel) {
+
+  Py_ssize_t shape[BOB_BLITZ_MAXDIMS];
+  Py_ssize_t stride[BOB_BLITZ_MAXDIMS];
+  Py_ssize_t ndim = 0;
+  char* data = reinterpret_cast<char*>(o->data);
+
+  for (Py_ssize_t i=0; i<o->ndim; ++i) {
+    if (sel[i].length) data += sel[i].start * o->stride[i];
+    if (sel[i].drop) continue;
+    shape[ndim] = sel[i].length;
+    stride[ndim] = sel[i].step * o->stride[i];
+    ++ndim;
+  }
+
+  PyObject* retval = PyBlitzArray_SimpleNewFromData(o->type_num, ndim, shape,
+      stride, data, o->writeable);
+  if (!retval) return 0;
+
+  reinterpret_cast<PyBlitzArrayObject*>(retval)->base = reinterpret_cast<PyObject*>(o);
+  Py_INCREF(o);
+  return retval;
+
+}
+
+PyObject* PyBlitzArray_GetSubscript(PyBlitzArrayObject* o, PyObject* index) {
+
+  dim_selection sel[BOB_BLITZ_MAXDIMS];
+  int kept = parse_subscript(o, index, sel);
+  if (kept < 0) return 0;
+
+  if (kept == 0) {
+    Py_ssize_t pos[BOB_BLITZ_MAXDIMS];
+    for (Py_ssize_t i=0; i<o->ndim; ++i) pos[i] = sel[i].start;
+    return PyBlitzArray_GetItem(o, pos);
+  }
+
+  PyObject* retval = subscript_view(o, sel);
+  if (retval) o->viewed = 1;
+  return retval;
+
+}
+
+/**
+ * Computes the span of memory [lo, hi[ touched by an array, in bytes. Returns
+ * false if the array has no elements.
+ */
+static bool memory_span(char* data, int ndim, const npy_intp* shape,
+    const npy_intp* stride, size_t itemsize, char** lo, char** hi) {
+
+  *lo = *hi = data;
+  for (int i=0; i<ndim; ++i) {
+    if (!shape[i]) return false;
+    if (stride[i] < 0) *lo += stride[i] * (shape[i]-1);
+    else *hi += stride[i] * (shape[i]-1);
+  }
+  *hi += itemsize;
+  return true;
+
+}
+
+int PyBlitzArray_SetSubscript(PyBlitzArrayObject* o, PyObject* index,
+    PyObject* value) {
+
+  if (!o->writeable) {
+    PyErr_Format(PyExc_RuntimeError, "cannot set item on read-only %s(@%" PY_FORMAT_SIZE_T "d,%s) ", Py_TYPE(o)->tp_name, o->ndim, PyBlitzArray_TypenumAsString(o->type_num));
+    return -1;
+  }
+
+  dim_selection sel[BOB_BLITZ_MAXDIMS];
+  int kept = parse_subscript(o, index, sel);
+  if (kept < 0) return -1;
+
+  if (kept == 0) {
+    Py_ssize_t pos[BOB_BLITZ_MAXDIMS];
+    for (Py_ssize_t i=0; i<o->ndim; ++i) pos[i] = sel[i].start;
+    return PyBlitzArray_SetItem(o, pos, value);
+  }
+
+  PyObject* view = subscript_view(o, sel);
+  if (!view) return -1;
+  auto view_ = make_safe(view);
+  PyBlitzArrayObject* dst = reinterpret_cast<PyBlitzArrayObject*>(view);
+
+  // lazy expressions are evaluated directly into the selection
+  if (PyBlitzExpr_Check(value)) return PyBlitzExpr_EvalInto(value, dst);
+
+  if (PyBob_NumberCheck(value)) return dst->vtable->fill(dst, value);
+
+  // converts the source to the destination type, in native byte order
+  PyArray_Descr* descr = PyArray_DescrFromType(dst->type_num);
+  PyObject* src = PyArray_FromAny(value, descr, 0, dst->ndim,
+      NPY_ARRAY_ALIGNED | NPY_ARRAY_NOTSWAPPED | NPY_ARRAY_FORCECAST, 0);
+  if (!src) return -1;
+  auto src_ = make_safe(src);
+  PyArrayObject* ao = reinterpret_cast<PyArrayObject*>(src);
+
+  if (PyArray_NDIM(ao) == 0) {
+    PyObject* scalar = PyArray_ToScalar(PyArray_DATA(ao), ao);
+    if (!scalar) return -1;
+    auto scalar_ = make_safe(scalar);
+    return dst->vtable->fill(dst, scalar);
+  }
+
+  // sources sharing memory with the destination are copied first
+  char *dlo, *dhi, *slo, *shi;
+  const size_t itemsize = PyArray_ITEMSIZE(ao);
+  if (!memory_span(reinterpret_cast<char*>(dst->data), dst->ndim, dst->shape,
+        dst->stride, itemsize, &dlo, &dhi)) return 0;
+  bool copy = memory_span(PyArray_BYTES(ao), PyArray_NDIM(ao),
+      PyArray_DIMS(ao), PyArray_STRIDES(ao), itemsize, &slo, &shi) &&
+    slo < dhi && dlo < shi;
+  for (int i=0; i<PyArray_NDIM(ao); ++i)
+    if (PyArray_STRIDES(ao)[i] % (npy_intp)itemsize) copy = true;
+  if (copy) {
+    src = PyArray_NewCopy(ao, NPY_ANYORDER);
+    if (!src) return -1;
+    src_ = make_safe(src);
+    ao = reinterpret_cast<PyArrayObject*>(src);
+  }
+
+  // broadcasts the source to the shape of the destination
+  Py_ssize_t stride[BOB_BLITZ_MAXDIMS];
+  const int offset = dst->ndim - PyArray_NDIM(ao);
+  for (int i=0; i<dst->ndim; ++i) {
+    if (i < offset) { stride[i] = 0; continue; }
+    const npy_intp extent = PyArray_DIMS(ao)[i-offset];
+    if (extent == dst->shape[i]) stride[i] = PyArray_STRIDES(ao)[i-offset];
+    else if (extent == 1) stride[i] = 0;
+    else {
+      PyErr_Format(PyExc_ValueError, "cannot broadcast input of %d dimension(s) with extent %" PY_FORMAT_SIZE_T "d at position %d into a selection of extent %" PY_FORMAT_SIZE_T "d", PyArray_NDIM(ao), (Py_ssize_t)extent, i-offset, dst->shape[i]);
+      return -1;
+    }
+  }
+
+  PyObject* bz = PyBlitzArray_SimpleNewFromData(dst->type_num, dst->ndim,
+      dst->shape, stride, PyArray_DATA(ao), 0);
+  if (!bz) return -1;
+  auto bz_ = make_safe(bz);
+
+  dst->vtable->assign(dst, reinterpret_cast<PyBlitzArrayObject*>(bz));
+  return 0;
+
+}
+
+/***********************
+ * Bulk Element Access *
+ ***********************/
+
+/**
+ * Converts an array of positions in `o' (one per row, with one column per
+ * dimension) into offsets in bytes from its first element. Negative positions
+ * are normalized and all of them are checked before anything is returned.
+ * Returns the number of positions or -1 on error.
+ */
+static npy_intp position_offsets(PyBlitzArrayObject* o, PyObject* indices,
+    std::vector<npy_intp>& offsets) {
+
+  PyArrayObject* ai = reinterpret_cast<PyArrayObject*>(PyArray_FromAny(indices, 0, 0, 0, 0, 0));
+  if (!ai) return -1;
+  auto ai_ = make_safe(ai);
+
+  if (PyArray_SIZE(ai) && !PyArray_ISINTEGER(ai)) {
+    PyErr_Format(PyExc_TypeError, "positions in %s(@%" PY_FORMAT_SIZE_T "d,'%s') should be integers, not `%s'", Py_TYPE(o)->tp_name, o->ndim, PyBlitzArray_TypenumAsString(o->type_num), PyBlitzArray_TypenumAsString(PyArray_DESCR(ai)->type_num));
+    return -1;
+  }
+
+  npy_intp count = 0;
+  if (PyArray_NDIM(ai) == 2 && PyArray_DIM(ai, 1) == o->ndim) count = PyArray_DIM(ai, 0);
+  else if (PyArray_NDIM(ai) == 1 && o->ndim == 1) count = PyArray_DIM(ai, 0);
+  else if (PyArray_NDIM(ai) == 1 && PyArray_SIZE(ai) == 0) count = 0;
+  else {
+    PyErr_Format(PyExc_ValueError, "positions in %s(@%" PY_FORMAT_SIZE_T "d,'%s') should be given as an array with one row per position and %" PY_FORMAT_SIZE_T "d column(s)", Py_TYPE(o)->tp_name, o->ndim, PyBlitzArray_TypenumAsString(o->type_num), o->ndim);
+    return -1;
+  }
+
+  PyArrayObject* pos = reinterpret_cast<PyArrayObject*>(PyArray_FROMANY(
+        reinterpret_cast<PyObject*>(ai), NPY_INTP, 0, 0,
+        NPY_ARRAY_CARRAY_RO | NPY_ARRAY_FORCECAST));
+  if (!pos) return -1;
+  auto pos_ = make_safe(pos);
+
+  offsets.resize(count);
+  const npy_intp* p = reinterpret_cast<const npy_intp*>(PyArray_DATA(pos));
+  for (npy_intp k=0; k<count; ++k) {
+    npy_intp offset = 0;
+    for (Py_ssize_t i=0; i<o->ndim; ++i, ++p) {
+      const npy_intp v = *p < 0 ? *p + o->shape[i] : *p;
+      if (v < 0 || v >= o->shape[i]) {
+        PyErr_Format(PyExc_IndexError, "%s(@%" PY_FORMAT_SIZE_T "d,'%s') position %" PY_FORMAT_SIZE_T "d is out of range at entry %" PY_FORMAT_SIZE_T "d: %" PY_FORMAT_SIZE_T "d not in [0,%" PY_FORMAT_SIZE_T "d[", Py_TYPE(o)->tp_name, o->ndim, PyBlitzArray_TypenumAsString(o->type_num), i, (Py_ssize_t)k, (Py_ssize_t)*p, o->shape[i]);
+        return -1;
+      }
+      offset += v * o->stride[i];
+    }
+    offsets[k] = offset;
+  }
+
+  return count;
+
+}
+
+PyObject* PyBlitzArray_Take(PyBlitzArrayObject* o, PyObject* indices) {
+
+  if (!o->vtable) {
+    PyErr_Format(PyExc_NotImplementedError, "cannot take items from %s(@%" PY_FORMAT_SIZE_T "d,T) with T being a data type with an unsupported numpy type number = %d", Py_TYPE(o)->tp_name, o->ndim, o->type_num);
+    return 0;
+  }
+
+  std::vector<npy_intp> offsets;
+  Py_ssize_t count = position_offsets(o, indices, offsets);
+  if (count < 0) return 0;
+
+  PyObject* retval = PyBlitzArray_SimpleNew(o->type_num, 1, &count);
+  if (!retval) return 0;
+
+  o->vtable->take(o, offsets.data(), count,
+      reinterpret_cast<PyBlitzArrayObject*>(retval)->data);
+  return retval;
+
+}
+
+int PyBlitzArray_Put(PyBlitzArrayObject* o, PyObject* indices,
+    PyObject* values) {
+
+  if (!o->writeable) {
+    PyErr_Format(PyExc_RuntimeError, "cannot put items on read-only %s(@%" PY_FORMAT_SIZE_T "d,%s) ", Py_TYPE(o)->tp_name, o->ndim, PyBlitzArray_TypenumAsString(o->type_num));
+    return -1;
+  }
+
+  if (!o->vtable) {
+    PyErr_Format(PyExc_NotImplementedError, "cannot put items on %s(@%" PY_FORMAT_SIZE_T "d,T) with T being a data type with an unsupported numpy type number = %d", Py_TYPE(o)->tp_name, o->ndim, o->type_num);
+    return -1;
+  }
+
+  std::vector<npy_intp> offsets;
+  npy_intp count = position_offsets(o, indices, offsets);
+  if (count < 0) return -1;
+
+  // converts the values to the type of `o', in native byte order
+  PyArray_Descr* descr = PyArray_DescrFromType(o->type_num);
+  PyArrayObject* av = reinterpret_cast<PyArrayObject*>(PyArray_FromAny(values,
+        descr, 0, 1, NPY_ARRAY_ALIGNED | NPY_ARRAY_NOTSWAPPED |
+        NPY_ARRAY_FORCECAST, 0));
+  if (!av) return -1;
+  auto av_ = make_safe(av);
+
+  npy_intp step = 0;
+  if (PyArray_NDIM(av) == 1 && PyArray_DIM(av, 0) != 1) {
+    if (PyArray_DIM(av, 0) != count) {
+      PyErr_Format(PyExc_ValueError, "cannot put %" PY_FORMAT_SIZE_T "d value(s) on %" PY_FORMAT_SIZE_T "d position(s) of %s(@%" PY_FORMAT_SIZE_T "d,'%s')", (Py_ssize_t)PyArray_DIM(av, 0), (Py_ssize_t)count, Py_TYPE(o)->tp_name, o->ndim, PyBlitzArray_TypenumAsString(o->type_num));
+      return -1;
+    }
+    step = PyArray_STRIDE(av, 0);
+  }
+
+  // values sharing memory with the destination are copied first
+  char *olo, *ohi, *vlo, *vhi;
+  if (!count || !memory_span(reinterpret_cast<char*>(o->data), o->ndim,
+        o->shape, o->stride, PyArray_ITEMSIZE(av), &olo, &ohi)) return 0;
+  if (memory_span(PyArray_BYTES(av), PyArray_NDIM(av), PyArray_DIMS(av),
+        PyArray_STRIDES(av), PyArray_ITEMSIZE(av), &vlo, &vhi) &&
+      vlo < ohi && olo < vhi) {
+    av = reinterpret_cast<PyArrayObject*>(PyArray_NewCopy(av, NPY_ANYORDER));
+    if (!av) return -1;
+    av_ = make_safe(av);
+    if (step) step = PyArray_STRIDE(av, 0);
+  }
+
+  o->vtable->put(o, offsets.data(), count, PyArray_DATA(av), step);
+  return 0;
+
+}
+
+/**************
+ * Arithmetic *
+ **************/
+
+/**
+ * Describes an operand of an element-wise operation: either a
+ * bob.blitz.array or any object numpy can convert into an array
+ */
+struct operand {
+  PyObject* object; ///< borrowed, the object given by the user
+  PyObject* array; ///< new reference: a bob.blitz.array or a numpy.ndarray
+  int ndim;
+  const Py_ssize_t* shape;
+  operand() : object(0), array(0), ndim(0), shape(0) {}
+  ~operand() { Py_XDECREF(array); }
+};
+
+/**
+ * Tells Python to try the reflected operation (or another fallback)
+ */
+static PyObject* not_implemented() {
+  Py_INCREF(Py_NotImplemented);
+  return Py_NotImplemented;
+}
+
+/**
+ * Prepares an operand, returns 0 (without an exception set) if the object is
+ * not something numpy can convert to an array of a supported type
+ */
+static int operand_init(operand& op, PyObject* o) {
+
+  op.object = o;
+
+  // lazy expressions handle operations with arrays themselves
+  if (PyBlitzExpr_Check(o)) return 0;
+
+  if (PyBlitzArray_Check(o)) {
+    PyBlitzArrayObject* bz = reinterpret_cast<PyBlitzArrayObject*>(o);
+    Py_INCREF(o);
+    op.array = o;
+    op.ndim = bz->ndim;
+    op.shape = bz->shape;
+    return 1;
+  }
+
+  op.array = PyArray_FromAny(o, 0, 0, BOB_BLITZ_MAXDIMS, 0, 0);
+  if (!op.array) {
+    PyErr_Clear();
+    return 0;
+  }
+
+  PyArrayObject* ao = reinterpret_cast<PyArrayObject*>(op.array);
+  if (!vtable_for(fix_integer_type_num(PyArray_DESCR(ao)->type_num), 1)) return 0;
+  op.ndim = PyArray_NDIM(ao);
+  op.shape = PyArray_DIMS(ao);
+  return 1;
+
+}
+
+/**
+ * Asks numpy for the type an operation between `a' and `b' should be
+ * evaluated in, so Python scalars follow the same promotion rules as in numpy.
+ * Returns NPY_NOTYPE (without an exception set) on failure.
+ */
+static int operation_type(operand& a, operand& b) {
+
+  static PyObject* result_type = 0;
+  if (!result_type) {
+    PyObject* numpy = PyImport_ImportModule("numpy");
+    if (!numpy) {
+      PyErr_Clear();
+      return NPY_NOTYPE;
+    }
+    result_type = PyObject_GetAttrString(numpy, "result_type");
+    Py_DECREF(numpy);
+    if (!result_type) {
+      PyErr_Clear();
+      return NPY_NOTYPE;
+    }
+  }
+
+  // our own arrays are passed as their data types, to avoid conversions,
+  // and scalars as they are, so they keep their (weak) type
+  PyObject* args[2];
+  const operand* ops[2] = {&a, &b};
+  for (int i=0; i<2; ++i) {
+    if (PyBlitzArray_Check(ops[i]->object))
+      args[i] = reinterpret_cast<PyObject*>(PyArray_DescrFromType(reinterpret_cast<PyBlitzArrayObject*>(ops[i]->object)->type_num));
+    else {
+      args[i] = PyArray_IsAnyScalar(ops[i]->object) ? ops[i]->object : ops[i]->array;
+      Py_INCREF(args[i]);
+    }
+  }
+  auto a_ = make_safe(args[0]);
+  auto b_ = make_safe(args[1]);
+
+  PyObject* retval = PyObject_CallFunctionObjArgs(result_type, args[0], args[1], 0);
+  if (!retval) {
+    PyErr_Clear();
+    return NPY_NOTYPE;
+  }
+  auto retval_ = make_safe(retval);
+
+  if (!PyArray_DescrCheck(retval)) return NPY_NOTYPE;
+  return fix_integer_type_num(reinterpret_cast<PyArray_Descr*>(retval)->type_num);
+
+}
+
+/**
+ * Computes the shape operands `a' and `b' broadcast to, following the numpy
+ * rules. Returns the number of dimensions or -1 on error.
+ */
+static int broadcast_shape(const operand& a, const operand& b,
+    Py_ssize_t* shape) {
+
+  const int ndim = std::max(a.ndim, b.ndim);
+  for (int i=0; i<ndim; ++i) {
+    const Py_ssize_t ea = i < ndim - a.ndim ? 1 : a.shape[i - (ndim - a.ndim)];
+    const Py_ssize_t eb = i < ndim - b.ndim ? 1 : b.shape[i - (ndim - b.ndim)];
+    if (ea == eb || eb == 1) shape[i] = ea;
+    else if (ea == 1) shape[i] = eb;
+    else {
+      PyErr_Format(PyExc_ValueError, "operands could not be broadcast together: extents %" PY_FORMAT_SIZE_T "d and %" PY_FORMAT_SIZE_T "d differ at position %d", ea, eb, i);
+      return -1;
+    }
+  }
+
+  return ndim;
+
+}
+
+/**
+ * Wraps an operand, converted to `type_num' if needed, as a read-only
+ * bob.blitz.array broadcast to `shape'. The operand is copied if it shares
+ * memory with `out', unless it is laid out exactly as `out'. Returns a new
+ * reference or 0 on error.
+ */
+static PyObject* broadcast_operand(const operand& op, int type_num, int ndim,
+    Py_ssize_t* shape, PyBlitzArrayObject* out) {
+
+  PyObject* source = op.array;
+  Py_INCREF(source);
+  auto source_ = make_safe(source);
+
+  PyBlitzArrayObject* bz = PyBlitzArray_Check(source) ?
+    reinterpret_cast<PyBlitzArrayObject*>(source) : 0;
+
+  if (bz && bz->type_num != type_num) {
+    source = PyBlitzArray_Cast(bz, type_num);
+    if (!source) return 0;
+    source_ = make_safe(source);
+    bz = reinterpret_cast<PyBlitzArrayObject*>(source);
+  }
+  else if (!bz) {
+    PyArray_Descr* descr = PyArray_DescrFromType(type_num);
+    source = PyArray_FromAny(source, descr, 0, 0,
+        NPY_ARRAY_ALIGNED | NPY_ARRAY_NOTSWAPPED | NPY_ARRAY_FORCECAST, 0);
+    if (!source) return 0;
+    source_ = make_safe(source);
+    bz = 0;
+  }
+
+  char* data = bz ? reinterpret_cast<char*>(bz->data) : PyArray_BYTES(reinterpret_cast<PyArrayObject*>(source));
+  int sndim = bz ? bz->ndim : PyArray_NDIM(reinterpret_cast<PyArrayObject*>(source));
+  const Py_ssize_t* sshape = bz ? bz->shape : PyArray_DIMS(reinterpret_cast<PyArrayObject*>(source));
+  const Py_ssize_t* sstride = bz ? bz->stride : PyArray_STRIDES(reinterpret_cast<PyArrayObject*>(source));
+  const size_t itemsize = PyBlitzArray_TypenumSize(type_num);
+
+  bool copy = false;
+  for (int i=0; i<sndim; ++i) if (sstride[i] % (Py_ssize_t)itemsize) copy = true;
+
+  if (out) {
+    char *olo, *ohi, *slo, *shi;
+    bool same = data == out->data && sndim == out->ndim;
+    for (int i=0; same && i<sndim; ++i)
+      same = sshape[i] == out->shape[i] && sstride[i] == out->stride[i];
+    if (!same &&
+        memory_span(reinterpret_cast<char*>(out->data), out->ndim, out->shape, out->stride, itemsize, &olo, &ohi) &&
+        memory_span(data, sndim, sshape, sstride, itemsize, &slo, &shi) &&
+        slo < ohi && olo < shi) copy = true;
+  }
+
+  if (copy) {
+    if (bz) {
+      source = PyBlitzArray_AsNumpyArray(bz, 0);
+      if (!source) return 0;
+      source_ = make_safe(source);
+    }
+    source = PyArray_NewCopy(reinterpret_cast<PyArrayObject*>(source), NPY_CORDER);
+    if (!source) return 0;
+    source_ = make_safe(source);
+    PyArrayObject* ao = reinterpret_cast<PyArrayObject*>(source);
+    data = PyArray_BYTES(ao);
+    sshape = PyArray_DIMS(ao);
+    sstride = PyArray_STRIDES(ao);
+  }
+
+  Py_ssize_t stride[BOB_BLITZ_MAXDIMS];
+  const int offset = ndim - sndim;
+  for (int i=0; i<ndim; ++i)
+    stride[i] = (i < offset || sshape[i-offset] == 1) ? 0 : sstride[i-offset];
+
+  PyObject* retval = PyBlitzArray_SimpleNewFromData(type_num, ndim, shape,
+      stride, data, 0);
+  if (!retval) return 0;
+
+  // keeps whatever holds the data alive
+  reinterpret_cast<PyBlitzArrayObject*>(retval)->base = source;
+  Py_INCREF(source);
+  return retval;
+
+}
+
+PyObject* PyBlitzArray_Arithmetic(PyObject* a, PyObject* b, char op,
+    int inplace) {
+
+  operand oa, ob;
+  if (!operand_init(oa, a) || !operand_init(ob, b)) return not_implemented();
+
+  int type_num = operation_type(oa, ob);
+  if (!vtable_for(type_num, 1)) return not_implemented();
+
+  // like numpy, divisions of integers give floating-point results
+  if (op == '/' && (PyTypeNum_ISINTEGER(type_num) || PyTypeNum_ISBOOL(type_num)))
+    type_num = NPY_FLOAT64;
+
+  if (op == '-' && type_num == NPY_BOOL) {
+    PyErr_SetString(PyExc_TypeError, "cannot subtract boolean arrays, use `^' (exclusive or) instead");
+    return 0;
   }
 
-  //non-matching type has been found, just cast using the NumPy C-API
-  PyObject* npy = PyBlitzArray_AsNumpyArray(o, PyArray_DescrFromType(type_num));
-  if (!npy) return 0;
-  PyObject* retval = PyBlitzArray_FromNumpyArray((PyArrayObject*)npy);
-  Py_DECREF(npy);
+  Py_ssize_t shape[BOB_BLITZ_MAXDIMS];
+  int ndim = broadcast_shape(oa, ob, shape);
+  if (ndim < 0) return 0;
+
+  if (inplace && PyBlitzArray_Check(a)) {
+
+    PyBlitzArrayObject* self = reinterpret_cast<PyBlitzArrayObject*>(a);
+
+    if (!self->writeable) {
+      PyErr_Format(PyExc_RuntimeError, "cannot modify read-only %s(@%" PY_FORMAT_SIZE_T "d,%s) in place", Py_TYPE(self)->tp_name, self->ndim, PyBlitzArray_TypenumAsString(self->type_num));
+      return 0;
+    }
+
+    if (type_num != self->type_num) {
+      PyArray_Descr* from = PyArray_DescrFromType(type_num);
+      PyArray_Descr* to = PyArray_DescrFromType(self->type_num);
+      const bool castable = PyArray_CanCastTypeTo(from, to, NPY_SAME_KIND_CASTING);
+      Py_DECREF(from);
+      Py_DECREF(to);
+      if (!castable) {
+        PyErr_Format(PyExc_TypeError, "cannot store the result of an operation on `%s' in-place in %s(@%" PY_FORMAT_SIZE_T "d,%s)", PyBlitzArray_TypenumAsString(type_num), Py_TYPE(self)->tp_name, self->ndim, PyBlitzArray_TypenumAsString(self->type_num));
+        return 0;
+      }
+    }
+
+    bool fits = ndim == self->ndim;
+    for (int i=0; fits && i<ndim; ++i) fits = shape[i] == self->shape[i];
+    if (!fits) {
+      PyErr_Format(PyExc_ValueError, "cannot broadcast the result of an in-place operation into %s(@%" PY_FORMAT_SIZE_T "d,%s) of a different shape", Py_TYPE(self)->tp_name, self->ndim, PyBlitzArray_TypenumAsString(self->type_num));
+      return 0;
+    }
+
+    PyObject* y = broadcast_operand(ob, self->type_num, ndim, shape, self);
+    if (!y) return 0;
+    auto y_ = make_safe(y);
+
+    self->vtable->arithmetic(op, self, self, reinterpret_cast<PyBlitzArrayObject*>(y));
+    Py_INCREF(a);
+    return a;
+
+  }
+
+  PyObject* x = broadcast_operand(oa, type_num, ndim, shape, 0);
+  if (!x) return 0;
+  auto x_ = make_safe(x);
+  PyObject* y = broadcast_operand(ob, type_num, ndim, shape, 0);
+  if (!y) return 0;
+  auto y_ = make_safe(y);
+
+  PyObject* retval = PyBlitzArray_SimpleNew(type_num, ndim, shape);
+  if (!retval) return 0;
+
+  PyBlitzArrayObject* out = reinterpret_cast<PyBlitzArrayObject*>(retval);
+  out->vtable->arithmetic(op, out, reinterpret_cast<PyBlitzArrayObject*>(x),
+      reinterpret_cast<PyBlitzArrayObject*>(y));
+  return retval;
+
+}
+
+PyObject* PyBlitzArray_RichCompare(PyObject* a, PyObject* b, int op) {
+
+  operand oa, ob;
+  if (!operand_init(oa, a) || !operand_init(ob, b)) return not_implemented();
+
+  int type_num = operation_type(oa, ob);
+  if (!vtable_for(type_num, 1)) return not_implemented();
+
+  // leaves ordering of complex numbers to numpy
+  if (PyTypeNum_ISCOMPLEX(type_num) && op != Py_EQ && op != Py_NE)
+    return not_implemented();
+
+  Py_ssize_t shape[BOB_BLITZ_MAXDIMS];
+  int ndim = broadcast_shape(oa, ob, shape);
+  if (ndim < 0) return 0;
+
+  PyObject* x = broadcast_operand(oa, type_num, ndim, shape, 0);
+  if (!x) return 0;
+  auto x_ = make_safe(x);
+  PyObject* y = broadcast_operand(ob, type_num, ndim, shape, 0);
+  if (!y) return 0;
+  auto y_ = make_safe(y);
+
+  PyObject* retval = PyBlitzArray_SimpleNew(NPY_BOOL, ndim, shape);
+  if (!retval) return 0;
+
+  PyBlitzArrayObject* bx = reinterpret_cast<PyBlitzArrayObject*>(x);
+  bx->vtable->compare(op, reinterpret_cast<PyBlitzArrayObject*>(retval), bx,
+      reinterpret_cast<PyBlitzArrayObject*>(y));
   return retval;
+
 }
@@ -7,8 +7,16 @@
 
 #define BOB_BLITZ_MODULE
 #include <bob.blitz/capi.h>
+#include <bob.blitz/cleanup.h>
 #include <bob.extension/documentation.h>
 #include <structmember.h>
+#include <sys/mman.h>
+#include <climits>
+
+extern PyObject* PyBlitzArray_Iter(PyBlitzArrayObject* a);
+extern PyObject* PyBlitzArray_Chunks(PyBlitzArrayObject* a, Py_ssize_t rows);
+extern PyObject* PyBlitzArray_Arithmetic(PyObject* a, PyObject* b, char op, int inplace);
+extern PyObject* PyBlitzArray_RichCompare(PyObject* a, PyObject* b, int op);
 
 auto array_doc = bob::extension::ClassDoc(
   BOB_EXT_MODULE_PREFIX ".array",
@@ -16,7 +24,8 @@ auto array_doc = bob::extension::ClassDoc(
   "Objects of this class hold a pointer to C++ ``blitz::Array<T,N>``. "
   "The C++ data type ``T`` is mapped to a :py:class:`numpy.dtype` object, while the extents and number of dimensions ``N`` are mapped to a shape, similar to what is done for :py:class:`numpy.ndarray` objects.\n\n"
   "Objects of this class can be wrapped in :py:class:`numpy.ndarray` quite efficiently, so that flexible numpy-like operations are possible on its contents. "
-  "You can also deploy objects of this class wherever :py:class:`numpy.ndarray`'s may be input."
+  "You can also deploy objects of this class wherever :py:class:`numpy.ndarray`'s may be input.\n\n"
+  "Objects of this class implement the buffer protocol, so that their contents can be accessed through :py:class:`memoryview` or written to files without copying."
 ).add_constructor(
   bob::extension::FunctionDoc(
     "array",
@@ -92,12 +101,7 @@ static Py_ssize_t PyBlitzArray_len (PyBlitzArrayObject* self) {
 static PyObject* PyBlitzArray_getitem(PyBlitzArrayObject* self,
     PyObject* item) {
 
-  if (PyBob_NumberCheck(item)) {
-
-    if (self->ndim != 1) {
-      PyErr_Format(PyExc_TypeError, "expected tuple for accessing %" PY_FORMAT_SIZE_T "dD array", self->ndim);
-      return 0;
-    }
+  if (PyBob_NumberCheck(item) && self->ndim == 1) {
 
     // if you get to this point, the user has passed single number
     Py_ssize_t k = PyNumber_AsSsize_t(item, PyExc_IndexError);
@@ -105,14 +109,14 @@ static PyObject* PyBlitzArray_getitem(PyBlitzArrayObject* self,
 
   }
 
-  if (PySequence_Check(item)) {
+  if (PySequence_Check(item) && !PyTuple_Check(item)) {
 
     if (self->ndim != PySequence_Fast_GET_SIZE(item)) {
-      PyErr_Format(PyExc_TypeError, "expected tuple of size %" PY_FORMAT_SIZE_T "d for accessing %" PY_FORMAT_SIZE_T "dD array", self->ndim, self->ndim);
+      PyErr_Format(PyExc_TypeError, "expected sequence of size %" PY_FORMAT_SIZE_T "d for accessing %" PY_FORMAT_SIZE_T "dD array", self->ndim, self->ndim);
       return 0;
     }
 
-    // if you get to this point, then the input tuple has the same size
+    // if you get to this point, then the input sequence has the same size
     PyBlitzArrayObject shape;
     PyBlitzArrayObject* shape_p = &shape;
     if (!PyBlitzArray_IndexConverter(item, &shape_p)) return 0;
@@ -120,19 +124,20 @@ static PyObject* PyBlitzArray_getitem(PyBlitzArrayObject* self,
 
   }
 
-  PyErr_Format(PyExc_TypeError, "%s(@%" PY_FORMAT_SIZE_T "d,'%s') indexing requires a single integers (for 1D arrays) or sequences, for any rank size", Py_TYPE(self)->tp_name, self->ndim, PyBlitzArray_TypenumAsString(self->type_num));
-  return 0;
+  // integers, slices, ellipsis or tuples of those
+  return PyBlitzArray_GetSubscript(self, item);
+
 }
 
 static int PyBlitzArray_setitem(PyBlitzArrayObject* self, PyObject* item,
     PyObject* value) {
 
-  if (PyBob_NumberCheck(item)) {
+  if (!value) {
+    PyErr_Format(PyExc_TypeError, "cannot delete items from %s(@%" PY_FORMAT_SIZE_T "d,'%s')", Py_TYPE(self)->tp_name, self->ndim, PyBlitzArray_TypenumAsString(self->type_num));
+    return -1;
+  }
 
-    if (self->ndim != 1) {
-      PyErr_Format(PyExc_TypeError, "expected sequence for accessing %s(@%" PY_FORMAT_SIZE_T "d,'%s'", Py_TYPE(self)->tp_name, self->ndim, PyBlitzArray_TypenumAsString(self->type_num));
-      return -1;
-    }
+  if (PyBob_NumberCheck(item) && self->ndim == 1) {
 
     // if you get to this point, the user has passed single number
     Py_ssize_t k = PyNumber_AsSsize_t(item, PyExc_IndexError);
@@ -140,31 +145,210 @@ static int PyBlitzArray_setitem(PyBlitzArrayObject* self, PyObject* item,
 
   }
 
-  if (PySequence_Check(item)) {
+  if (PySequence_Check(item) && !PyTuple_Check(item)) {
 
     if (self->ndim != PySequence_Fast_GET_SIZE(item)) {
       PyErr_Format(PyExc_TypeError, "expected sequence of size %" PY_FORMAT_SIZE_T "d for accessing %s(@%" PY_FORMAT_SIZE_T "d,'%s')", PySequence_Fast_GET_SIZE(item), Py_TYPE(self)->tp_name, self->ndim, PyBlitzArray_TypenumAsString(self->type_num));
       return -1;
     }
 
-    // if you get to this point, then the input tuple has the same size
+    // if you get to this point, then the input sequence has the same size
     PyBlitzArrayObject shape;
     PyBlitzArrayObject* shape_p = &shape;
-    if (!PyBlitzArray_IndexConverter(item, &shape_p)) return 0;
+    if (!PyBlitzArray_IndexConverter(item, &shape_p)) return -1;
     return PyBlitzArray_SetItem(self, shape.shape, value);
 
   }
 
-  PyErr_Format(PyExc_TypeError, "%s(@%" PY_FORMAT_SIZE_T "d,'%s') assignment requires a single integers (for 1D arrays) or sequences, for any rank size", Py_TYPE(self)->tp_name, self->ndim, PyBlitzArray_TypenumAsString(self->type_num));
-  return -1;
+  // integers, slices, ellipsis or tuples of those, assigned in bulk
+  return PyBlitzArray_SetSubscript(self, item, value);
+
+}
+
+/**
+ * Methods for the number protocol, evaluated as blitz++ expressions
+ */
+static PyObject* PyBlitzArray_add(PyObject* a, PyObject* b) {
+  return PyBlitzArray_Arithmetic(a, b, '+', 0);
+}
+
+static PyObject* PyBlitzArray_subtract(PyObject* a, PyObject* b) {
+  return PyBlitzArray_Arithmetic(a, b, '-', 0);
+}
+
+static PyObject* PyBlitzArray_multiply(PyObject* a, PyObject* b) {
+  return PyBlitzArray_Arithmetic(a, b, '*', 0);
+}
+
+static PyObject* PyBlitzArray_true_divide(PyObject* a, PyObject* b) {
+  return PyBlitzArray_Arithmetic(a, b, '/', 0);
 }
 
+static PyObject* PyBlitzArray_inplace_add(PyObject* a, PyObject* b) {
+  return PyBlitzArray_Arithmetic(a, b, '+', 1);
+}
+
+static PyObject* PyBlitzArray_inplace_subtract(PyObject* a, PyObject* b) {
+  return PyBlitzArray_Arithmetic(a, b, '-', 1);
+}
+
+static PyObject* PyBlitzArray_inplace_multiply(PyObject* a, PyObject* b) {
+  return PyBlitzArray_Arithmetic(a, b, '*', 1);
+}
+
+static PyObject* PyBlitzArray_inplace_true_divide(PyObject* a, PyObject* b) {
+  return PyBlitzArray_Arithmetic(a, b, '/', 1);
+}
+
+/**
+ * Only arrays with a single element have a truth value, as results of
+ * comparisons are arrays too
+ */
+static int PyBlitzArray_bool(PyBlitzArrayObject* self) {
+
+  if (PyBlitzArray_len(self) != 1) {
+    PyErr_Format(PyExc_ValueError, "the truth value of %s(@%" PY_FORMAT_SIZE_T "d,'%s') with %" PY_FORMAT_SIZE_T "d elements is ambiguous", Py_TYPE(self)->tp_name, self->ndim, PyBlitzArray_TypenumAsString(self->type_num), PyBlitzArray_len(self));
+    return -1;
+  }
+
+  Py_ssize_t pos[BOB_BLITZ_MAXDIMS] = {0};
+  PyObject* item = PyBlitzArray_GetItem(self, pos);
+  if (!item) return -1;
+  int retval = PyObject_IsTrue(item);
+  Py_DECREF(item);
+  return retval;
+
+}
+
+static PyNumberMethods PyBlitzArray_as_number;
+
 static PyMappingMethods PyBlitzArray_mapping = {
     (lenfunc)PyBlitzArray_len,
     (binaryfunc)PyBlitzArray_getitem,
     (objobjargproc)PyBlitzArray_setitem,
 };
 
+/**
+ * Methods for the buffer protocol (PEP 3118)
+ */
+static const char* PyBlitzArray_BufferFormat(int type_num) {
+
+  switch (type_num) {
+    case NPY_BOOL:
+      return "?";
+    case NPY_INT8:
+      return "b";
+    case NPY_INT16:
+      return "h";
+    case NPY_INT32:
+      return NPY_BITSOF_INT == 32 ? "i" : "l";
+    case NPY_INT64:
+      return NPY_BITSOF_LONG == 64 ? "l" : "q";
+    case NPY_UINT8:
+      return "B";
+    case NPY_UINT16:
+      return "H";
+    case NPY_UINT32:
+      return NPY_BITSOF_INT == 32 ? "I" : "L";
+    case NPY_UINT64:
+      return NPY_BITSOF_LONG == 64 ? "L" : "Q";
+    case NPY_FLOAT32:
+      return "f";
+    case NPY_FLOAT64:
+      return "d";
+#ifdef NPY_FLOAT128
+    case NPY_FLOAT128:
+      return "g";
+#endif
+    case NPY_COMPLEX64:
+      return "Zf";
+    case NPY_COMPLEX128:
+      return "Zd";
+#ifdef NPY_COMPLEX256
+    case NPY_COMPLEX256:
+      return "Zg";
+#endif
+    default:
+      return 0;
+  }
+
+}
+
+/* Tells if the array is contiguous in C (`order='C'`) or Fortran order */
+static int PyBlitzArray_IsContiguous(PyBlitzArrayObject* self, char order,
+    Py_ssize_t itemsize) {
+
+  Py_ssize_t expected = itemsize;
+
+  if (order == 'C') {
+    for (Py_ssize_t i=self->ndim-1; i>=0; --i) {
+      if (self->shape[i] != 1 && self->stride[i] != expected) return 0;
+      expected *= self->shape[i];
+    }
+  }
+  else {
+    for (Py_ssize_t i=0; i<self->ndim; ++i) {
+      if (self->shape[i] != 1 && self->stride[i] != expected) return 0;
+      expected *= self->shape[i];
+    }
+  }
+
+  return 1;
+}
+
+static int PyBlitzArray_getbuffer(PyBlitzArrayObject* self, Py_buffer* view,
+    int flags) {
+
+  view->obj = 0;
+
+  if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE && !self->writeable) {
+    PyErr_Format(PyExc_BufferError, "cannot export a writeable buffer from read-only %s(@%" PY_FORMAT_SIZE_T "d,'%s')", Py_TYPE(self)->tp_name, self->ndim, PyBlitzArray_TypenumAsString(self->type_num));
+    return -1;
+  }
+
+  const char* format = PyBlitzArray_BufferFormat(self->type_num);
+  if (!format) {
+    PyErr_Format(PyExc_BufferError, "cannot export a buffer from %s(@%" PY_FORMAT_SIZE_T "d,T) with T having an unsupported numpy type number of %d", Py_TYPE(self)->tp_name, self->ndim, self->type_num);
+    return -1;
+  }
+
+  Py_ssize_t itemsize = PyBlitzArray_TypenumSize(self->type_num);
+  int c_contiguous = PyBlitzArray_IsContiguous(self, 'C', itemsize);
+  int f_contiguous = PyBlitzArray_IsContiguous(self, 'F', itemsize);
+
+  if (((flags & PyBUF_C_CONTIGUOUS) == PyBUF_C_CONTIGUOUS && !c_contiguous) ||
+      ((flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS && !f_contiguous) ||
+      ((flags & PyBUF_ANY_CONTIGUOUS) == PyBUF_ANY_CONTIGUOUS && !(c_contiguous || f_contiguous)) ||
+      ((flags & PyBUF_STRIDES) != PyBUF_STRIDES && !c_contiguous)) {
+    PyErr_Format(PyExc_BufferError, "%s(@%" PY_FORMAT_SIZE_T "d,'%s') does not have the memory layout required by the buffer consumer", Py_TYPE(self)->tp_name, self->ndim, PyBlitzArray_TypenumAsString(self->type_num));
+    return -1;
+  }
+
+  view->buf = self->data;
+  view->len = PyBlitzArray_len(self) * itemsize;
+  view->itemsize = itemsize;
+  view->readonly = !self->writeable;
+  view->ndim = self->ndim;
+  view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>(format) : 0;
+  view->shape = (flags & PyBUF_ND) ? self->shape : 0;
+  view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? self->stride : 0;
+  view->suboffsets = 0;
+  view->internal = 0;
+
+  // the view keeps a reference to this object, so the memory stays alive
+  view->obj = reinterpret_cast<PyObject*>(self);
+  Py_INCREF(view->obj);
+  ++self->exports;
+
+  return 0;
+}
+
+static void PyBlitzArray_releasebuffer(PyBlitzArrayObject* self, Py_buffer*) {
+  --self->exports;
+}
+
+static PyBufferProcs PyBlitzArray_as_buffer;
+
 
 auto as_ndarray = bob::extension::FunctionDoc(
   "as_ndarray",
@@ -198,26 +382,517 @@ static PyObject* PyBlitzArray_AsNumpyArrayPrivate(PyBlitzArrayObject* self,
 auto cast = bob::extension::FunctionDoc(
   "cast",
   "Casts an existing array into a (possibly) different data type, without changing its shape",
-  "If the data type matches the current array's data type, then a new view to the same array is returned. "
-  "Otherwise, a new array is allocated and returned.",
+  "If the data type matches the current array's data type (and no ``scale`` or ``offset`` is given), then a new view to the same array is returned. "
+  "Otherwise, a new array is allocated and returned. "
+  "If ``out`` is given, the converted elements are written into it instead, without allocating any memory, and ``out`` is returned. "
+  "Values are converted as in :py:meth:`numpy.ndarray.astype`, without going through numpy. "
+  "Large arrays are converted without holding the global interpreter lock, using the threads set with :py:func:`bob.blitz.set_num_threads`.\n\n"
+  "The ``mode`` sets how values are converted into integer types (it has no effect on other types):\n\n"
+  "* ``'truncate'``: towards zero; values out of the range of the type wrap around (or are undefined, for floating-point values), as in numpy\n"
+  "* ``'round_nearest'``: to the nearest integer, ties to even, as :py:func:`numpy.rint`\n"
+  "* ``'saturate'``: towards zero, clamped to the range of the type (NaNs become 0)\n"
+  "* ``'saturate_round'``: to the nearest integer, clamped to the range of the type\n\n"
+  "Values are multiplied by ``scale`` and then added ``offset`` before that, in the same pass. "
+  "This is done in single precision if both data types fit into it exactly (such as ``uint8``, ``uint16`` and ``float32``), in double precision otherwise.",
   true
 )
-.add_prototype("dtype", "array")
+.add_prototype("dtype, [out], [mode], [scale], [offset]", "array")
 .add_parameter("dtype", ":py:class:`numpy.dtype` or dtype convertible object", "The data type to convert this array into")
+.add_parameter("out", ":py:class:`bob.blitz.array`", "[Default: ``None``] A writeable array of the same shape as this one and of type ``dtype``, to write the converted elements into")
+.add_parameter("mode", "str", "[Default: ``'truncate'``] How values are converted into integer types: one of ``'truncate'``, ``'round_nearest'``, ``'saturate'`` or ``'saturate_round'``")
+.add_parameter("scale", "float", "[Default: ``1.``] The factor values are multiplied by, before conversion")
+.add_parameter("offset", "float", "[Default: ``0.``] The value added to values after scaling, before conversion")
 .add_return("array", ":py:class:`bob.blitz.array`", "This array converted to the given data type")
 ;
 static PyObject* PyBlitzArray_SelfCast(PyBlitzArrayObject* self, PyObject* args, PyObject* kwds) {
 
   /* Parses input arguments in a single shot */
-  static const char* const_kwlist[] = {"dtype", 0};
+  static const char* const_kwlist[] = {"dtype", "out", "mode", "scale", "offset", 0};
   static char** kwlist = const_cast<char**>(const_kwlist);
 
   int type_num = NPY_NOTYPE;
+  PyObject* out = Py_None;
+  int mode = PyBlitzArray_CAST_TRUNCATE;
+  double scale = 1.;
+  double offset = 0.;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&|OO&dd", kwlist,
+        &PyBlitzArray_TypenumConverter, &type_num, &out,
+        &PyBlitzArray_CastModeConverter, &mode, &scale, &offset)) return 0;
+
+  if (out == Py_None) return PyBlitzArray_CastMode(self, type_num, mode, scale, offset);
+
+  if (!PyBlitzArray_Check(out)) {
+    PyErr_Format(PyExc_TypeError, "output array should be a `%s', not `%s'", PyBlitzArray_Type.tp_name, Py_TYPE(out)->tp_name);
+    return 0;
+  }
+
+  PyBlitzArrayObject* o = reinterpret_cast<PyBlitzArrayObject*>(out);
+  if (!PyArray_EquivTypenums(o->type_num, type_num)) {
+    PyErr_Format(PyExc_TypeError, "cannot cast %s(@%" PY_FORMAT_SIZE_T "d,'%s') to `%s' into %s(@%" PY_FORMAT_SIZE_T "d,'%s'): the output array should be of the requested type", Py_TYPE(self)->tp_name, self->ndim, PyBlitzArray_TypenumAsString(self->type_num), PyBlitzArray_TypenumAsString(type_num), Py_TYPE(o)->tp_name, o->ndim, PyBlitzArray_TypenumAsString(o->type_num));
+    return 0;
+  }
+
+  if (PyBlitzArray_CastIntoMode(self, o, mode, scale, offset) != 0) return 0;
+
+  Py_INCREF(out);
+  return out;
+
+}
+
+auto take = bob::extension::FunctionDoc(
+  "take",
+  "Gathers the elements at many positions of this array at once",
+  "Positions are given as an array of integers, with one row per position and one column per dimension of this array. "
+  "For 1D arrays, a flat list of positions is also accepted. "
+  "Negative positions count from the end of each dimension.",
+  true
+)
+.add_prototype("indices", "array")
+.add_parameter("indices", "array_like (int, 2D)", "The positions to read, with shape ``(K, N)``, ``N`` being the number of dimensions of this array")
+.add_return("array", ":py:class:`bob.blitz.array`", "A new 1D array with the ``K`` elements, of the same type as this array")
+;
+static PyObject* PyBlitzArray_take(PyBlitzArrayObject* self, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"indices", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* indices = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &indices)) return 0;
+
+  return PyBlitzArray_Take(self, indices);
+
+}
+
+auto put = bob::extension::FunctionDoc(
+  "put",
+  "Sets the elements at many positions of this array at once",
+  "Positions are given as in :py:meth:`take`. "
+  "Nothing is changed unless all positions are valid. "
+  "If a position is repeated, the last value given for it is kept.",
+  true
+)
+.add_prototype("indices, values")
+.add_parameter("indices", "array_like (int, 2D)", "The positions to set, with shape ``(K, N)``, ``N`` being the number of dimensions of this array")
+.add_parameter("values", "array_like (1D) or scalar", "The ``K`` values to set, or a single value to set at all positions")
+;
+static PyObject* PyBlitzArray_put(PyBlitzArrayObject* self, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"indices", "values", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* indices = 0;
+  PyObject* values = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO", kwlist, &indices, &values)) return 0;
+
+  if (PyBlitzArray_Put(self, indices, values) != 0) return 0;
+  Py_RETURN_NONE;
+
+}
+
+auto chunks = bob::extension::FunctionDoc(
+  "chunks",
+  "Iterates over blocks of consecutive rows of this array",
+  "Each block is a view on (at most) ``n`` consecutive entries along the first dimension of this array, sharing its memory. "
+  "The last block holds the remaining rows, if the first extent of this array is not a multiple of ``n``. "
+  "Iterating over the array itself yields views of single rows, without the first dimension (or scalars, for 1D arrays).",
+  true
+)
+.add_prototype("n", "iterator")
+.add_parameter("n", "int", "The number of rows per block")
+.add_return("iterator", "iterator", "An iterator over views of this array, with ``n`` rows each")
+;
+static PyObject* PyBlitzArray_chunks(PyBlitzArrayObject* self, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"n", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  Py_ssize_t n = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "n", kwlist, &n)) return 0;
+
+  return PyBlitzArray_Chunks(self, n);
+
+}
+
+auto sum = bob::extension::FunctionDoc(
+  "sum",
+  "Sums all elements of this array",
+  "Floating-point and complex elements are added pairwise, which keeps rounding errors small even for large arrays. "
+  "As in numpy, sums of integers (or booleans) are computed in 64 bits, wrapping around on overflow.",
+  true
+)
+.add_prototype("", "sum")
+.add_return("sum", "scalar", "The sum of all elements, of type ``int64`` (``uint64``) for signed (unsigned) integers and booleans and of the type of this array otherwise")
+;
+static PyObject* PyBlitzArray_sum(PyBlitzArrayObject* self) {
+  return PyBlitzArray_Reduce(self, "sum");
+}
+
+auto min = bob::extension::FunctionDoc(
+  "min",
+  "The smallest element of this array",
+  "If any element is NaN, so is the result. "
+  "Complex arrays, whose elements are not ordered, raise a :py:class:`TypeError`, and arrays without elements a :py:class:`ValueError`.",
+  true
+)
+.add_prototype("", "min")
+.add_return("min", "scalar", "The smallest element, of the type of this array")
+;
+static PyObject* PyBlitzArray_min(PyBlitzArrayObject* self) {
+  return PyBlitzArray_Reduce(self, "min");
+}
+
+auto max = bob::extension::FunctionDoc(
+  "max",
+  "The largest element of this array",
+  "If any element is NaN, so is the result. "
+  "Complex arrays, whose elements are not ordered, raise a :py:class:`TypeError`, and arrays without elements a :py:class:`ValueError`.",
+  true
+)
+.add_prototype("", "max")
+.add_return("max", "scalar", "The largest element, of the type of this array")
+;
+static PyObject* PyBlitzArray_max(PyBlitzArrayObject* self) {
+  return PyBlitzArray_Reduce(self, "max");
+}
+
+auto mean = bob::extension::FunctionDoc(
+  "mean",
+  "The average of all elements of this array",
+  "The elements are summed as in :py:meth:`sum`, but in double precision for integers (and booleans).",
+  true
+)
+.add_prototype("", "mean")
+.add_return("mean", "scalar", "The average, of type ``float64`` for integers and booleans and of the type of this array otherwise")
+;
+static PyObject* PyBlitzArray_mean(PyBlitzArrayObject* self) {
+  return PyBlitzArray_Reduce(self, "mean");
+}
+
+auto norm = bob::extension::FunctionDoc(
+  "norm",
+  "The Euclidean (Frobenius) norm of this array",
+  "This is the square root of the sum of the squared magnitudes of all elements, as :py:func:`numpy.linalg.norm` computes for flattened arrays.",
+  true
+)
+.add_prototype("", "norm")
+.add_return("norm", "scalar", "The norm, of type ``float64`` for integers and booleans and of the (real) type of this array otherwise")
+;
+static PyObject* PyBlitzArray_norm(PyBlitzArrayObject* self) {
+  return PyBlitzArray_Reduce(self, "norm");
+}
+
+auto dot = bob::extension::FunctionDoc(
+  "dot",
+  "The dot product of this array with another one of the same shape",
+  "Elements at the same positions are multiplied, without conjugation, and all products are summed as in :py:meth:`sum`. "
+  "For 1D arrays, this is the same as :py:func:`numpy.dot`. "
+  "Arrays of different types are first converted to their common type.",
+  true
+)
+.add_prototype("other", "dot")
+.add_parameter("other", "array_like", "The other array, with the same shape as this one")
+.add_return("dot", "scalar", "The dot product, of the common type of both arrays")
+;
+static PyObject* PyBlitzArray_dot(PyBlitzArrayObject* self, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"other", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyBlitzArrayObject* other = 0;
 
   if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&", kwlist,
-        &PyBlitzArray_TypenumConverter, &type_num)) return 0;
+        &PyBlitzArray_Converter, &other)) return 0;
+  auto other_ = make_safe(other);
+
+  return PyBlitzArray_Dot(self, other);
+
+}
+
+/**
+ * Converts file system paths (str or bytes) into a bytes object
+ */
+static int PyBlitzArray_PathConverter(PyObject* o, PyObject** path) {
+#if PY_VERSION_HEX >= 0x03000000
+  return PyUnicode_FSConverter(o, path);
+#else
+  if (!PyString_Check(o)) {
+    PyErr_Format(PyExc_TypeError, "file paths should be strings, not `%s'", Py_TYPE(o)->tp_name);
+    return 0;
+  }
+  Py_INCREF(o);
+  *path = o;
+  return 1;
+#endif
+}
+
+/**
+ * Converts the name of an access pattern into a madvise() advice
+ */
+static int PyBlitzArray_AdviceConverter(PyObject* o, int* advice) {
+
+  if (o == Py_None) {
+    *advice = -1;
+    return 1;
+  }
+
+  const char* name = 0;
+  if (!PyArg_Parse(o, "s", &name)) return 0;
+
+  if (strcmp(name, "normal") == 0) *advice = MADV_NORMAL;
+  else if (strcmp(name, "sequential") == 0) *advice = MADV_SEQUENTIAL;
+  else if (strcmp(name, "random") == 0) *advice = MADV_RANDOM;
+  else if (strcmp(name, "willneed") == 0) *advice = MADV_WILLNEED;
+  else {
+    PyErr_Format(PyExc_ValueError, "access pattern should be one of `normal', `sequential', `random' or `willneed', not `%s'", name);
+    return 0;
+  }
+
+  return 1;
+
+}
+
+auto from_file = bob::extension::FunctionDoc(
+  "from_file",
+  "Creates an array backed by the contents of a file, without reading it",
+  "The file is mapped into memory, so that pages are only read from disk when they are first accessed. "
+  "The data is expected to be stored in C (row-major) order, with the machine's native byte order. "
+  "The array keeps the mapping alive, which is released when the array (and all views on it) are deleted.\n\n"
+  "The following modes are available:\n\n"
+  "* ``'r'``: read-only\n"
+  "* ``'r+'``: read-write, changes are written back to the file\n"
+  "* ``'c'``: copy-on-write, changes stay in memory and never reach the file",
+  true
+)
+.add_prototype("path, dtype, shape, [offset], [mode], [advice]", "array")
+.add_parameter("path", "str", "The path to the file to map")
+.add_parameter("dtype", ":py:class:`numpy.dtype` or ``dtype`` convertible object", "The data type of the elements in the file")
+.add_parameter("shape", "iterable", "The shape of the array")
+.add_parameter("offset", "int", "[Default: ``0``] Where the data starts in the file, in bytes; must be a multiple of the element size")
+.add_parameter("mode", "str", "[Default: ``'r'``] How to access the file, see above")
+.add_parameter("advice", "str", "[Default: ``None``] A hint on the expected access pattern passed to the operating system: one of ``'normal'``, ``'sequential'``, ``'random'`` or ``'willneed'``")
+.add_return("array", ":py:class:`bob.blitz.array`", "An array over the file contents")
+;
+static PyObject* PyBlitzArray_from_file(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"path", "dtype", "shape", "offset", "mode", "advice", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* path = 0;
+  int type_num = NPY_NOTYPE;
+  PyBlitzArrayObject shape;
+  PyBlitzArrayObject* shape_p = &shape;
+  Py_ssize_t offset = 0;
+  const char* mode = "r";
+  int advice = -1;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O&O&|nsO&", kwlist,
+        &PyBlitzArray_PathConverter, &path,
+        &PyBlitzArray_TypenumConverter, &type_num,
+        &PyBlitzArray_IndexConverter, &shape_p,
+        &offset, &mode,
+        &PyBlitzArray_AdviceConverter, &advice)) {
+    Py_XDECREF(path);
+    return 0;
+  }
+
+  PyObject* retval = PyBlitzArray_FromFile(PyBytes_AsString(path), type_num,
+      shape.ndim, shape.shape, offset, mode, advice);
+  Py_DECREF(path);
+  return retval;
+
+}
+
+auto from_npy = bob::extension::FunctionDoc(
+  "from_npy",
+  "Creates an array backed by the contents of a ``.npy`` file, without reading it",
+  "The data type, shape and storage order are read from the file header, and the data itself is mapped into memory as for :py:meth:`from_file`. "
+  "Data stored in Fortran order is supported; data in non-native byte order is not.",
+  true
+)
+.add_prototype("path, [mode], [advice]", "array")
+.add_parameter("path", "str", "The path to the ``.npy`` file to map")
+.add_parameter("mode", "str", "[Default: ``'r'``] How to access the file, see :py:meth:`from_file`")
+.add_parameter("advice", "str", "[Default: ``None``] A hint on the expected access pattern, see :py:meth:`from_file`")
+.add_return("array", ":py:class:`bob.blitz.array`", "An array over the file contents")
+;
+static PyObject* PyBlitzArray_from_npy(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"path", "mode", "advice", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* path = 0;
+  const char* mode = "r";
+  int advice = -1;
 
-  return PyBlitzArray_Cast(self, type_num);
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&|sO&", kwlist,
+        &PyBlitzArray_PathConverter, &path, &mode,
+        &PyBlitzArray_AdviceConverter, &advice)) {
+    Py_XDECREF(path);
+    return 0;
+  }
+
+  PyObject* retval = PyBlitzArray_FromNpyFile(PyBytes_AsString(path), mode, advice);
+  Py_DECREF(path);
+  return retval;
+
+}
+
+auto __reduce_ex__ = bob::extension::FunctionDoc(
+  "__reduce_ex__",
+  "Support for :py:mod:`pickle`",
+  "With pickle protocol 5 or above, the array memory is handed over as a :py:class:`pickle.PickleBuffer`, so that it can be transferred out-of-band without copies (e.g. through :py:mod:`multiprocessing`). "
+  "Arrays that are not contiguous are copied first. "
+  "With older protocols, the contents are serialized as a bytes object.",
+  true
+)
+.add_prototype("protocol", "reduced")
+.add_parameter("protocol", "int", "The pickle protocol in use")
+.add_return("reduced", "tuple", "The reconstruction function and its arguments")
+;
+static PyObject* PyBlitzArray_reduce_ex(PyBlitzArrayObject* self, PyObject* args) {
+
+  int protocol = 0;
+  if (!PyArg_ParseTuple(args, "i", &protocol)) return 0;
+
+  const Py_ssize_t itemsize = PyBlitzArray_TypenumSize(self->type_num);
+
+  // the memory to serialize, C or Fortran contiguous
+  const char* order = "C";
+  PyObject* source = reinterpret_cast<PyObject*>(self);
+  Py_INCREF(source);
+  if (!PyBlitzArray_IsContiguous(self, 'C', itemsize)) {
+    if (PyBlitzArray_IsContiguous(self, 'F', itemsize)) order = "F";
+    else {
+      PyObject* view = PyBlitzArray_AsNumpyArray(self, 0);
+      Py_DECREF(source);
+      if (!view) return 0;
+      source = PyArray_NewCopy(reinterpret_cast<PyArrayObject*>(view), NPY_CORDER);
+      Py_DECREF(view);
+      if (!source) return 0;
+    }
+  }
+  auto source_ = make_safe(source);
+
+  PyObject* data = 0;
+#if PY_VERSION_HEX >= 0x03080000
+  if (protocol >= 5) data = PyPickleBuffer_FromObject(source);
+  else
+#endif
+  {
+    Py_buffer view;
+    if (PyObject_GetBuffer(source, &view, PyBUF_ANY_CONTIGUOUS) != 0) return 0;
+    data = PyBytes_FromStringAndSize(reinterpret_cast<const char*>(view.buf), view.len);
+    PyBuffer_Release(&view);
+  }
+  if (!data) return 0;
+  auto data_ = make_safe(data);
+
+  PyObject* module = PyImport_ImportModule(BOB_BLITZ_FULL_NAME);
+  if (!module) return 0;
+  PyObject* reconstruct = PyObject_GetAttrString(module, "_reconstruct");
+  Py_DECREF(module);
+  if (!reconstruct) return 0;
+
+  return Py_BuildValue("N(ONNsO)", reconstruct, data,
+      PyArray_DescrFromType(self->type_num), PyBlitzArray_PySHAPE(self), order,
+      self->writeable ? Py_True : Py_False);
+
+}
+
+auto shared = bob::extension::FunctionDoc(
+  "shared",
+  "Creates a new array in shared memory",
+  "The returned array can be shared with other processes without copies: child processes created with :py:func:`os.fork` (e.g. by :py:mod:`multiprocessing`) see the same physical memory, while unrelated processes can use :py:meth:`attach`, either with the ``name`` of the segment or with its file descriptor, available through the :py:attr:`shared_memory.fd` attribute of this array's :py:attr:`base`.\n\n"
+  "Without a ``name``, an anonymous, sealed segment (a ``memfd``, on Linux) is created. "
+  "Otherwise, a POSIX shared memory segment with the given name is created, which must not exist yet. "
+  "It is removed from the system when this array (and all views on it) are deleted.",
+  true
+)
+.add_prototype("shape, dtype, [name]", "array")
+.add_parameter("shape", "iterable", "The shape of the array")
+.add_parameter("dtype", ":py:class:`numpy.dtype` or ``dtype`` convertible object", "The data type of the array")
+.add_parameter("name", "str", "[Default: ``None``] The name of the shared memory segment to create")
+.add_return("array", ":py:class:`bob.blitz.array`", "A new array in shared memory, with undefined contents")
+;
+static PyObject* PyBlitzArray_shared(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"shape", "dtype", "name", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyBlitzArrayObject shape;
+  PyBlitzArrayObject* shape_p = &shape;
+  int type_num = NPY_NOTYPE;
+  const char* name = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O&O&|z", kwlist,
+        &PyBlitzArray_IndexConverter, &shape_p,
+        &PyBlitzArray_TypenumConverter, &type_num,
+        &name)) return 0;
+
+  return PyBlitzArray_SharedNew(type_num, shape.ndim, shape.shape, name);
+
+}
+
+auto attach = bob::extension::FunctionDoc(
+  "attach",
+  "Attaches to an existing array in shared memory",
+  "See :py:meth:`shared` for details. "
+  "The shape and data type are not stored in the segment and must be given again.",
+  true
+)
+.add_prototype("source, shape, dtype, [writeable]", "array")
+.add_parameter("source", "str or int", "The name of the shared memory segment, or a file descriptor for it")
+.add_parameter("shape", "iterable", "The shape of the array")
+.add_parameter("dtype", ":py:class:`numpy.dtype` or ``dtype`` convertible object", "The data type of the array")
+.add_parameter("writeable", "bool", "[Default: ``True``] If the returned array may be written to")
+.add_return("array", ":py:class:`bob.blitz.array`", "An array over the shared memory segment")
+;
+static PyObject* PyBlitzArray_attach(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"source", "shape", "dtype", "writeable", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* source = 0;
+  PyBlitzArrayObject shape;
+  PyBlitzArrayObject* shape_p = &shape;
+  int type_num = NPY_NOTYPE;
+  PyObject* writeable = Py_True;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO&O&|O", kwlist,
+        &source,
+        &PyBlitzArray_IndexConverter, &shape_p,
+        &PyBlitzArray_TypenumConverter, &type_num,
+        &writeable)) return 0;
+
+  int c_writeable = PyObject_IsTrue(writeable);
+  if (c_writeable < 0) return 0;
+
+  if (PyBob_NumberCheck(source)) {
+    // out-of-range values are clipped, and then refused
+    Py_ssize_t fd = PyNumber_AsSsize_t(source, 0);
+    if (PyErr_Occurred()) return 0;
+    if (fd < 0 || fd > INT_MAX) {
+      PyErr_Format(PyExc_ValueError, "file descriptors should be between 0 and %d, not %" PY_FORMAT_SIZE_T "d", INT_MAX, fd);
+      return 0;
+    }
+    return PyBlitzArray_SharedAttach(0, static_cast<int>(fd), type_num, shape.ndim, shape.shape, c_writeable);
+  }
+
+  const char* name = 0;
+  if (!PyArg_Parse(source, "s", &name)) return 0;
+  return PyBlitzArray_SharedAttach(name, -1, type_num, shape.ndim, shape.shape, c_writeable);
 
 }
 
@@ -240,6 +915,90 @@ static PyMethodDef PyBlitzArray_methods[] = {
       METH_VARARGS|METH_KEYWORDS,
       cast.doc()
     },
+    {
+      take.name(),
+      (PyCFunction)PyBlitzArray_take,
+      METH_VARARGS|METH_KEYWORDS,
+      take.doc()
+    },
+    {
+      put.name(),
+      (PyCFunction)PyBlitzArray_put,
+      METH_VARARGS|METH_KEYWORDS,
+      put.doc()
+    },
+    {
+      chunks.name(),
+      (PyCFunction)PyBlitzArray_chunks,
+      METH_VARARGS|METH_KEYWORDS,
+      chunks.doc()
+    },
+    {
+      sum.name(),
+      (PyCFunction)PyBlitzArray_sum,
+      METH_NOARGS,
+      sum.doc()
+    },
+    {
+      min.name(),
+      (PyCFunction)PyBlitzArray_min,
+      METH_NOARGS,
+      min.doc()
+    },
+    {
+      max.name(),
+      (PyCFunction)PyBlitzArray_max,
+      METH_NOARGS,
+      max.doc()
+    },
+    {
+      mean.name(),
+      (PyCFunction)PyBlitzArray_mean,
+      METH_NOARGS,
+      mean.doc()
+    },
+    {
+      norm.name(),
+      (PyCFunction)PyBlitzArray_norm,
+      METH_NOARGS,
+      norm.doc()
+    },
+    {
+      dot.name(),
+      (PyCFunction)PyBlitzArray_dot,
+      METH_VARARGS|METH_KEYWORDS,
+      dot.doc()
+    },
+    {
+      from_file.name(),
+      (PyCFunction)PyBlitzArray_from_file,
+      METH_VARARGS|METH_KEYWORDS|METH_STATIC,
+      from_file.doc()
+    },
+    {
+      from_npy.name(),
+      (PyCFunction)PyBlitzArray_from_npy,
+      METH_VARARGS|METH_KEYWORDS|METH_STATIC,
+      from_npy.doc()
+    },
+    {
+      __reduce_ex__.name(),
+      (PyCFunction)PyBlitzArray_reduce_ex,
+      METH_VARARGS,
+      __reduce_ex__.doc()
+    },
+    {
+      shared.name(),
+      (PyCFunction)PyBlitzArray_shared,
+      METH_VARARGS|METH_KEYWORDS|METH_STATIC,
+      shared.doc()
+    },
+    {
+      attach.name(),
+      (PyCFunction)PyBlitzArray_attach,
+      METH_VARARGS|METH_KEYWORDS|METH_STATIC,
+      attach.doc()
+    },
     {0}  /* Sentinel */
 };
 
@@ -274,6 +1033,98 @@ auto base = bob::extension::VariableDoc(
   "If the memory of this array is borrowed from some other object, this is it"
 );
 
+auto __array_interface__ = bob::extension::VariableDoc(
+  "__array_interface__",
+  "dict",
+  "The numpy array interface (version 3) describing the memory of this array",
+  "This allows :py:mod:`numpy` to wrap this array without copying or calling any method on it."
+);
+
+/* Array interface (version 3) helpers */
+static char PyBlitzArray_ByteOrder(PyArray_Descr* dtype) {
+  if (dtype->byteorder != '=') return dtype->byteorder;
+#if NPY_BYTE_ORDER == NPY_LITTLE_ENDIAN
+  return '<';
+#else
+  return '>';
+#endif
+}
+
+static PyObject* PyBlitzArray_ArrayInterface(PyBlitzArrayObject* self, void*) {
+
+  PyArray_Descr* dtype = PyArray_DescrFromType(self->type_num); ///< new reference
+  if (!dtype) return 0;
+#if PY_VERSION_HEX >= 0x03000000
+  PyObject* typestr = PyUnicode_FromFormat("%c%c%d", PyBlitzArray_ByteOrder(dtype), dtype->kind, (int)PyBlitzArray_TypenumSize(self->type_num));
+#else
+  PyObject* typestr = PyString_FromFormat("%c%c%d", PyBlitzArray_ByteOrder(dtype), dtype->kind, (int)PyBlitzArray_TypenumSize(self->type_num));
+#endif
+  Py_DECREF(dtype);
+  if (!typestr) return 0;
+
+  // whoever reads the data pointer keeps this object, not the data, alive
+  self->viewed = 1;
+
+  return Py_BuildValue("{sNsNsNs(NO)si}",
+      "shape", PyBlitzArray_PySHAPE(self),
+      "strides", PyBlitzArray_PySTRIDE(self),
+      "typestr", typestr,
+      "data", PyLong_FromVoidPtr(self->data), self->writeable ? Py_False : Py_True,
+      "version", 3
+      );
+
+}
+
+auto __array_struct__ = bob::extension::VariableDoc(
+  "__array_struct__",
+  "PyCapsule",
+  "A capsule containing the numpy ``PyArrayInterface`` structure describing the memory of this array",
+  "This allows :py:mod:`numpy` to wrap this array without copying or calling any method on it."
+);
+
+static void PyBlitzArray_ArrayStructDelete(PyObject* capsule) {
+  PyObject* self = reinterpret_cast<PyObject*>(PyCapsule_GetContext(capsule));
+  delete reinterpret_cast<PyArrayInterface*>(PyCapsule_GetPointer(capsule, 0));
+  Py_XDECREF(self);
+}
+
+static PyObject* PyBlitzArray_ArrayStruct(PyBlitzArrayObject* self, void*) {
+
+  PyArray_Descr* dtype = PyArray_DescrFromType(self->type_num); ///< new reference
+  if (!dtype) return 0;
+
+  PyArrayInterface* inter = new PyArrayInterface;
+  inter->two = 2;
+  inter->nd = self->ndim;
+  inter->typekind = dtype->kind;
+  inter->itemsize = PyBlitzArray_TypenumSize(self->type_num);
+  inter->flags = NPY_ARRAY_ALIGNED | NPY_ARRAY_NOTSWAPPED;
+  if (self->writeable) inter->flags |= NPY_ARRAY_WRITEABLE;
+  if (PyBlitzArray_IsContiguous(self, 'C', inter->itemsize))
+    inter->flags |= NPY_ARRAY_C_CONTIGUOUS;
+  if (PyBlitzArray_IsContiguous(self, 'F', inter->itemsize))
+    inter->flags |= NPY_ARRAY_F_CONTIGUOUS;
+  inter->shape = reinterpret_cast<npy_intp*>(self->shape);
+  inter->strides = reinterpret_cast<npy_intp*>(self->stride);
+  inter->data = self->data;
+  inter->descr = 0;
+  Py_DECREF(dtype);
+
+  // numpy requires an unnamed capsule; it holds a reference to this object,
+  // which owns the shape and stride arrays pointed to by the interface
+  PyObject* retval = PyCapsule_New(inter, 0, PyBlitzArray_ArrayStructDelete);
+  if (!retval) {
+    delete inter;
+    return 0;
+  }
+  PyCapsule_SetContext(retval, self);
+  Py_INCREF(self);
+  self->viewed = 1;
+
+  return retval;
+
+}
+
 static PyGetSetDef PyBlitzArray_getseters[] = {
     {
       dtype.name(),
@@ -310,6 +1161,20 @@ static PyGetSetDef PyBlitzArray_getseters[] = {
       base.doc(),
       0,
     },
+    {
+      __array_interface__.name(),
+      (getter)PyBlitzArray_ArrayInterface,
+      0,
+      __array_interface__.doc(),
+      0,
+    },
+    {
+      __array_struct__.name(),
+      (getter)PyBlitzArray_ArrayStruct,
+      0,
+      __array_struct__.doc(),
+      0,
+    },
     {0}  /* Sentinel */
 };
 
@@ -409,6 +1274,36 @@ bool init_BlitzArray(PyObject* module)
   PyBlitzArray_Type.tp_str = reinterpret_cast<reprfunc>(PyBlitzArray_str);
   PyBlitzArray_Type.tp_repr = reinterpret_cast<reprfunc>(PyBlitzArray_repr);
   PyBlitzArray_Type.tp_as_mapping = &PyBlitzArray_mapping;
+  PyBlitzArray_Type.tp_iter = reinterpret_cast<getiterfunc>(PyBlitzArray_Iter);
+
+  // element-wise arithmetic and comparisons, which make arrays unhashable
+  PyBlitzArray_as_number.nb_add = PyBlitzArray_add;
+  PyBlitzArray_as_number.nb_subtract = PyBlitzArray_subtract;
+  PyBlitzArray_as_number.nb_multiply = PyBlitzArray_multiply;
+  PyBlitzArray_as_number.nb_true_divide = PyBlitzArray_true_divide;
+  PyBlitzArray_as_number.nb_inplace_add = PyBlitzArray_inplace_add;
+  PyBlitzArray_as_number.nb_inplace_subtract = PyBlitzArray_inplace_subtract;
+  PyBlitzArray_as_number.nb_inplace_multiply = PyBlitzArray_inplace_multiply;
+  PyBlitzArray_as_number.nb_inplace_true_divide = PyBlitzArray_inplace_true_divide;
+#if PY_VERSION_HEX >= 0x03000000
+  PyBlitzArray_as_number.nb_bool = reinterpret_cast<inquiry>(PyBlitzArray_bool);
+#else
+  PyBlitzArray_as_number.nb_nonzero = reinterpret_cast<inquiry>(PyBlitzArray_bool);
+#endif
+  PyBlitzArray_Type.tp_as_number = &PyBlitzArray_as_number;
+  PyBlitzArray_Type.tp_richcompare = PyBlitzArray_RichCompare;
+  PyBlitzArray_Type.tp_hash = PyObject_HashNotImplemented;
+#if PY_VERSION_HEX < 0x03000000
+  PyBlitzArray_Type.tp_flags |= Py_TPFLAGS_CHECKTYPES;
+#endif
+
+  // zero-copy export of the data through the buffer protocol
+  PyBlitzArray_as_buffer.bf_getbuffer = reinterpret_cast<getbufferproc>(PyBlitzArray_getbuffer);
+  PyBlitzArray_as_buffer.bf_releasebuffer = reinterpret_cast<releasebufferproc>(PyBlitzArray_releasebuffer);
+  PyBlitzArray_Type.tp_as_buffer = &PyBlitzArray_as_buffer;
+#if PY_VERSION_HEX < 0x03000000
+  PyBlitzArray_Type.tp_flags |= Py_TPFLAGS_HAVE_NEWBUFFER;
+#endif
 
 
   // check that everyting is fine
@@ -0,0 +1,266 @@
+/**
+ * @date Sat 17 Oct 2026
+ *
+ * @brief Microbenchmarks of the C/C++ API, called the way extensions using
+ * it do (through the imported API table)
+ */
+
+#include <bob.blitz/capi.h>
+#include <bob.blitz/cleanup.h>
+#include <bob.extension/documentation.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * One call of the benchmarked function: returns a new reference (released
+ * by the timing loop, so deallocation is timed as well) or NULL on failure
+ */
+typedef std::function<PyObject*()> bench_call;
+
+struct benchmark {
+  const char* name;
+  const char* description;
+  bool may_copy; ///< if the result may hold a copy of the input data
+};
+
+static const benchmark benchmarks[] = {
+  {"simple_new", "PyBlitzArray_SimpleNew() with the shape and type of the input", false},
+  {"from_numpy", "PyBlitzArray_FromNumpyArray() on the input", true},
+  {"converter", "PyBlitzArray_Converter() on the input", true},
+  {"behaved_converter", "PyBlitzArray_BehavedConverter() on the input", true},
+  {"as_numpy", "PyBlitzArray_AsNumpyArray() on a bob.blitz.array not based on an ndarray", true},
+  {"numpy_wrap", "PyBlitzArray_NUMPY_WRAP() of a new PyBlitzArray_SimpleNew()", false},
+  {"get_item", "PyBlitzArray_GetItem() of the first element", false},
+  {"cast", "PyBlitzArray_Cast() into the requested type", true},
+  {"make_safe", "make_safe() of a new reference to a bob.blitz.array", false},
+  {0, 0, false}
+};
+
+static const benchmark* find_benchmark(const char* name) {
+  for (const benchmark* b = benchmarks; b->name; ++b)
+    if (std::string(name) == b->name) return b;
+  return 0;
+}
+
+/**
+ * Bytes of the result of a call not shared with the input array
+ */
+static Py_ssize_t bytes_copied(PyObject* result, PyArrayObject* input) {
+
+  void* data = 0;
+  Py_ssize_t bytes = 0;
+  if (PyBlitzArray_Check(result)) {
+    PyBlitzArrayObject* bz = reinterpret_cast<PyBlitzArrayObject*>(result);
+    data = bz->data;
+    bytes = PyBlitzArray_TypenumSize(bz->type_num);
+    for (Py_ssize_t i=0; i<bz->ndim; ++i) bytes *= bz->shape[i];
+  }
+  else if (PyArray_Check(result)) {
+    PyArrayObject* nd = reinterpret_cast<PyArrayObject*>(result);
+    data = PyArray_DATA(nd);
+    bytes = PyArray_NBYTES(nd);
+  }
+  return data == PyArray_DATA(input) ? 0 : bytes;
+
+}
+
+/**
+ * Seconds taken by n calls
+ */
+static double run(const bench_call& call, Py_ssize_t n) {
+
+  auto start = std::chrono::steady_clock::now();
+  for (Py_ssize_t i=0; i<n; ++i) {
+    PyObject* r = call();
+    if (!r) return -1.;
+    Py_DECREF(r);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+
+}
+
+auto measure = bob::extension::FunctionDoc(
+  "measure",
+  "Times one of the C/C++ API microbenchmarks",
+  "The benchmarked function is called in a loop taking at least ``min_time`` seconds, ``repeat`` times, and the fastest loop is kept. "
+  "Results, including their deallocation, are released at each call. "
+  "Benchmarks are listed in ``benchmarks``, a dictionary of their descriptions."
+)
+.add_prototype("name, input, dtype, [min_time], [repeat]", "seconds, bytes")
+.add_parameter("name", "str", "The name of the benchmark")
+.add_parameter("input", ":py:class:`numpy.ndarray`", "A behaved array, the input of the benchmarked function")
+.add_parameter("dtype", ":py:class:`numpy.dtype`", "The type of the results of ``cast``")
+.add_parameter("min_time", "float", "[Default: ``0.02``] The minimum duration of a loop, in seconds")
+.add_parameter("repeat", "int", "[Default: ``3``] The number of loops")
+.add_return("seconds", "float", "The time taken by one call, in seconds")
+.add_return("bytes", "int", "The number of bytes copied by one call")
+;
+
+static PyObject* benchmark_measure(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"name", "input", "dtype", "min_time", "repeat", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  const char* name = 0;
+  PyArrayObject* input = 0;
+  int type_num = NPY_NOTYPE;
+  double min_time = 0.02;
+  int repeat = 3;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "sO!O&|di", kwlist, &name,
+        &PyArray_Type, &input, &PyBlitzArray_TypenumConverter, &type_num,
+        &min_time, &repeat)) return 0;
+
+  const benchmark* b = find_benchmark(name);
+  if (!b) {
+    PyErr_Format(PyExc_ValueError, "unknown benchmark `%s'", name);
+    return 0;
+  }
+
+  if (repeat < 1) {
+    PyErr_Format(PyExc_ValueError, "number of loops should be positive, not %d", repeat);
+    return 0;
+  }
+
+  // a bob.blitz.array sharing the input and another one owning a copy of it
+  PyObject* shared = PyBlitzArray_FromNumpyArray(input);
+  if (!shared) return 0;
+  auto shared_ = make_safe(shared);
+  PyBlitzArrayObject* bz = reinterpret_cast<PyBlitzArrayObject*>(shared);
+
+  PyObject* owned = PyBlitzArray_SimpleNew(bz->type_num, bz->ndim, bz->shape);
+  if (!owned) return 0;
+  auto owned_ = make_safe(owned);
+  PyBlitzArrayObject* own = reinterpret_cast<PyBlitzArrayObject*>(owned);
+  if (PyBlitzArray_CastInto(bz, own) < 0) return 0;
+
+  Py_ssize_t pos[BOB_BLITZ_MAXDIMS] = {0};
+
+  bench_call call;
+  const std::string which(b->name);
+  if (which == "simple_new") call = [bz]() {
+    return PyBlitzArray_SimpleNew(bz->type_num, bz->ndim, bz->shape);
+  };
+  else if (which == "from_numpy") call = [input]() {
+    return PyBlitzArray_FromNumpyArray(input);
+  };
+  else if (which == "converter") call = [input]() -> PyObject* {
+    PyBlitzArrayObject* o = 0;
+    if (!PyBlitzArray_Converter(reinterpret_cast<PyObject*>(input), &o)) return 0;
+    return reinterpret_cast<PyObject*>(o);
+  };
+  else if (which == "behaved_converter") call = [input]() -> PyObject* {
+    PyBlitzArrayObject* o = 0;
+    if (!PyBlitzArray_BehavedConverter(reinterpret_cast<PyObject*>(input), &o)) return 0;
+    return reinterpret_cast<PyObject*>(o);
+  };
+  else if (which == "as_numpy") call = [own]() {
+    return PyBlitzArray_AsNumpyArray(own, 0);
+  };
+  else if (which == "numpy_wrap") call = [bz]() {
+    return PyBlitzArray_NUMPY_WRAP(PyBlitzArray_SimpleNew(bz->type_num, bz->ndim, bz->shape));
+  };
+  else if (which == "get_item") call = [own, &pos]() {
+    return PyBlitzArray_GetItem(own, pos);
+  };
+  else if (which == "cast") call = [bz, type_num]() {
+    return PyBlitzArray_Cast(bz, type_num);
+  };
+  else call = [own]() -> PyObject* {
+    Py_INCREF(own);
+    { auto safe = make_safe(own); }
+    Py_RETURN_NONE;
+  };
+
+  // the bytes copied by the first call, which also warms up caches
+  PyObject* first = call();
+  if (!first) return 0;
+  Py_ssize_t bytes = b->may_copy ? bytes_copied(first, input) : 0;
+  Py_DECREF(first);
+
+  // calibrates the number of calls of each loop
+  Py_ssize_t n = 1;
+  double elapsed = 0.;
+  while (true) {
+    elapsed = run(call, n);
+    if (elapsed < 0.) return 0;
+    if (elapsed >= min_time) break;
+    double factor = elapsed > 0. ? 1.2 * min_time / elapsed : 10.;
+    n *= static_cast<Py_ssize_t>(std::max(2., std::min(10., factor)));
+  }
+
+  double best = elapsed;
+  for (int i=1; i<repeat; ++i) {
+    elapsed = run(call, n);
+    if (elapsed < 0.) return 0;
+    best = std::min(best, elapsed);
+  }
+
+  return Py_BuildValue("dn", best / n, bytes);
+
+}
+
+static PyMethodDef module_methods[] = {
+    {
+      measure.name(),
+      (PyCFunction)benchmark_measure,
+      METH_VARARGS|METH_KEYWORDS,
+      measure.doc()
+    },
+    {0}  /* Sentinel */
+};
+
+PyDoc_STRVAR(module_docstr, "Microbenchmarks of the C/C++ API of bob.blitz");
+
+#if PY_VERSION_HEX >= 0x03000000
+static PyModuleDef module_definition = {
+  PyModuleDef_HEAD_INIT,
+  BOB_EXT_MODULE_NAME,
+  module_docstr,
+  -1,
+  module_methods,
+  0, 0, 0, 0
+};
+#endif
+
+static PyObject* create_module (void) {
+
+# if PY_VERSION_HEX >= 0x03000000
+  PyObject* m = PyModule_Create(&module_definition);
+  auto m_ = make_xsafe(m);
+  const char* ret = "O";
+# else
+  PyObject* m = Py_InitModule3(BOB_EXT_MODULE_NAME, module_methods, module_docstr);
+  const char* ret = "N";
+# endif
+  if (!m) return 0;
+
+  /* imports the C/C++ API of bob.blitz, as any other extension would */
+  if (import_bob_blitz() < 0) return 0;
+
+  PyObject* names = PyDict_New();
+  if (!names) return 0;
+  auto names_ = make_safe(names);
+  for (const benchmark* b = benchmarks; b->name; ++b) {
+    PyObject* description = Py_BuildValue("s", b->description);
+    if (!description) return 0;
+    auto description_ = make_safe(description);
+    if (PyDict_SetItemString(names, b->name, description) < 0) return 0;
+  }
+  Py_INCREF(names);
+  if (PyModule_AddObject(m, "benchmarks", names) < 0) return 0;
+
+  return Py_BuildValue(ret, m);
+}
+
+PyMODINIT_FUNC BOB_EXT_ENTRY_NAME (void) {
+# if PY_VERSION_HEX >= 0x03000000
+  return
+# endif
+    create_module();
+}
@@ -0,0 +1,751 @@
+/**
+ * @date Fri 16 Oct 2026
+ *
+ * @brief Conversions of bob.blitz.array's between data types, without going
+ * through numpy
+ */
+
+#define BOB_BLITZ_MODULE
+#include <bob.blitz/capi.h>
+#include <bob.blitz/cppapi.h>
+#include <bob.blitz/cleanup.h>
+#include "internal.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <type_traits>
+
+/***************
+ * Conversions *
+ ***************/
+
+/**
+ * Values are scaled and offset with two roundings on all processors, so that
+ * results do not depend on whether fused multiply-adds are available
+ */
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC optimize("fp-contract=off")
+#endif
+
+/**
+ * Converts a single value of type S into type D, as numpy does: complex
+ * numbers lose their imaginary part when converted to real types and
+ * anything not equal to zero is true
+ */
+template <typename D, typename S>
+struct cast_value {
+  static D apply(S x) { return static_cast<D>(x); }
+};
+
+template <typename S>
+struct cast_value<bool, S> {
+  static bool apply(S x) { return x != S(0); }
+};
+
+template <typename D, typename S>
+struct cast_value<D, std::complex<S>> {
+  static D apply(std::complex<S> x) { return static_cast<D>(x.real()); }
+};
+
+template <typename S>
+struct cast_value<bool, std::complex<S>> {
+  static bool apply(std::complex<S> x) { return x.real() != S(0) || x.imag() != S(0); }
+};
+
+template <typename D, typename S>
+struct cast_value<std::complex<D>, S> {
+  static std::complex<D> apply(S x) { return std::complex<D>(static_cast<D>(x)); }
+};
+
+template <typename D, typename S>
+struct cast_value<std::complex<D>, std::complex<S>> {
+  static std::complex<D> apply(std::complex<S> x) {
+    return std::complex<D>(static_cast<D>(x.real()), static_cast<D>(x.imag()));
+  }
+};
+
+/**
+ * Integer types, the only ones rounding and saturation apply to (booleans
+ * are always true if not zero)
+ */
+template <typename T>
+struct cast_integer: std::integral_constant<bool,
+  std::is_integral<T>::value && !std::is_same<T,bool>::value> {};
+
+template <typename T> struct cast_real { typedef T type; };
+template <typename T> struct cast_real<std::complex<T>> { typedef T type; };
+
+template <typename T> inline T cast_real_part(T x) { return x; }
+template <typename T> inline T cast_real_part(std::complex<T> x) { return x.real(); }
+
+/**
+ * Types exactly represented in single precision
+ */
+template <typename T>
+struct cast_small: std::integral_constant<bool, std::is_same<T,float>::value ||
+  (std::is_integral<T>::value && sizeof(T) <= 2)> {};
+
+/**
+ * Type in which values are scaled and offset: single precision if both types
+ * fit into it, so that, e.g., 8-bit images are normalized at the width of
+ * float vectors, double (or long double) precision otherwise. Complex
+ * values stay complex.
+ */
+template <typename S, typename D>
+struct cast_work {
+  typedef typename cast_real<S>::type RS;
+  typedef typename cast_real<D>::type RD;
+  typedef typename std::conditional<
+    std::is_same<RS,long double>::value || std::is_same<RD,long double>::value,
+    long double,
+    typename std::conditional<cast_small<RS>::value && cast_small<RD>::value,
+      float, double>::type
+    >::type real;
+  typedef typename std::conditional<std::is_same<RS,S>::value, real,
+          std::complex<real>>::type type;
+};
+
+/**
+ * Converts an integer into another one, clamping it to the range of D
+ */
+template <typename D, typename S>
+inline D cast_saturate(S x) {
+  typedef std::numeric_limits<D> L;
+  if (x < S(0))
+    return static_cast<intmax_t>(x) < static_cast<intmax_t>(L::min()) ? L::min() : static_cast<D>(x);
+  return static_cast<uintmax_t>(x) > static_cast<uintmax_t>(L::max()) ? L::max() : static_cast<D>(x);
+}
+
+/**
+ * Converts a floating-point value into the integer type D, rounding it to the
+ * nearest integer (ties to even) and/or clamping it to the range of D
+ * (NaNs becoming 0), as requested by `mode'. Without saturation, values out
+ * of the range of D give undefined results, as in numpy.
+ */
+template <typename D, int mode, typename R>
+inline D cast_to_integer(R v) {
+  if (mode & PyBlitzArray_CAST_ROUND_NEAREST) v = std::rint(v);
+  if (!(mode & PyBlitzArray_CAST_SATURATE)) return static_cast<D>(v);
+  typedef std::numeric_limits<D> L;
+  // powers of two, exactly represented in R
+  const R hi = R(L::max() / 2 + 1) * R(2);
+  const R lo = L::is_signed ? -hi : R(0);
+  const bool over = v >= hi;
+  const bool under = v <= lo;
+  // only values within range are converted, the others are selected after
+  const D r = static_cast<D>((over || under || v != v) ? R(0) : v);
+  return over ? L::max() : under ? L::min() : r;
+}
+
+/**
+ * Converts a single value of type S into type D, with the given mode
+ */
+template <typename D, int mode, typename S, bool integral>
+inline D cast_mode(S x, std::false_type /*integer D*/,
+    std::integral_constant<bool,integral>) {
+  return cast_value<D,S>::apply(x);
+}
+
+template <typename D, int mode, typename S>
+inline D cast_mode(S x, std::true_type /*integer D*/,
+    std::true_type /*integral S*/) {
+  return (mode & PyBlitzArray_CAST_SATURATE) ? cast_saturate<D>(x) : static_cast<D>(x);
+}
+
+template <typename D, int mode, typename S>
+inline D cast_mode(S x, std::true_type /*integer D*/,
+    std::false_type /*integral S*/) {
+  return cast_to_integer<D,mode>(cast_real_part(x));
+}
+
+/**
+ * Converts a single value of type S into type D, with the given mode, after
+ * scaling and offsetting it if `affine' is set
+ */
+template <typename D, int mode, bool affine, typename S>
+struct cast_element {
+  typedef typename cast_work<S,D>::real W;
+  static D apply(S x, W, W) {
+    return cast_mode<D,mode>(x, cast_integer<D>(), std::is_integral<S>());
+  }
+};
+
+template <typename D, int mode, typename S>
+struct cast_element<D, mode, true, S> {
+  typedef typename cast_work<S,D>::real W;
+  typedef typename cast_work<S,D>::type A;
+  static D apply(S x, W scale, W offset) {
+    const A scaled = cast_value<A,S>::apply(x) * scale;
+    const A v = scaled + offset;
+    return cast_mode<D,mode>(v, cast_integer<D>(), std::false_type());
+  }
+};
+
+/***********
+ * Kernels *
+ ***********/
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define BOB_BLITZ_CAST_DISPATCH 1
+#  define BOB_BLITZ_CAST_INLINE inline __attribute__((always_inline))
+#else
+#  define BOB_BLITZ_CAST_INLINE inline
+#endif
+
+/**
+ * Converts `n' elements of `x', `sx' elements apart, into `y', `sy' elements
+ * apart. The loop over contiguous elements is the one the compiler
+ * vectorizes.
+ */
+template <typename S, typename D>
+static BOB_BLITZ_CAST_INLINE void cast_row(const S* x, Py_ssize_t sx, D* y,
+    Py_ssize_t sy, Py_ssize_t n) {
+  if (sx == 1 && sy == 1)
+    for (Py_ssize_t i=0; i<n; ++i) y[i] = cast_value<D,S>::apply(x[i]);
+  else
+    for (Py_ssize_t i=0; i<n; ++i) y[i*sy] = cast_value<D,S>::apply(x[i*sx]);
+}
+
+/**
+ * Contiguous complex numbers are converted as twice as many real numbers
+ */
+template <typename S, typename D>
+static BOB_BLITZ_CAST_INLINE void cast_row(const std::complex<S>* x,
+    Py_ssize_t sx, std::complex<D>* y, Py_ssize_t sy, Py_ssize_t n) {
+  if (sx == 1 && sy == 1) {
+    cast_row(reinterpret_cast<const S*>(x), 1, reinterpret_cast<D*>(y), 1, 2*n);
+    return;
+  }
+  for (Py_ssize_t i=0; i<n; ++i)
+    y[i*sy] = cast_value<std::complex<D>,std::complex<S>>::apply(x[i*sx]);
+}
+
+/**
+ * Converts `n' elements of `x' into `y', with a given mode, after scaling
+ * and offsetting them if `affine' is set
+ */
+template <typename S, typename D, int mode, bool affine>
+static BOB_BLITZ_CAST_INLINE void cast_row_mode(const S* x, Py_ssize_t sx,
+    D* y, Py_ssize_t sy, Py_ssize_t n, typename cast_work<S,D>::real scale,
+    typename cast_work<S,D>::real offset) {
+  typedef cast_element<D,mode,affine,S> E;
+  if (sx == 1 && sy == 1)
+    for (Py_ssize_t i=0; i<n; ++i) y[i] = E::apply(x[i], scale, offset);
+  else
+    for (Py_ssize_t i=0; i<n; ++i) y[i*sy] = E::apply(x[i*sx], scale, offset);
+}
+
+/**
+ * How values are converted: one of the PyBlitzArray_CAST_* modes, with the
+ * scale and offset applied to them before
+ */
+struct cast_params {
+  int mode;
+  double scale;
+  double offset;
+};
+
+/**
+ * Selects the loop for the conversion parameters. Modes are ignored for
+ * non-integer destinations, for which only the plain and the affine loops
+ * are compiled.
+ */
+template <typename S, typename D>
+static BOB_BLITZ_CAST_INLINE void cast_dispatch(const S* x, Py_ssize_t sx,
+    D* y, Py_ssize_t sy, Py_ssize_t n, const cast_params& p) {
+
+  typedef typename cast_work<S,D>::real W;
+  const int mode = cast_integer<D>::value ? p.mode : PyBlitzArray_CAST_TRUNCATE;
+  const bool affine = p.scale != 1. || p.offset != 0.;
+  const W scale = p.scale;
+  const W offset = p.offset;
+
+  switch (mode + (affine ? 4 : 0)) {
+    case 0: cast_row(x, sx, y, sy, n); break;
+    case 1: cast_row_mode<S,D,1,false>(x, sx, y, sy, n, scale, offset); break;
+    case 2: cast_row_mode<S,D,2,false>(x, sx, y, sy, n, scale, offset); break;
+    case 3: cast_row_mode<S,D,3,false>(x, sx, y, sy, n, scale, offset); break;
+    case 4: cast_row_mode<S,D,0,true>(x, sx, y, sy, n, scale, offset); break;
+    case 5: cast_row_mode<S,D,1,true>(x, sx, y, sy, n, scale, offset); break;
+    case 6: cast_row_mode<S,D,2,true>(x, sx, y, sy, n, scale, offset); break;
+    case 7: cast_row_mode<S,D,3,true>(x, sx, y, sy, n, scale, offset); break;
+    default: break;
+  }
+
+}
+
+/**
+ * A conversion of `n' elements of a given type at `x' into another type at
+ * `y', with strides in number of elements
+ */
+typedef void (*cast_kernel)(const char* x, Py_ssize_t sx, char* y,
+    Py_ssize_t sy, Py_ssize_t n, const cast_params& p);
+
+/**
+ * Instantiates the kernel converting from S to D as a function compiled for
+ * one instruction set, into which the generic code above is inlined
+ */
+#define BOB_BLITZ_CAST_KERNEL(isa, attributes) \
+  template <typename S, typename D> struct isa##_cast { \
+    attributes static void run(const char* x, Py_ssize_t sx, char* y, Py_ssize_t sy, Py_ssize_t n, const cast_params& p) { \
+      cast_dispatch(reinterpret_cast<const S*>(x), sx, reinterpret_cast<D*>(y), sy, n, p); \
+    } \
+  };
+
+BOB_BLITZ_CAST_KERNEL(generic, )
+#ifdef BOB_BLITZ_CAST_DISPATCH
+BOB_BLITZ_CAST_KERNEL(avx2, __attribute__((target("avx2"))))
+BOB_BLITZ_CAST_KERNEL(avx512, __attribute__((target("avx512f,avx512bw"))))
+#endif
+
+/**
+ * Returns the kernel converting from S into the type `dst', or 0 if `dst' is
+ * not supported
+ */
+template <template <typename, typename> class K, typename S>
+static cast_kernel cast_to(int dst) {
+
+  switch (dst) {
+
+    case NPY_BOOL:
+      return &K<S,bool>::run;
+
+    case NPY_INT8:
+      return &K<S,int8_t>::run;
+
+    case NPY_INT16:
+      return &K<S,int16_t>::run;
+
+    case NPY_INT32:
+      return &K<S,int32_t>::run;
+
+    case NPY_INT64:
+      return &K<S,int64_t>::run;
+
+    case NPY_UINT8:
+      return &K<S,uint8_t>::run;
+
+    case NPY_UINT16:
+      return &K<S,uint16_t>::run;
+
+    case NPY_UINT32:
+      return &K<S,uint32_t>::run;
+
+    case NPY_UINT64:
+      return &K<S,uint64_t>::run;
+
+    case NPY_FLOAT32:
+      return &K<S,float>::run;
+
+    case NPY_FLOAT64:
+      return &K<S,double>::run;
+
+#ifdef NPY_FLOAT128
+    case NPY_FLOAT128:
+      return &K<S,long double>::run;
+
+#endif
+
+    case NPY_COMPLEX64:
+      return &K<S,std::complex<float>>::run;
+
+    case NPY_COMPLEX128:
+      return &K<S,std::complex<double>>::run;
+
+#ifdef NPY_COMPLEX256
+    case NPY_COMPLEX256:
+      return &K<S,std::complex<long double>>::run;
+
+#endif
+
+    default:
+      return 0;
+
+  }
+
+}
+
+/**
+ * The matrix of kernels converting between all supported types, compiled for
+ * the baseline instruction set of the platform. Returns 0 if one of the
+ * types is not supported.
+ */
+static cast_kernel generic_kernel(int src, int dst) {
+
+  switch (src) {
+
+    case NPY_BOOL:
+      return cast_to<generic_cast,bool>(dst);
+
+    case NPY_INT8:
+      return cast_to<generic_cast,int8_t>(dst);
+
+    case NPY_INT16:
+      return cast_to<generic_cast,int16_t>(dst);
+
+    case NPY_INT32:
+      return cast_to<generic_cast,int32_t>(dst);
+
+    case NPY_INT64:
+      return cast_to<generic_cast,int64_t>(dst);
+
+    case NPY_UINT8:
+      return cast_to<generic_cast,uint8_t>(dst);
+
+    case NPY_UINT16:
+      return cast_to<generic_cast,uint16_t>(dst);
+
+    case NPY_UINT32:
+      return cast_to<generic_cast,uint32_t>(dst);
+
+    case NPY_UINT64:
+      return cast_to<generic_cast,uint64_t>(dst);
+
+    case NPY_FLOAT32:
+      return cast_to<generic_cast,float>(dst);
+
+    case NPY_FLOAT64:
+      return cast_to<generic_cast,double>(dst);
+
+#ifdef NPY_FLOAT128
+    case NPY_FLOAT128:
+      return cast_to<generic_cast,long double>(dst);
+
+#endif
+
+    case NPY_COMPLEX64:
+      return cast_to<generic_cast,std::complex<float>>(dst);
+
+    case NPY_COMPLEX128:
+      return cast_to<generic_cast,std::complex<double>>(dst);
+
+#ifdef NPY_COMPLEX256
+    case NPY_COMPLEX256:
+      return cast_to<generic_cast,std::complex<long double>>(dst);
+
+#endif
+
+    default:
+      return 0;
+
+  }
+
+}
+
+/**
+ * The conversions most used on images and signals, also compiled for wider
+ * vector instruction sets. Returns 0 for other pairs of types.
+ */
+template <template <typename, typename> class K>
+static cast_kernel common_kernel(int src, int dst) {
+
+  switch (src) {
+
+    case NPY_UINT8:
+      return dst == NPY_FLOAT32 ? &K<uint8_t,float>::run : 0;
+
+    case NPY_UINT16:
+      return dst == NPY_FLOAT32 ? &K<uint16_t,float>::run : 0;
+
+    case NPY_INT32:
+      return dst == NPY_FLOAT32 ? &K<int32_t,float>::run : 0;
+
+    case NPY_FLOAT32:
+      switch (dst) {
+        case NPY_UINT8: return &K<float,uint8_t>::run;
+        case NPY_UINT16: return &K<float,uint16_t>::run;
+        case NPY_INT32: return &K<float,int32_t>::run;
+        case NPY_FLOAT64: return &K<float,double>::run;
+        default: return 0;
+      }
+
+    case NPY_FLOAT64:
+      return dst == NPY_FLOAT32 ? &K<double,float>::run : 0;
+
+    case NPY_COMPLEX64:
+      return dst == NPY_COMPLEX128 ? &K<std::complex<float>,std::complex<double>>::run : 0;
+
+    case NPY_COMPLEX128:
+      return dst == NPY_COMPLEX64 ? &K<std::complex<double>,std::complex<float>>::run : 0;
+
+    default:
+      return 0;
+
+  }
+
+}
+
+/**
+ * Instruction sets the common kernels are compiled for
+ */
+typedef enum {
+  CAST_GENERIC = 0,
+  CAST_AVX2,
+  CAST_AVX512
+} cast_isa;
+
+/**
+ * The best instruction set supported by the CPU (and operating system) we
+ * run on, detected when the module is imported
+ */
+static cast_isa current_isa = CAST_GENERIC;
+
+static cast_kernel kernel(int src, int dst) {
+
+  cast_kernel k = 0;
+  switch (current_isa) {
+#ifdef BOB_BLITZ_CAST_DISPATCH
+    case CAST_AVX512: k = common_kernel<avx512_cast>(src, dst); break;
+    case CAST_AVX2: k = common_kernel<avx2_cast>(src, dst); break;
+#endif
+    default: break;
+  }
+  return k ? k : generic_kernel(src, dst);
+
+}
+
+/**************
+ * Traversals *
+ **************/
+
+static bool cast_contiguous(PyBlitzArrayObject* a) {
+  Py_ssize_t expected = PyBlitzArray_TypenumSize(a->type_num);
+  for (Py_ssize_t i=a->ndim-1; i>=0; --i) {
+    if (a->shape[i] != 1 && a->stride[i] != expected) return false;
+    expected *= a->shape[i];
+  }
+  return true;
+}
+
+/**
+ * Computes the span of memory [lo, hi[ touched by an array, in bytes. Returns
+ * false if the array has no elements.
+ */
+static bool cast_span(PyBlitzArrayObject* a, const char** lo, const char** hi) {
+  *lo = *hi = reinterpret_cast<const char*>(a->data);
+  for (Py_ssize_t i=0; i<a->ndim; ++i) {
+    if (!a->shape[i]) return false;
+    if (a->stride[i] < 0) *lo += a->stride[i] * (a->shape[i]-1);
+    else *hi += a->stride[i] * (a->shape[i]-1);
+  }
+  *hi += PyBlitzArray_TypenumSize(a->type_num);
+  return true;
+}
+
+/**
+ * Converts all elements of `src' into `dst', of the same shape, row by row:
+ * runs along the last dimension or, if both arrays are C-contiguous, as many
+ * equal runs as there are tiles. Rows are split between tiles, processed
+ * without the GIL on the thread pool for large arrays.
+ */
+static void cast_rows(PyBlitzArrayObject* src, PyBlitzArrayObject* dst,
+    cast_kernel k, const cast_params& p) {
+
+  const Py_ssize_t ssize = PyBlitzArray_TypenumSize(src->type_num);
+  const Py_ssize_t dsize = PyBlitzArray_TypenumSize(dst->type_num);
+
+  Py_ssize_t size = 1;
+  for (Py_ssize_t i=0; i<src->ndim; ++i) size *= src->shape[i];
+  if (!size) return;
+
+  const Py_ssize_t tiles = PyBlitzThreads_Tiles(size, std::max(ssize, dsize));
+
+  Py_ssize_t length, rows, rows_per_tile;
+  const bool contiguous = cast_contiguous(src) && cast_contiguous(dst);
+  if (contiguous) {
+    length = (size + tiles - 1) / tiles;
+    rows = (size + length - 1) / length;
+    rows_per_tile = 1;
+  }
+  else {
+    length = src->shape[src->ndim-1];
+    rows = size / length;
+    rows_per_tile = (rows + tiles - 1) / tiles;
+  }
+
+  auto work = [&](Py_ssize_t t, int) {
+
+    const Py_ssize_t first = t * rows_per_tile;
+    const Py_ssize_t last = std::min(rows, first + rows_per_tile);
+    const char* x = reinterpret_cast<const char*>(src->data);
+    char* y = reinterpret_cast<char*>(dst->data);
+
+    if (contiguous) {
+      for (Py_ssize_t r=first; r<last; ++r)
+        k(x + r*length*ssize, 1, y + r*length*dsize, 1,
+            std::min(length, size - r*length), p);
+      return;
+    }
+
+    // odometer over all dimensions but the last one, from row `first'
+    const Py_ssize_t end = src->ndim - 1;
+    Py_ssize_t index[BOB_BLITZ_MAXDIMS];
+    for (Py_ssize_t i=end-1, r=first; i>=0; --i) {
+      index[i] = r % src->shape[i];
+      r /= src->shape[i];
+      x += index[i] * src->stride[i];
+      y += index[i] * dst->stride[i];
+    }
+
+    const Py_ssize_t sx = src->stride[end] / ssize;
+    const Py_ssize_t sy = dst->stride[end] / dsize;
+    for (Py_ssize_t r=first; r<last; ++r) {
+      k(x, sx, y, sy, length, p);
+      for (Py_ssize_t i=end-1; i>=0; --i) {
+        x += src->stride[i];
+        y += dst->stride[i];
+        if (++index[i] < src->shape[i]) break;
+        x -= index[i] * src->stride[i];
+        y -= index[i] * dst->stride[i];
+        index[i] = 0;
+      }
+    }
+
+  };
+
+  const Py_ssize_t ntiles = (rows + rows_per_tile - 1) / rows_per_tile;
+  if (tiles < 2) {
+    PyBlitzThreads_Run(ntiles, 1, work);
+    return;
+  }
+
+  const int workers = PyBlitzThreads_Get();
+  PyBlitzArray_PinData(src);
+  PyBlitzArray_PinData(dst);
+  Py_BEGIN_ALLOW_THREADS
+  PyBlitzThreads_Run(ntiles, workers, work);
+  Py_END_ALLOW_THREADS
+  PyBlitzArray_UnpinData(dst);
+  PyBlitzArray_UnpinData(src);
+
+}
+
+/*******
+ * API *
+ *******/
+
+static const char* cast_mode_name[] = {"truncate", "round_nearest", "saturate", "saturate_round"};
+
+int PyBlitzArray_CastIntoMode(PyBlitzArrayObject* src, PyBlitzArrayObject* dst,
+    int mode, double scale, double offset) {
+
+  if (!dst->writeable) {
+    PyErr_Format(PyExc_RuntimeError, "cannot cast into read-only %s(@%" PY_FORMAT_SIZE_T "d,%s)", Py_TYPE(dst)->tp_name, dst->ndim, PyBlitzArray_TypenumAsString(dst->type_num));
+    return -1;
+  }
+
+  if (mode < PyBlitzArray_CAST_TRUNCATE || mode > PyBlitzArray_CAST_SATURATE_ROUND) {
+    PyErr_Format(PyExc_ValueError, "unknown cast mode %d - valid modes are PyBlitzArray_CAST_TRUNCATE, PyBlitzArray_CAST_ROUND_NEAREST, PyBlitzArray_CAST_SATURATE and PyBlitzArray_CAST_SATURATE_ROUND", mode);
+    return -1;
+  }
+
+  bool same_shape = (src->ndim == dst->ndim);
+  for (Py_ssize_t i=0; same_shape && i<src->ndim; ++i)
+    same_shape = (src->shape[i] == dst->shape[i]);
+
+  if (!same_shape) {
+    PyErr_Format(PyExc_ValueError, "cannot cast %s(@%" PY_FORMAT_SIZE_T "d,'%s') into %s(@%" PY_FORMAT_SIZE_T "d,'%s'): both arrays should have the same shape", Py_TYPE(src)->tp_name, src->ndim, PyBlitzArray_TypenumAsString(src->type_num), Py_TYPE(dst)->tp_name, dst->ndim, PyBlitzArray_TypenumAsString(dst->type_num));
+    return -1;
+  }
+
+  cast_kernel k = kernel(src->type_num, dst->type_num);
+  if (!k) {
+    PyErr_Format(PyExc_NotImplementedError, "cannot cast %s(@%" PY_FORMAT_SIZE_T "d,'%s') into %s(@%" PY_FORMAT_SIZE_T "d,'%s'): unsupported numpy type numbers = %d, %d", Py_TYPE(src)->tp_name, src->ndim, PyBlitzArray_TypenumAsString(src->type_num), Py_TYPE(dst)->tp_name, dst->ndim, PyBlitzArray_TypenumAsString(dst->type_num), src->type_num, dst->type_num);
+    return -1;
+  }
+
+  const cast_params p = {mode, scale, offset};
+
+  size_t bytes = PyBlitzArray_TypenumSize(dst->type_num);
+  for (Py_ssize_t i=0; i<dst->ndim; ++i) bytes *= dst->shape[i];
+  PyBlitzStats_Cast(bytes);
+
+  // sources sharing memory with the destination are copied first, unless
+  // each element is read and written in the very same place
+  bool same = src->data == dst->data &&
+    PyBlitzArray_TypenumSize(src->type_num) == PyBlitzArray_TypenumSize(dst->type_num);
+  for (Py_ssize_t i=0; same && i<src->ndim; ++i)
+    same = src->stride[i] == dst->stride[i];
+  const char *slo, *shi, *dlo, *dhi;
+  if (!same && cast_span(src, &slo, &shi) && cast_span(dst, &dlo, &dhi) &&
+      slo < dhi && dlo < shi) {
+    PyObject* copy = PyBlitzArray_SimpleNew(src->type_num, src->ndim, src->shape);
+    if (!copy) return -1;
+    auto copy_ = make_safe(copy);
+    PyBlitzArrayObject* c = reinterpret_cast<PyBlitzArrayObject*>(copy);
+    const cast_params plain = {PyBlitzArray_CAST_TRUNCATE, 1., 0.};
+    cast_rows(src, c, kernel(c->type_num, c->type_num), plain);
+    cast_rows(c, dst, k, p);
+    return 0;
+  }
+
+  cast_rows(src, dst, k, p);
+  return 0;
+
+}
+
+int PyBlitzArray_CastInto(PyBlitzArrayObject* src, PyBlitzArrayObject* dst) {
+  return PyBlitzArray_CastIntoMode(src, dst, PyBlitzArray_CAST_TRUNCATE, 1., 0.);
+}
+
+PyObject* PyBlitzArray_CastMode(PyBlitzArrayObject* o, int type_num, int mode,
+    double scale, double offset) {
+
+  // nothing to convert: all modes leave values of the same type unchanged
+  if (PyArray_EquivTypenums(o->type_num, type_num) && scale == 1. && offset == 0.) {
+    Py_INCREF(o);
+    return reinterpret_cast<PyObject*>(o);
+  }
+
+  PyObject* retval = PyBlitzArray_SimpleNew(type_num, o->ndim, o->shape);
+  if (!retval) return 0;
+  auto retval_ = make_safe(retval);
+
+  if (PyBlitzArray_CastIntoMode(o, reinterpret_cast<PyBlitzArrayObject*>(retval), mode, scale, offset) < 0) return 0;
+
+  return Py_BuildValue("O", retval);
+
+}
+
+PyObject* PyBlitzArray_Cast(PyBlitzArrayObject* o, int type_num) {
+  return PyBlitzArray_CastMode(o, type_num, PyBlitzArray_CAST_TRUNCATE, 1., 0.);
+}
+
+int PyBlitzArray_CastModeConverter(PyObject* o, int* mode) {
+
+  const char* name = 0;
+  if (!PyArg_Parse(o, "s", &name)) return 0;
+
+  for (int i=0; i<(int)(sizeof(cast_mode_name)/sizeof(cast_mode_name[0])); ++i) {
+    if (std::strcmp(name, cast_mode_name[i]) == 0) {
+      *mode = i;
+      return 1;
+    }
+  }
+
+  PyErr_Format(PyExc_ValueError, "cast mode should be one of `truncate', `round_nearest', `saturate' or `saturate_round', not `%s'", name);
+  return 0;
+
+}
+
+/**
+ * Selects the kernels for the CPU we run on
+ */
+bool init_Casts() {
+
+#ifdef BOB_BLITZ_CAST_DISPATCH
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+    current_isa = CAST_AVX512;
+  else if (__builtin_cpu_supports("avx2"))
+    current_isa = CAST_AVX2;
+#endif
+
+  return true;
+
+}
@@ -0,0 +1,796 @@
+/**
+ * @date Fri 16 Oct 2026
+ *
+ * @brief Lazy element-wise expressions on bob.blitz.array's, evaluated in a
+ * single, blocked pass
+ */
+
+#define BOB_BLITZ_MODULE
+#include <bob.blitz/capi.h>
+#include <bob.blitz/cleanup.h>
+#include <bob.extension/documentation.h>
+#include "internal.h"
+
+#include <algorithm>
+#include <complex>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+/**
+ * A node of an expression: either a leaf, holding an array (or scalar) or an
+ * element-wise operation between two other nodes
+ */
+typedef struct {
+  PyObject_HEAD
+  char op; ///< one of `+', `-', `*' or `/', or 0 for leaves
+  PyObject* left; ///< left operand, or a numpy.ndarray for leaves
+  PyObject* right; ///< right operand, 0 for leaves
+  PyObject* scalar; ///< for leaves created from scalars, the scalar itself
+  int type_num; ///< data type of the result
+  Py_ssize_t ndim; ///< number of dimensions of the result (0 for scalars)
+  Py_ssize_t shape[BOB_BLITZ_MAXDIMS]; ///< shape of the result
+} PyBlitzExprObject;
+
+auto expr_doc = bob::extension::ClassDoc(
+  BOB_EXT_MODULE_PREFIX ".expr",
+  "An element-wise expression on arrays, evaluated lazily",
+  "Arithmetic (``+``, ``-``, ``*`` and ``/``) on objects of this class does not compute anything, but builds a larger expression, keeping references to the arrays involved. "
+  "The whole expression is only evaluated when :py:meth:`eval` is called or when it is assigned to (part of) an existing array, as in ``out[...] = e``. "
+  "It is then run in a single pass over blocks of elements which fit in the processor caches, in several threads for large arrays, without creating any intermediate array.\n\n"
+  "Data types are promoted and shapes broadcast as in numpy, but all operations are computed in the data type of the result. "
+  "Sub-expressions used more than once are computed only once per element."
+)
+.add_constructor(bob::extension::FunctionDoc(
+  "expr",
+  "Starts an expression",
+  0,
+  true
+  )
+  .add_prototype("x", "")
+  .add_parameter("x", ":py:class:`" BOB_EXT_MODULE_PREFIX ".array`, array_like or scalar", "The array or value the expression starts with; it is not copied")
+);
+
+static PyTypeObject PyBlitzExpr_Type = {
+    PyVarObject_HEAD_INIT(0, 0)
+    0
+};
+
+int PyBlitzExpr_Check(PyObject* o) {
+  return PyObject_TypeCheck(o, &PyBlitzExpr_Type);
+}
+
+static void PyBlitzExpr_Delete(PyBlitzExprObject* self) {
+  Py_XDECREF(self->left);
+  Py_XDECREF(self->right);
+  Py_XDECREF(self->scalar);
+  Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+/**
+ * Tells if we can evaluate expressions on a given data type
+ */
+static bool expr_supports(int type_num) {
+  switch (type_num) {
+    case NPY_BOOL:
+    case NPY_BYTE: case NPY_SHORT: case NPY_INT: case NPY_LONG: case NPY_LONGLONG:
+    case NPY_UBYTE: case NPY_USHORT: case NPY_UINT: case NPY_ULONG: case NPY_ULONGLONG:
+    case NPY_FLOAT: case NPY_DOUBLE: case NPY_LONGDOUBLE:
+    case NPY_CFLOAT: case NPY_CDOUBLE: case NPY_CLONGDOUBLE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * Creates a leaf node from an array or scalar. Returns 0 and sets a TypeError
+ * if the object cannot be used in expressions.
+ */
+static PyBlitzExprObject* expr_leaf(PyObject* o) {
+
+  PyObject* array = PyBlitzArray_Check(o) ?
+    PyBlitzArray_AsNumpyArray(reinterpret_cast<PyBlitzArrayObject*>(o), 0) :
+    PyArray_FromAny(o, 0, 0, BOB_BLITZ_MAXDIMS, 0, 0);
+  if (!array) return 0;
+  auto array_ = make_safe(array);
+
+  PyArrayObject* ao = reinterpret_cast<PyArrayObject*>(array);
+  if (!expr_supports(PyArray_DESCR(ao)->type_num)) {
+    PyErr_Format(PyExc_TypeError, "cannot use objects of type `%s' (converted to arrays of `%s') in %s", Py_TYPE(o)->tp_name, PyArray_DESCR(ao)->typeobj->tp_name, PyBlitzExpr_Type.tp_name);
+    return 0;
+  }
+
+  PyBlitzExprObject* retval = PyObject_New(PyBlitzExprObject, &PyBlitzExpr_Type);
+  if (!retval) return 0;
+  retval->op = 0;
+  retval->left = array;
+  Py_INCREF(array);
+  retval->right = 0;
+  retval->scalar = 0;
+  if (PyArray_IsAnyScalar(o)) {
+    retval->scalar = o;
+    Py_INCREF(o);
+  }
+  retval->type_num = PyArray_DESCR(ao)->type_num;
+  retval->ndim = PyArray_NDIM(ao);
+  for (Py_ssize_t i=0; i<retval->ndim; ++i) retval->shape[i] = PyArray_DIMS(ao)[i];
+  return retval;
+
+}
+
+/**
+ * Returns a new reference to a node for `o', which may already be one
+ */
+static PyBlitzExprObject* expr_node(PyObject* o) {
+  if (PyBlitzExpr_Check(o)) {
+    Py_INCREF(o);
+    return reinterpret_cast<PyBlitzExprObject*>(o);
+  }
+  return expr_leaf(o);
+}
+
+/**
+ * Asks numpy for the type of an operation between two nodes, so that scalars
+ * keep their (weak) type, as in numpy
+ */
+static int expr_result_type(PyBlitzExprObject* a, PyBlitzExprObject* b) {
+
+  static PyObject* result_type = 0;
+  if (!result_type) {
+    PyObject* numpy = PyImport_ImportModule("numpy");
+    if (!numpy) return NPY_NOTYPE;
+    result_type = PyObject_GetAttrString(numpy, "result_type");
+    Py_DECREF(numpy);
+    if (!result_type) return NPY_NOTYPE;
+  }
+
+  PyObject* args[2];
+  PyBlitzExprObject* nodes[2] = {a, b};
+  for (int i=0; i<2; ++i) {
+    if (nodes[i]->scalar) {
+      args[i] = nodes[i]->scalar;
+      Py_INCREF(args[i]);
+    }
+    else args[i] = reinterpret_cast<PyObject*>(PyArray_DescrFromType(nodes[i]->type_num));
+  }
+  auto a_ = make_safe(args[0]);
+  auto b_ = make_safe(args[1]);
+
+  PyObject* retval = PyObject_CallFunctionObjArgs(result_type, args[0], args[1], 0);
+  if (!retval) return NPY_NOTYPE;
+  auto retval_ = make_safe(retval);
+
+  if (!PyArray_DescrCheck(retval)) {
+    PyErr_SetString(PyExc_TypeError, "numpy.result_type() did not return a data type");
+    return NPY_NOTYPE;
+  }
+
+  return reinterpret_cast<PyArray_Descr*>(retval)->type_num;
+
+}
+
+/**
+ * Computes the shape `a' and `b' broadcast to, as in numpy, into `node'
+ */
+static int expr_broadcast(PyBlitzExprObject* a, PyBlitzExprObject* b,
+    PyBlitzExprObject* node) {
+
+  node->ndim = std::max(a->ndim, b->ndim);
+  for (Py_ssize_t i=0; i<node->ndim; ++i) {
+    const Py_ssize_t ea = i < node->ndim - a->ndim ? 1 : a->shape[i - (node->ndim - a->ndim)];
+    const Py_ssize_t eb = i < node->ndim - b->ndim ? 1 : b->shape[i - (node->ndim - b->ndim)];
+    if (ea == eb || eb == 1) node->shape[i] = ea;
+    else if (ea == 1) node->shape[i] = eb;
+    else {
+      PyErr_Format(PyExc_ValueError, "operands could not be broadcast together: extents %" PY_FORMAT_SIZE_T "d and %" PY_FORMAT_SIZE_T "d differ at position %" PY_FORMAT_SIZE_T "d", ea, eb, i);
+      return -1;
+    }
+  }
+
+  return 0;
+
+}
+
+/**
+ * Builds the node for `a op b', where either `a' or `b' is a node
+ */
+static PyObject* expr_binary(PyObject* a, PyObject* b, char op) {
+
+  PyBlitzExprObject* left = expr_node(a);
+  if (!left) return 0;
+  auto left_ = make_safe(left);
+  PyBlitzExprObject* right = expr_node(b);
+  if (!right) return 0;
+  auto right_ = make_safe(right);
+
+  int type_num = expr_result_type(left, right);
+  if (type_num == NPY_NOTYPE) return 0;
+
+  // like numpy, divisions of integers give floating-point results
+  if (op == '/' && (PyTypeNum_ISINTEGER(type_num) || PyTypeNum_ISBOOL(type_num)))
+    type_num = NPY_DOUBLE;
+
+  if (op == '-' && type_num == NPY_BOOL) {
+    PyErr_SetString(PyExc_TypeError, "cannot subtract boolean arrays, use `^' (exclusive or) instead");
+    return 0;
+  }
+
+  if (!expr_supports(type_num)) {
+    PyErr_Format(PyExc_TypeError, "cannot evaluate %s on data type `%s'", PyBlitzExpr_Type.tp_name, PyBlitzArray_TypenumAsString(type_num));
+    return 0;
+  }
+
+  PyBlitzExprObject* retval = PyObject_New(PyBlitzExprObject, &PyBlitzExpr_Type);
+  if (!retval) return 0;
+  retval->op = op;
+  retval->left = reinterpret_cast<PyObject*>(left);
+  Py_INCREF(left);
+  retval->right = reinterpret_cast<PyObject*>(right);
+  Py_INCREF(right);
+  retval->scalar = 0;
+  retval->type_num = type_num;
+  if (expr_broadcast(left, right, retval) != 0) {
+    Py_DECREF(retval);
+    return 0;
+  }
+  return reinterpret_cast<PyObject*>(retval);
+
+}
+
+/*****************
+ * Compiled Form *
+ *****************/
+
+/**
+ * Number of elements processed at once by each operation: small enough for
+ * all operands of an expression to stay in the processor caches
+ */
+static const Py_ssize_t EXPR_BLOCK = 1024;
+
+/**
+ * An input of the compiled expression, broadcast to the output shape
+ */
+struct expr_input {
+  const char* data;
+  Py_ssize_t stride[BOB_BLITZ_MAXDIMS];
+  bool contiguous; ///< C-contiguous, without broadcasting
+  bool constant; ///< the same value for all elements
+};
+
+/**
+ * An operation of the compiled expression. Operands >= 0 are inputs, while
+ * operands < 0 are results of previous operations (-1 being the first one).
+ */
+struct expr_instruction {
+  char op;
+  int left;
+  int right;
+};
+
+/**
+ * An expression compiled for a given output, data type and shape
+ */
+struct expr_program {
+  int type_num;
+  Py_ssize_t ndim;
+  Py_ssize_t shape[BOB_BLITZ_MAXDIMS];
+  Py_ssize_t size;
+  std::vector<expr_input> inputs;
+  std::vector<expr_instruction> code;
+  int result;
+  char* out;
+  Py_ssize_t out_stride[BOB_BLITZ_MAXDIMS];
+  bool out_contiguous;
+  std::vector<boost::shared_ptr<PyObject>> keep; ///< arrays used by inputs
+};
+
+/**
+ * Tells if `stride' describes a C-contiguous layout for the program shape
+ */
+static bool expr_is_contiguous(const expr_program& p, const Py_ssize_t* stride,
+    Py_ssize_t itemsize) {
+  for (Py_ssize_t i=p.ndim-1; i>=0; --i) {
+    if (p.shape[i] != 1 && stride[i] != itemsize) return false;
+    itemsize *= p.shape[i];
+  }
+  return true;
+}
+
+/**
+ * Computes the span of memory [lo, hi[ touched by an array, in bytes. Returns
+ * false if the array has no elements.
+ */
+static bool expr_span(const char* data, Py_ssize_t ndim, const Py_ssize_t* shape,
+    const Py_ssize_t* stride, Py_ssize_t itemsize, const char** lo,
+    const char** hi) {
+  *lo = *hi = data;
+  for (Py_ssize_t i=0; i<ndim; ++i) {
+    if (!shape[i]) return false;
+    if (stride[i] < 0) *lo += stride[i] * (shape[i]-1);
+    else *hi += stride[i] * (shape[i]-1);
+  }
+  *hi += itemsize;
+  return true;
+}
+
+/**
+ * Adds the input for a leaf node to the program, converting its array to the
+ * program data type if needed. Returns the input number or -1 on error.
+ */
+static int expr_compile_leaf(expr_program& p, PyBlitzExprObject* node) {
+
+  PyArray_Descr* descr = PyArray_DescrFromType(p.type_num);
+  PyObject* array = PyArray_FromAny(node->left, descr, 0, 0,
+      NPY_ARRAY_ALIGNED | NPY_ARRAY_NOTSWAPPED | NPY_ARRAY_FORCECAST, 0);
+  if (!array) return -1;
+  auto array_ = make_safe(array);
+  PyArrayObject* ao = reinterpret_cast<PyArrayObject*>(array);
+  const Py_ssize_t itemsize = PyArray_ITEMSIZE(ao);
+
+  // inputs partially overlapping the output are copied first
+  bool copy = false;
+  for (int i=0; i<PyArray_NDIM(ao); ++i)
+    if (PyArray_STRIDES(ao)[i] % itemsize) copy = true;
+  if (p.out) {
+    const Py_ssize_t offset = p.ndim - PyArray_NDIM(ao);
+    bool same = PyArray_BYTES(ao) == p.out && offset == 0;
+    for (Py_ssize_t i=0; same && i<p.ndim; ++i)
+      same = PyArray_DIMS(ao)[i] == p.shape[i] && PyArray_STRIDES(ao)[i] == p.out_stride[i];
+    const char *olo, *ohi, *ilo, *ihi;
+    if (!same &&
+        expr_span(p.out, p.ndim, p.shape, p.out_stride, itemsize, &olo, &ohi) &&
+        expr_span(PyArray_BYTES(ao), PyArray_NDIM(ao), PyArray_DIMS(ao), PyArray_STRIDES(ao), itemsize, &ilo, &ihi) &&
+        ilo < ohi && olo < ihi) copy = true;
+  }
+  if (copy) {
+    array = PyArray_NewCopy(ao, NPY_CORDER);
+    if (!array) return -1;
+    array_ = make_safe(array);
+    ao = reinterpret_cast<PyArrayObject*>(array);
+  }
+
+  expr_input input;
+  input.data = PyArray_BYTES(ao);
+  input.constant = true;
+  const Py_ssize_t offset = p.ndim - PyArray_NDIM(ao);
+  for (Py_ssize_t i=0; i<p.ndim; ++i) {
+    input.stride[i] = (i < offset || PyArray_DIMS(ao)[i-offset] == 1) ? 0 : PyArray_STRIDES(ao)[i-offset];
+    if (input.stride[i]) input.constant = false;
+  }
+  input.contiguous = expr_is_contiguous(p, input.stride, itemsize);
+
+  p.keep.push_back(array_);
+  p.inputs.push_back(input);
+  return p.inputs.size() - 1;
+
+}
+
+/**
+ * Adds a node (and all nodes it depends on) to the program, computing nodes
+ * reachable through several paths only once. Sets `operand' to the operand
+ * holding its result. Returns false with an exception set on error.
+ */
+static bool expr_compile(expr_program& p, PyBlitzExprObject* node,
+    std::map<PyBlitzExprObject*, int>& done, int& operand) {
+
+  auto it = done.find(node);
+  if (it != done.end()) {
+    operand = it->second;
+    return true;
+  }
+
+  if (!node->op) {
+    operand = expr_compile_leaf(p, node);
+    if (operand < 0) return false;
+  }
+
+  else {
+    expr_instruction instruction;
+    instruction.op = node->op;
+    if (!expr_compile(p, reinterpret_cast<PyBlitzExprObject*>(node->left), done, instruction.left)) return false;
+    if (!expr_compile(p, reinterpret_cast<PyBlitzExprObject*>(node->right), done, instruction.right)) return false;
+    p.code.push_back(instruction);
+    operand = -static_cast<int>(p.code.size());
+  }
+
+  done[node] = operand;
+  return true;
+
+}
+
+/**
+ * Reads `count' elements of an input, starting at the flat (C-order) position
+ * `start' in the output, into `buffer'
+ */
+template <typename T>
+static void expr_gather(const expr_program& p, const char* data,
+    const Py_ssize_t* stride, Py_ssize_t start, Py_ssize_t count, T* buffer) {
+
+  Py_ssize_t index[BOB_BLITZ_MAXDIMS];
+  for (Py_ssize_t i=p.ndim-1; i>=0; --i) {
+    index[i] = start % p.shape[i];
+    start /= p.shape[i];
+    data += index[i] * stride[i];
+  }
+
+  const Py_ssize_t last = p.ndim - 1;
+  for (Py_ssize_t k=0; k<count; ++k) {
+    buffer[k] = *reinterpret_cast<const T*>(data);
+    Py_ssize_t i = last;
+    data += stride[i];
+    while (++index[i] == p.shape[i] && i > 0) {
+      data -= stride[i] * p.shape[i];
+      index[i--] = 0;
+      data += stride[i];
+    }
+  }
+
+}
+
+/**
+ * Writes `count' elements from `buffer' into the output, starting at the flat
+ * (C-order) position `start'
+ */
+template <typename T>
+static void expr_scatter(const expr_program& p, Py_ssize_t start,
+    Py_ssize_t count, const T* buffer) {
+
+  char* data = p.out;
+  Py_ssize_t index[BOB_BLITZ_MAXDIMS];
+  for (Py_ssize_t i=p.ndim-1; i>=0; --i) {
+    index[i] = start % p.shape[i];
+    start /= p.shape[i];
+    data += index[i] * p.out_stride[i];
+  }
+
+  const Py_ssize_t last = p.ndim - 1;
+  for (Py_ssize_t k=0; k<count; ++k) {
+    *reinterpret_cast<T*>(data) = buffer[k];
+    Py_ssize_t i = last;
+    data += p.out_stride[i];
+    while (++index[i] == p.shape[i] && i > 0) {
+      data -= p.out_stride[i] * p.shape[i];
+      index[i--] = 0;
+      data += p.out_stride[i];
+    }
+  }
+
+}
+
+/**
+ * Products of booleans are their conjunction, as in numpy
+ */
+template <typename T> static inline T expr_multiply(T x, T y) { return x * y; }
+template <> inline bool expr_multiply(bool x, bool y) { return x && y; }
+
+/**
+ * Evaluates elements [begin, end[ of the program output, block by block.
+ * `scratch' holds one block per input and per operation.
+ */
+template <typename T>
+static void expr_run(const expr_program& p, Py_ssize_t begin, Py_ssize_t end,
+    T* scratch) {
+
+  const size_t n_inputs = p.inputs.size();
+  std::vector<const T*> operand(n_inputs + p.code.size());
+  const T** input = operand.data();
+  const T** result = operand.data() + n_inputs;
+
+  // constants are expanded only once
+  for (size_t i=0; i<n_inputs; ++i)
+    if (p.inputs[i].constant)
+      std::fill(scratch + i*EXPR_BLOCK, scratch + (i+1)*EXPR_BLOCK,
+          *reinterpret_cast<const T*>(p.inputs[i].data));
+
+  for (Py_ssize_t start=begin; start<end; start+=EXPR_BLOCK) {
+
+    const Py_ssize_t count = std::min(EXPR_BLOCK, end - start);
+
+    for (size_t i=0; i<n_inputs; ++i) {
+      const expr_input& in = p.inputs[i];
+      T* buffer = scratch + i*EXPR_BLOCK;
+      if (in.constant) input[i] = buffer;
+      else if (in.contiguous) input[i] = reinterpret_cast<const T*>(in.data) + start;
+      else {
+        expr_gather(p, in.data, in.stride, start, count, buffer);
+        input[i] = buffer;
+      }
+    }
+
+    for (size_t j=0; j<p.code.size(); ++j) {
+      const expr_instruction& c = p.code[j];
+      const T* x = c.left >= 0 ? input[c.left] : result[-c.left-1];
+      const T* y = c.right >= 0 ? input[c.right] : result[-c.right-1];
+      T* o = scratch + (n_inputs + j)*EXPR_BLOCK;
+      switch (c.op) {
+        case '+': for (Py_ssize_t k=0; k<count; ++k) o[k] = x[k] + y[k]; break;
+        case '-': for (Py_ssize_t k=0; k<count; ++k) o[k] = x[k] - y[k]; break;
+        case '*': for (Py_ssize_t k=0; k<count; ++k) o[k] = expr_multiply(x[k], y[k]); break;
+        case '/': for (Py_ssize_t k=0; k<count; ++k) o[k] = x[k] / y[k]; break;
+      }
+      result[j] = o;
+    }
+
+    const T* r = p.result >= 0 ? input[p.result] : result[-p.result-1];
+    if (p.out_contiguous)
+      std::copy(r, r + count, reinterpret_cast<T*>(p.out) + start);
+    else
+      expr_scatter(p, start, count, r);
+
+  }
+
+}
+
+/**
+ * Runs the program over all elements, without holding the GIL. Large outputs
+ * are split into tiles of whole blocks, evaluated by the thread pool.
+ */
+template <typename T>
+static int expr_execute(const expr_program& p) {
+
+  if (!p.size) return 0;
+
+  const Py_ssize_t blocks = (p.size + EXPR_BLOCK - 1) / EXPR_BLOCK;
+  const Py_ssize_t tiles = std::min(blocks, PyBlitzThreads_Tiles(p.size, sizeof(T)));
+  const Py_ssize_t per_tile = ((blocks + tiles - 1) / tiles) * EXPR_BLOCK;
+  const int workers = tiles > 1 ? PyBlitzThreads_Get() : 1;
+
+  // all memory is allocated before releasing the GIL
+  // (not a std::vector, which would pack booleans into bits)
+  const size_t per_worker = (p.inputs.size() + p.code.size()) * EXPR_BLOCK;
+  std::unique_ptr<T[]> scratch;
+  try {
+    scratch.reset(new T[per_worker * workers]);
+  }
+  catch (std::exception& e) {
+    PyErr_Format(PyExc_MemoryError, "cannot allocate memory to evaluate %s: %s", PyBlitzExpr_Type.tp_name, e.what());
+    return -1;
+  }
+
+  Py_BEGIN_ALLOW_THREADS
+  PyBlitzThreads_Run(tiles, workers, [&](Py_ssize_t t, int worker) {
+      const Py_ssize_t begin = t * per_tile;
+      const Py_ssize_t end = std::min(p.size, begin + per_tile);
+      if (begin < end) expr_run<T>(p, begin, end, scratch.get() + worker * per_worker);
+  });
+  Py_END_ALLOW_THREADS
+
+  return 0;
+
+}
+
+/**
+ * Compiles `node' for an output of type `type_num' and evaluates it into the
+ * array `out', which has the same type and into whose shape `node' broadcasts
+ */
+static int expr_evaluate(PyBlitzExprObject* node, PyBlitzArrayObject* out) {
+
+  expr_program p;
+  p.type_num = out->type_num;
+  p.ndim = out->ndim;
+  p.size = 1;
+  for (Py_ssize_t i=0; i<p.ndim; ++i) {
+    p.shape[i] = out->shape[i];
+    p.out_stride[i] = out->stride[i];
+    p.size *= p.shape[i];
+  }
+  p.out = reinterpret_cast<char*>(out->data);
+  p.out_contiguous = expr_is_contiguous(p, p.out_stride, PyBlitzArray_TypenumSize(out->type_num));
+
+  std::map<PyBlitzExprObject*, int> done;
+  if (!expr_compile(p, node, done, p.result)) return -1;
+
+  switch (p.type_num) {
+    case NPY_BOOL: return expr_execute<bool>(p);
+    case NPY_INT8: return expr_execute<int8_t>(p);
+    case NPY_INT16: return expr_execute<int16_t>(p);
+    case NPY_INT32: return expr_execute<int32_t>(p);
+    case NPY_INT64: return expr_execute<int64_t>(p);
+    case NPY_UINT8: return expr_execute<uint8_t>(p);
+    case NPY_UINT16: return expr_execute<uint16_t>(p);
+    case NPY_UINT32: return expr_execute<uint32_t>(p);
+    case NPY_UINT64: return expr_execute<uint64_t>(p);
+    case NPY_FLOAT32: return expr_execute<float>(p);
+    case NPY_FLOAT64: return expr_execute<double>(p);
+#ifdef NPY_FLOAT128
+    case NPY_FLOAT128: return expr_execute<long double>(p);
+#endif
+    case NPY_COMPLEX64: return expr_execute<std::complex<float>>(p);
+    case NPY_COMPLEX128: return expr_execute<std::complex<double>>(p);
+#ifdef NPY_COMPLEX256
+    case NPY_COMPLEX256: return expr_execute<std::complex<long double>>(p);
+#endif
+    default:
+      PyErr_Format(PyExc_TypeError, "cannot evaluate %s into arrays of type `%s'", PyBlitzExpr_Type.tp_name, PyBlitzArray_TypenumAsString(p.type_num));
+      return -1;
+  }
+
+}
+
+int PyBlitzExpr_EvalInto(PyObject* o, PyBlitzArrayObject* out) {
+
+  PyBlitzExprObject* node = reinterpret_cast<PyBlitzExprObject*>(o);
+
+  if (node->type_num != out->type_num) {
+    PyArray_Descr* from = PyArray_DescrFromType(node->type_num);
+    PyArray_Descr* to = PyArray_DescrFromType(out->type_num);
+    const bool castable = PyArray_CanCastTypeTo(from, to, NPY_SAME_KIND_CASTING);
+    Py_DECREF(from);
+    Py_DECREF(to);
+    if (!castable) {
+      PyErr_Format(PyExc_TypeError, "cannot store the result of a %s on `%s' into %s(@%" PY_FORMAT_SIZE_T "d,%s)", PyBlitzExpr_Type.tp_name, PyBlitzArray_TypenumAsString(node->type_num), Py_TYPE(out)->tp_name, out->ndim, PyBlitzArray_TypenumAsString(out->type_num));
+      return -1;
+    }
+  }
+
+  bool fits = node->ndim <= out->ndim;
+  for (Py_ssize_t i=0; fits && i<node->ndim; ++i) {
+    const Py_ssize_t e = node->shape[node->ndim-1-i];
+    fits = e == 1 || e == out->shape[out->ndim-1-i];
+  }
+  if (!fits) {
+    PyErr_Format(PyExc_ValueError, "cannot broadcast a %s with %" PY_FORMAT_SIZE_T "d dimension(s) into %s(@%" PY_FORMAT_SIZE_T "d,%s) of a different shape", PyBlitzExpr_Type.tp_name, node->ndim, Py_TYPE(out)->tp_name, out->ndim, PyBlitzArray_TypenumAsString(out->type_num));
+    return -1;
+  }
+
+  // the data of `out' is written to without the GIL
+  PyBlitzArray_PinData(out);
+  int retval = expr_evaluate(node, out);
+  PyBlitzArray_UnpinData(out);
+  return retval;
+
+}
+
+/*******************
+ * Python Bindings *
+ *******************/
+
+static PyObject* PyBlitzExpr_New(PyTypeObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"x", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  PyObject* x = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O", kwlist, &x)) return 0;
+
+  return reinterpret_cast<PyObject*>(expr_node(x));
+
+}
+
+auto eval = bob::extension::FunctionDoc(
+  "eval",
+  "Evaluates this expression into a new array",
+  0,
+  true
+)
+.add_prototype("", "array")
+.add_return("array", ":py:class:`" BOB_EXT_MODULE_PREFIX ".array`", "A new array with the result of this expression")
+;
+static PyObject* PyBlitzExpr_eval(PyBlitzExprObject* self) {
+
+  if (!self->ndim) {
+    PyErr_Format(PyExc_ValueError, "cannot evaluate %s involving no arrays", Py_TYPE(self)->tp_name);
+    return 0;
+  }
+
+  PyObject* retval = PyBlitzArray_SimpleNew(self->type_num, self->ndim, self->shape);
+  if (!retval) return 0;
+  auto retval_ = make_safe(retval);
+
+  if (expr_evaluate(self, reinterpret_cast<PyBlitzArrayObject*>(retval)) != 0) return 0;
+
+  Py_INCREF(retval);
+  return retval;
+
+}
+
+static PyMethodDef PyBlitzExpr_methods[] = {
+    {
+      eval.name(),
+      (PyCFunction)PyBlitzExpr_eval,
+      METH_NOARGS,
+      eval.doc()
+    },
+    {0}  /* Sentinel */
+};
+
+auto expr_shape = bob::extension::VariableDoc(
+  "shape",
+  "tuple",
+  "The shape of the result of this expression"
+);
+static PyObject* PyBlitzExpr_shape(PyBlitzExprObject* self, void*) {
+  PyObject* retval = PyTuple_New(self->ndim);
+  if (!retval) return 0;
+  for (Py_ssize_t i=0; i<self->ndim; ++i)
+    PyTuple_SET_ITEM(retval, i, Py_BuildValue("n", self->shape[i]));
+  return retval;
+}
+
+auto expr_dtype = bob::extension::VariableDoc(
+  "dtype",
+  ":py:class:`numpy.dtype`",
+  "The data type of the result of this expression"
+);
+static PyObject* PyBlitzExpr_dtype(PyBlitzExprObject* self, void*) {
+  return reinterpret_cast<PyObject*>(PyArray_DescrFromType(self->type_num));
+}
+
+static PyGetSetDef PyBlitzExpr_getseters[] = {
+    {
+      expr_shape.name(),
+      (getter)PyBlitzExpr_shape,
+      0,
+      expr_shape.doc(),
+      0,
+    },
+    {
+      expr_dtype.name(),
+      (getter)PyBlitzExpr_dtype,
+      0,
+      expr_dtype.doc(),
+      0,
+    },
+    {0}  /* Sentinel */
+};
+
+static PyObject* PyBlitzExpr_add(PyObject* a, PyObject* b) {
+  return expr_binary(a, b, '+');
+}
+
+static PyObject* PyBlitzExpr_subtract(PyObject* a, PyObject* b) {
+  return expr_binary(a, b, '-');
+}
+
+static PyObject* PyBlitzExpr_multiply(PyObject* a, PyObject* b) {
+  return expr_binary(a, b, '*');
+}
+
+static PyObject* PyBlitzExpr_true_divide(PyObject* a, PyObject* b) {
+  return expr_binary(a, b, '/');
+}
+
+static PyNumberMethods PyBlitzExpr_as_number;
+
+bool init_BlitzExpr(PyObject* module) {
+
+  PyBlitzExpr_Type.tp_name = expr_doc.name();
+  PyBlitzExpr_Type.tp_basicsize = sizeof(PyBlitzExprObject);
+  PyBlitzExpr_Type.tp_flags = Py_TPFLAGS_DEFAULT;
+  PyBlitzExpr_Type.tp_doc = expr_doc.doc();
+  PyBlitzExpr_Type.tp_new = PyBlitzExpr_New;
+  PyBlitzExpr_Type.tp_dealloc = reinterpret_cast<destructor>(PyBlitzExpr_Delete);
+  PyBlitzExpr_Type.tp_methods = PyBlitzExpr_methods;
+  PyBlitzExpr_Type.tp_getset = PyBlitzExpr_getseters;
+
+  PyBlitzExpr_as_number.nb_add = PyBlitzExpr_add;
+  PyBlitzExpr_as_number.nb_subtract = PyBlitzExpr_subtract;
+  PyBlitzExpr_as_number.nb_multiply = PyBlitzExpr_multiply;
+  PyBlitzExpr_as_number.nb_true_divide = PyBlitzExpr_true_divide;
+  PyBlitzExpr_Type.tp_as_number = &PyBlitzExpr_as_number;
+#if PY_VERSION_HEX < 0x03000000
+  PyBlitzExpr_Type.tp_flags |= Py_TPFLAGS_CHECKTYPES;
+#endif
+
+  // check that everyting is fine
+  if (PyType_Ready(&PyBlitzExpr_Type) < 0)
+    return false;
+
+  // numpy should leave operations with expressions to us
+  if (PyDict_SetItemString(PyBlitzExpr_Type.tp_dict, "__array_ufunc__", Py_None) < 0)
+    return false;
+  PyObject* priority = PyFloat_FromDouble(1000.);
+  if (!priority) return false;
+  auto priority_ = make_safe(priority);
+  if (PyDict_SetItemString(PyBlitzExpr_Type.tp_dict, "__array_priority__", priority) < 0)
+    return false;
+
+  // add the type to the module
+  Py_INCREF(&PyBlitzExpr_Type);
+  return PyModule_AddObject(module, "expr", (PyObject*)&PyBlitzExpr_Type) >= 0;
+}
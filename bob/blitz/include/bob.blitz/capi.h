@@ -32,6 +32,53 @@ extern "C" {
 /* Maximum number of dimensions supported at this library */
 #define BOB_BLITZ_MAXDIMS 4
 
+/* Bytes reserved inside each array object for the blitz::Array<> header */
+#define BOB_BLITZ_BZARR_STORAGE 192
+
+/* tracemalloc domain of the data of arrays (as numpy, with a domain of its
+   own, so traces can be told apart with tracemalloc.DomainFilter) */
+#define BOB_BLITZ_TRACEMALLOC_DOMAIN 0x627a
+
+/* Per-(T,N) operation table, opaque to users of the C-API */
+struct PyBlitzArrayVtable;
+
+/* Allocator for the data of arrays created with PyBlitzArray_SimpleNew() */
+typedef struct PyBlitzArrayAllocator {
+  const char* name; ///< a name, for reporting
+  void* (*malloc)(size_t size, void* ctx); ///< returns 0 on failure
+  void (*free)(void* ptr, size_t size, void* ctx);
+  void* ctx; ///< user data passed to both functions
+} PyBlitzArrayAllocator;
+
+/* How PyBlitzArray_CastMode() and PyBlitzArray_CastIntoMode() convert values
+   into integer types: the two lowest bits request rounding and saturation */
+typedef enum {
+  PyBlitzArray_CAST_TRUNCATE = 0, ///< towards zero, wrapping around, as in C
+  PyBlitzArray_CAST_ROUND_NEAREST = 1, ///< to the nearest integer, ties to even
+  PyBlitzArray_CAST_SATURATE = 2, ///< towards zero, clamped to the type range
+  PyBlitzArray_CAST_SATURATE_ROUND = 3 ///< to the nearest integer, clamped
+} PyBlitzArrayCastMode;
+
+/* Why PyBlitzArray_BehavedConverter() copied its input */
+typedef enum {
+  PyBlitzArray_COPY_NONCONTIGUOUS = 0, ///< not C-contiguous
+  PyBlitzArray_COPY_MISALIGNED = 1, ///< elements not aligned in memory
+  PyBlitzArray_COPY_DTYPE = 2, ///< element type not in native byte order
+  PyBlitzArray_COPY_REASONS = 3
+} PyBlitzArrayCopyReason;
+
+/* Counters since the module was loaded, see PyBlitzArray_GetStats() */
+typedef struct PyBlitzArrayStats {
+  unsigned long long arrays; ///< PyBlitzArrayObject's created
+  unsigned long long allocated; ///< bytes of data allocated for arrays
+  long long live; ///< bytes of data allocated for arrays still alive
+  unsigned long long copies[PyBlitzArray_COPY_REASONS]; ///< by PyBlitzArrayCopyReason
+  unsigned long long copied; ///< bytes copied by the above
+  unsigned long long casts; ///< calls to PyBlitzArray_Cast*()
+  unsigned long long cast_bytes; ///< bytes written by the above
+  unsigned long long wraps; ///< calls to PyBlitzArray_NUMPY_WRAP()
+} PyBlitzArrayStats;
+
 /* Type definition for PyBlitzArrayObject */
 typedef struct {
   PyObject_HEAD
@@ -48,6 +95,34 @@ typedef struct {
   /* Base pointer, if the memory of this object is coming from elsewhere */
   PyObject* base;
 
+  /* Number of buffer views (PEP 3118) currently exported by this object,
+     plus operations and handles using its data without the GIL */
+  Py_ssize_t exports;
+
+  /* 1 once other objects were given access to the data (ndarrays, slices,
+     rows, __array_interface__...), which then cannot be released before
+     the object itself */
+  int viewed;
+
+  /* Weak reference to the last numpy.ndarray view handed out, if any */
+  PyObject* npy_view;
+
+  /* Operations for the blitz::Array<T,N> in bzarr, set on construction */
+  const struct PyBlitzArrayVtable* vtable;
+
+  /* Allocator owning `data' (if any), and the size in bytes of the data
+     owned by this array, if any */
+  const PyBlitzArrayAllocator* allocator;
+  size_t allocated;
+
+  /* In-object storage for the blitz::Array<T,N> header, bzarr points here */
+  union {
+    char bytes[BOB_BLITZ_BZARR_STORAGE];
+    void* align_ptr;
+    double align_double;
+    long long align_ll;
+  } bzarr_storage;
+
 } PyBlitzArrayObject;
 
 /* C-API of some Numpy versions we may support */
@@ -99,6 +174,35 @@ enum _PyBlitzArray_ENUM{
   PyBlitzArray_TypenumAsString_NUM,
   PyBlitzArray_TypenumSize_NUM,
   PyBlitzArray_Cast_NUM,
+  // Data Allocators
+  PyBlitzArray_SetAllocator_NUM,
+  PyBlitzArray_GetAllocator_NUM,
+  PyBlitzArray_AllocatorByName_NUM,
+  // Memory-mapped Files
+  PyBlitzArray_FromFile_NUM,
+  PyBlitzArray_FromNpyFile_NUM,
+  // Shared Memory
+  PyBlitzArray_SharedNew_NUM,
+  PyBlitzArray_SharedAttach_NUM,
+  // Slicing
+  PyBlitzArray_GetSubscript_NUM,
+  PyBlitzArray_SetSubscript_NUM,
+  // Bulk Element Access
+  PyBlitzArray_Take_NUM,
+  PyBlitzArray_Put_NUM,
+  // Reductions
+  PyBlitzArray_Reduce_NUM,
+  PyBlitzArray_Dot_NUM,
+  // Casts
+  PyBlitzArray_CastInto_NUM,
+  PyBlitzArray_CastMode_NUM,
+  PyBlitzArray_CastIntoMode_NUM,
+  PyBlitzArray_CastModeConverter_NUM,
+  // Threads
+  PyBlitzArray_DeferDecRef_NUM,
+  PyBlitzArray_DeferRelease_NUM,
+  // Statistics
+  PyBlitzArray_GetStats_NUM,
   /* Total number of C API pointers */
   PyBlitzArray_API_pointers
 };
@@ -229,6 +333,102 @@ enum _PyBlitzArray_ENUM{
 #define PyBlitzArray_Cast_RET PyObject*
 #define PyBlitzArray_Cast_PROTO (PyBlitzArrayObject* o, int typenum)
 
+/*******************
+ * Data Allocators *
+ *******************/
+
+#define PyBlitzArray_SetAllocator_RET int
+#define PyBlitzArray_SetAllocator_PROTO (const PyBlitzArrayAllocator* allocator)
+
+#define PyBlitzArray_GetAllocator_RET const PyBlitzArrayAllocator*
+#define PyBlitzArray_GetAllocator_PROTO (void)
+
+#define PyBlitzArray_AllocatorByName_RET const PyBlitzArrayAllocator*
+#define PyBlitzArray_AllocatorByName_PROTO (const char* name)
+
+/***********************
+ * Memory-mapped Files *
+ ***********************/
+
+#define PyBlitzArray_FromFile_RET PyObject*
+#define PyBlitzArray_FromFile_PROTO (const char* path, int typenum, Py_ssize_t ndim, Py_ssize_t* shape, Py_ssize_t offset, const char* mode, int advice)
+
+#define PyBlitzArray_FromNpyFile_RET PyObject*
+#define PyBlitzArray_FromNpyFile_PROTO (const char* path, const char* mode, int advice)
+
+/*****************
+ * Shared Memory *
+ *****************/
+
+#define PyBlitzArray_SharedNew_RET PyObject*
+#define PyBlitzArray_SharedNew_PROTO (int typenum, Py_ssize_t ndim, Py_ssize_t* shape, const char* name)
+
+#define PyBlitzArray_SharedAttach_RET PyObject*
+#define PyBlitzArray_SharedAttach_PROTO (const char* name, int fd, int typenum, Py_ssize_t ndim, Py_ssize_t* shape, int writeable)
+
+/***********
+ * Slicing *
+ ***********/
+
+#define PyBlitzArray_GetSubscript_RET PyObject*
+#define PyBlitzArray_GetSubscript_PROTO (PyBlitzArrayObject* o, PyObject* index)
+
+#define PyBlitzArray_SetSubscript_RET int
+#define PyBlitzArray_SetSubscript_PROTO (PyBlitzArrayObject* o, PyObject* index, PyObject* value)
+
+/***********************
+ * Bulk Element Access *
+ ***********************/
+
+#define PyBlitzArray_Take_RET PyObject*
+#define PyBlitzArray_Take_PROTO (PyBlitzArrayObject* o, PyObject* indices)
+
+#define PyBlitzArray_Put_RET int
+#define PyBlitzArray_Put_PROTO (PyBlitzArrayObject* o, PyObject* indices, PyObject* values)
+
+/**************
+ * Reductions *
+ **************/
+
+#define PyBlitzArray_Reduce_RET PyObject*
+#define PyBlitzArray_Reduce_PROTO (PyBlitzArrayObject* o, const char* op)
+
+#define PyBlitzArray_Dot_RET PyObject*
+#define PyBlitzArray_Dot_PROTO (PyBlitzArrayObject* a, PyBlitzArrayObject* b)
+
+/*********
+ * Casts *
+ *********/
+
+#define PyBlitzArray_CastInto_RET int
+#define PyBlitzArray_CastInto_PROTO (PyBlitzArrayObject* src, PyBlitzArrayObject* dst)
+
+#define PyBlitzArray_CastMode_RET PyObject*
+#define PyBlitzArray_CastMode_PROTO (PyBlitzArrayObject* o, int typenum, int mode, double scale, double offset)
+
+#define PyBlitzArray_CastIntoMode_RET int
+#define PyBlitzArray_CastIntoMode_PROTO (PyBlitzArrayObject* src, PyBlitzArrayObject* dst, int mode, double scale, double offset)
+
+#define PyBlitzArray_CastModeConverter_RET int
+#define PyBlitzArray_CastModeConverter_PROTO (PyObject* o, int* mode)
+
+/***********
+ * Threads *
+ ***********/
+
+#define PyBlitzArray_DeferDecRef_RET void
+#define PyBlitzArray_DeferDecRef_PROTO (PyObject* o)
+
+#define PyBlitzArray_DeferRelease_RET void
+#define PyBlitzArray_DeferRelease_PROTO (PyBlitzArrayObject* o)
+
+/**************
+ * Statistics *
+ **************/
+
+#define PyBlitzArray_GetStats_RET void
+#define PyBlitzArray_GetStats_PROTO (PyBlitzArrayStats* stats)
+
 
 #ifdef BOB_BLITZ_MODULE
 
@@ -325,6 +525,82 @@ enum _PyBlitzArray_ENUM{
 
   PyBlitzArray_Cast_RET PyBlitzArray_Cast PyBlitzArray_Cast_PROTO;
 
+/*******************
+ * Data Allocators *
+ *******************/
+
+  PyBlitzArray_SetAllocator_RET PyBlitzArray_SetAllocator PyBlitzArray_SetAllocator_PROTO;
+
+  PyBlitzArray_GetAllocator_RET PyBlitzArray_GetAllocator PyBlitzArray_GetAllocator_PROTO;
+
+  PyBlitzArray_AllocatorByName_RET PyBlitzArray_AllocatorByName PyBlitzArray_AllocatorByName_PROTO;
+
+/***********************
+ * Memory-mapped Files *
+ ***********************/
+
+  PyBlitzArray_FromFile_RET PyBlitzArray_FromFile PyBlitzArray_FromFile_PROTO;
+
+  PyBlitzArray_FromNpyFile_RET PyBlitzArray_FromNpyFile PyBlitzArray_FromNpyFile_PROTO;
+
+/*****************
+ * Shared Memory *
+ *****************/
+
+  PyBlitzArray_SharedNew_RET PyBlitzArray_SharedNew PyBlitzArray_SharedNew_PROTO;
+
+  PyBlitzArray_SharedAttach_RET PyBlitzArray_SharedAttach PyBlitzArray_SharedAttach_PROTO;
+
+/***********
+ * Slicing *
+ ***********/
+
+  PyBlitzArray_GetSubscript_RET PyBlitzArray_GetSubscript PyBlitzArray_GetSubscript_PROTO;
+
+  PyBlitzArray_SetSubscript_RET PyBlitzArray_SetSubscript PyBlitzArray_SetSubscript_PROTO;
+
+/***********************
+ * Bulk Element Access *
+ ***********************/
+
+  PyBlitzArray_Take_RET PyBlitzArray_Take PyBlitzArray_Take_PROTO;
+
+  PyBlitzArray_Put_RET PyBlitzArray_Put PyBlitzArray_Put_PROTO;
+
+/**************
+ * Reductions *
+ **************/
+
+  PyBlitzArray_Reduce_RET PyBlitzArray_Reduce PyBlitzArray_Reduce_PROTO;
+
+  PyBlitzArray_Dot_RET PyBlitzArray_Dot PyBlitzArray_Dot_PROTO;
+
+/*********
+ * Casts *
+ *********/
+
+  PyBlitzArray_CastInto_RET PyBlitzArray_CastInto PyBlitzArray_CastInto_PROTO;
+
+  PyBlitzArray_CastMode_RET PyBlitzArray_CastMode PyBlitzArray_CastMode_PROTO;
+
+  PyBlitzArray_CastIntoMode_RET PyBlitzArray_CastIntoMode PyBlitzArray_CastIntoMode_PROTO;
+
+  PyBlitzArray_CastModeConverter_RET PyBlitzArray_CastModeConverter PyBlitzArray_CastModeConverter_PROTO;
+
+/***********
+ * Threads *
+ ***********/
+
+  PyBlitzArray_DeferDecRef_RET PyBlitzArray_DeferDecRef PyBlitzArray_DeferDecRef_PROTO;
+
+  PyBlitzArray_DeferRelease_RET PyBlitzArray_DeferRelease PyBlitzArray_DeferRelease_PROTO;
+
+/**************
+ * Statistics *
+ **************/
+
+  PyBlitzArray_GetStats_RET PyBlitzArray_GetStats PyBlitzArray_GetStats_PROTO;
+
 #else
 
 #  if defined(NO_IMPORT_ARRAY)
@@ -427,6 +703,82 @@ enum _PyBlitzArray_ENUM{
 
 #define PyBlitzArray_Cast (*(PyBlitzArray_Cast_RET (*)PyBlitzArray_Cast_PROTO) PyBlitzArray_API[PyBlitzArray_Cast_NUM])
 
+/*******************
+ * Data Allocators *
+ *******************/
+
+#define PyBlitzArray_SetAllocator (*(PyBlitzArray_SetAllocator_RET (*)PyBlitzArray_SetAllocator_PROTO) PyBlitzArray_API[PyBlitzArray_SetAllocator_NUM])
+
+#define PyBlitzArray_GetAllocator (*(PyBlitzArray_GetAllocator_RET (*)PyBlitzArray_GetAllocator_PROTO) PyBlitzArray_API[PyBlitzArray_GetAllocator_NUM])
+
+#define PyBlitzArray_AllocatorByName (*(PyBlitzArray_AllocatorByName_RET (*)PyBlitzArray_AllocatorByName_PROTO) PyBlitzArray_API[PyBlitzArray_AllocatorByName_NUM])
+
+/***********************
+ * Memory-mapped Files *
+ ***********************/
+
+#define PyBlitzArray_FromFile (*(PyBlitzArray_FromFile_RET (*)PyBlitzArray_FromFile_PROTO) PyBlitzArray_API[PyBlitzArray_FromFile_NUM])
+
+#define PyBlitzArray_FromNpyFile (*(PyBlitzArray_FromNpyFile_RET (*)PyBlitzArray_FromNpyFile_PROTO) PyBlitzArray_API[PyBlitzArray_FromNpyFile_NUM])
+
+/*****************
+ * Shared Memory *
+ *****************/
+
+#define PyBlitzArray_SharedNew (*(PyBlitzArray_SharedNew_RET (*)PyBlitzArray_SharedNew_PROTO) PyBlitzArray_API[PyBlitzArray_SharedNew_NUM])
+
+#define PyBlitzArray_SharedAttach (*(PyBlitzArray_SharedAttach_RET (*)PyBlitzArray_SharedAttach_PROTO) PyBlitzArray_API[PyBlitzArray_SharedAttach_NUM])
+
+/***********
+ * Slicing *
+ ***********/
+
+#define PyBlitzArray_GetSubscript (*(PyBlitzArray_GetSubscript_RET (*)PyBlitzArray_GetSubscript_PROTO) PyBlitzArray_API[PyBlitzArray_GetSubscript_NUM])
+
+#define PyBlitzArray_SetSubscript (*(PyBlitzArray_SetSubscript_RET (*)PyBlitzArray_SetSubscript_PROTO) PyBlitzArray_API[PyBlitzArray_SetSubscript_NUM])
+
+/***********************
+ * Bulk Element Access *
+ ***********************/
+
+#define PyBlitzArray_Take (*(PyBlitzArray_Take_RET (*)PyBlitzArray_Take_PROTO) PyBlitzArray_API[PyBlitzArray_Take_NUM])
+
+#define PyBlitzArray_Put (*(PyBlitzArray_Put_RET (*)PyBlitzArray_Put_PROTO) PyBlitzArray_API[PyBlitzArray_Put_NUM])
+
+/**************
+ * Reductions *
+ **************/
+
+#define PyBlitzArray_Reduce (*(PyBlitzArray_Reduce_RET (*)PyBlitzArray_Reduce_PROTO) PyBlitzArray_API[PyBlitzArray_Reduce_NUM])
+
+#define PyBlitzArray_Dot (*(PyBlitzArray_Dot_RET (*)PyBlitzArray_Dot_PROTO) PyBlitzArray_API[PyBlitzArray_Dot_NUM])
+
+/*********
+ * Casts *
+ *********/
+
+#define PyBlitzArray_CastInto (*(PyBlitzArray_CastInto_RET (*)PyBlitzArray_CastInto_PROTO) PyBlitzArray_API[PyBlitzArray_CastInto_NUM])
+
+#define PyBlitzArray_CastMode (*(PyBlitzArray_CastMode_RET (*)PyBlitzArray_CastMode_PROTO) PyBlitzArray_API[PyBlitzArray_CastMode_NUM])
+
+#define PyBlitzArray_CastIntoMode (*(PyBlitzArray_CastIntoMode_RET (*)PyBlitzArray_CastIntoMode_PROTO) PyBlitzArray_API[PyBlitzArray_CastIntoMode_NUM])
+
+#define PyBlitzArray_CastModeConverter (*(PyBlitzArray_CastModeConverter_RET (*)PyBlitzArray_CastModeConverter_PROTO) PyBlitzArray_API[PyBlitzArray_CastModeConverter_NUM])
+
+/***********
+ * Threads *
+ ***********/
+
+#define PyBlitzArray_DeferDecRef (*(PyBlitzArray_DeferDecRef_RET (*)PyBlitzArray_DeferDecRef_PROTO) PyBlitzArray_API[PyBlitzArray_DeferDecRef_NUM])
+
+#define PyBlitzArray_DeferRelease (*(PyBlitzArray_DeferRelease_RET (*)PyBlitzArray_DeferRelease_PROTO) PyBlitzArray_API[PyBlitzArray_DeferRelease_NUM])
+
+/**************
+ * Statistics *
+ **************/
+
+#define PyBlitzArray_GetStats (*(PyBlitzArray_GetStats_RET (*)PyBlitzArray_GetStats_PROTO) PyBlitzArray_API[PyBlitzArray_GetStats_NUM])
+
 # if !defined(NO_IMPORT_ARRAY)
 
   /**
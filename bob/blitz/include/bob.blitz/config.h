@@ -8,8 +8,9 @@
 #ifndef BOB_BLITZ_CONFIG_H
 #define BOB_BLITZ_CONFIG_H
 
-/* Define API version */
-#define BOB_BLITZ_API_VERSION 0x0202
+/* Define API version: bump it whenever the API table or the layout of
+   PyBlitzArrayObject change */
+#define BOB_BLITZ_API_VERSION 0x0204
 
 
 #ifdef BOB_IMPORT_VERSION
@@ -15,141 +15,251 @@
 #include <blitz/array.h>
 #include <stdint.h>
 #include <stdexcept>
-#include <typeinfo>
-
-template <typename T> int PyBlitzArrayCxx_CToTypenum() {
-
-  const std::type_info& ttype = typeid(T);
-
-  if (ttype == typeid(bool))          return NPY_BOOL;
-  else if (ttype == typeid(uint8_t))  return NPY_UINT8;
-  else if (ttype == typeid(uint16_t)) return NPY_UINT16;
-  else if (ttype == typeid(uint32_t)) return NPY_UINT32;
-  else if (ttype == typeid(uint64_t)) return NPY_UINT64;
-  else if (ttype == typeid(int8_t))   return NPY_INT8;
-  else if (ttype == typeid(int16_t))  return NPY_INT16;
-  else if (ttype == typeid(int32_t))  return NPY_INT32;
-  else if (ttype == typeid(int64_t))  return NPY_INT64;
-  else if (ttype == typeid(float))    return NPY_FLOAT32;
-  else if (ttype == typeid(double))   return NPY_FLOAT64;
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+/**
+ * Compile-time mapping between C++ types and numpy type numbers. Using an
+ * unsupported type is a compilation error.
+ */
+template <typename T> struct PyBlitzArrayCxx_CTypenum {
+  static_assert(sizeof(T) == 0, "c++ type to numpy type_num conversion unsupported for this type");
+  static constexpr int value = NPY_NOTYPE;
+};
+
+template <> struct PyBlitzArrayCxx_CTypenum<bool> { static constexpr int value = NPY_BOOL; };
+template <> struct PyBlitzArrayCxx_CTypenum<uint8_t> { static constexpr int value = NPY_UINT8; };
+template <> struct PyBlitzArrayCxx_CTypenum<uint16_t> { static constexpr int value = NPY_UINT16; };
+template <> struct PyBlitzArrayCxx_CTypenum<uint32_t> { static constexpr int value = NPY_UINT32; };
+template <> struct PyBlitzArrayCxx_CTypenum<uint64_t> { static constexpr int value = NPY_UINT64; };
+template <> struct PyBlitzArrayCxx_CTypenum<int8_t> { static constexpr int value = NPY_INT8; };
+template <> struct PyBlitzArrayCxx_CTypenum<int16_t> { static constexpr int value = NPY_INT16; };
+template <> struct PyBlitzArrayCxx_CTypenum<int32_t> { static constexpr int value = NPY_INT32; };
+template <> struct PyBlitzArrayCxx_CTypenum<int64_t> { static constexpr int value = NPY_INT64; };
+template <> struct PyBlitzArrayCxx_CTypenum<float> { static constexpr int value = NPY_FLOAT32; };
+template <> struct PyBlitzArrayCxx_CTypenum<double> { static constexpr int value = NPY_FLOAT64; };
 #ifdef NPY_FLOAT128
-  else if (ttype == typeid(long double)) return NPY_FLOAT128;
+template <> struct PyBlitzArrayCxx_CTypenum<long double> { static constexpr int value = NPY_FLOAT128; };
 #endif
-  else if (ttype == typeid(std::complex<float>))  return NPY_COMPLEX64;
-  else if (ttype == typeid(std::complex<double>)) return NPY_COMPLEX128;
+template <> struct PyBlitzArrayCxx_CTypenum<std::complex<float>> { static constexpr int value = NPY_COMPLEX64; };
+template <> struct PyBlitzArrayCxx_CTypenum<std::complex<double>> { static constexpr int value = NPY_COMPLEX128; };
 #ifdef NPY_COMPLEX256
-  else if (ttype == typeid(std::complex<long double>)) return NPY_COMPLEX256;
+template <> struct PyBlitzArrayCxx_CTypenum<std::complex<long double>> { static constexpr int value = NPY_COMPLEX256; };
 #endif
 #ifdef __APPLE__
-  else if (ttype == typeid(long)) {
-    if (sizeof(long) == 4) return NPY_INT32;
-    else return NPY_INT64;
-  }
-  else if (ttype == typeid(unsigned long)) {
-    if (sizeof(unsigned long) == 4) return NPY_UINT32;
-    else return NPY_UINT64;
+template <> struct PyBlitzArrayCxx_CTypenum<long> { static constexpr int value = sizeof(long) == 4 ? NPY_INT32 : NPY_INT64; };
+template <> struct PyBlitzArrayCxx_CTypenum<unsigned long> { static constexpr int value = sizeof(unsigned long) == 4 ? NPY_UINT32 : NPY_UINT64; };
+#endif
+
+template <typename T> constexpr int PyBlitzArrayCxx_CToTypenum() {
+  return PyBlitzArrayCxx_CTypenum<T>::value;
+}
+
+/**
+ * Allocation-free conversions from Python built-in numbers and numpy scalars
+ * of the exact type. They return 1 if `o' was converted into `v' and 0 if
+ * the generic (numpy-based) conversion path must be taken instead, in which
+ * case no error is set.
+ */
+template <typename T>
+int PyBlitzArrayCxx_AsCScalarFast(PyObject* o, T& v, std::true_type /*integral*/, std::false_type) {
+
+#if PY_VERSION_HEX < 0x03000000
+  if (PyInt_Check(o)) {
+    long l = PyInt_AS_LONG(o);
+    if (l < (long long)std::numeric_limits<T>::min()) return 0;
+    if (l > 0 && (unsigned long long)l > (unsigned long long)std::numeric_limits<T>::max()) return 0;
+    v = static_cast<T>(l);
+    return 1;
   }
 #endif
 
-  // if you get to this point, the type is not supported
-  PyErr_Format(PyExc_NotImplementedError, "c++ type to numpy type_num conversion unsupported for typeid.name() `%s'", typeid(T).name());
-  return -1;
+  if (PyLong_Check(o)) {
+    int overflow = 0;
+    long long l = PyLong_AsLongLongAndOverflow(o, &overflow);
+    if (overflow || (l == -1 && PyErr_Occurred())) {
+      PyErr_Clear();
+      return 0;
+    }
+    // out-of-range values are left for numpy to deal with
+    if (l < (long long)std::numeric_limits<T>::min()) return 0;
+    if (l > 0 && (unsigned long long)l > (unsigned long long)std::numeric_limits<T>::max()) return 0;
+    v = static_cast<T>(l);
+    return 1;
+  }
+
+  return 0;
+}
+
+template <typename T>
+int PyBlitzArrayCxx_AsCScalarFast(PyObject* o, T& v, std::false_type, std::true_type /*floating point*/) {
+
+  if (PyFloat_Check(o)) {
+    v = static_cast<T>(PyFloat_AS_DOUBLE(o));
+    return 1;
+  }
+
+  long long l = 0;
+  if (PyBlitzArrayCxx_AsCScalarFast(o, l, std::true_type(), std::false_type())) {
+    v = static_cast<T>(l);
+    return 1;
+  }
+
+  return 0;
+}
+
+template <typename T>
+int PyBlitzArrayCxx_AsCScalarFast(PyObject* o, T& v, std::false_type, std::false_type /*complex*/) {
 
+  if (PyComplex_Check(o)) {
+    v = T(PyComplex_RealAsDouble(o), PyComplex_ImagAsDouble(o));
+    return 1;
+  }
+
+  typename T::value_type real = 0;
+  if (PyBlitzArrayCxx_AsCScalarFast(o, real, std::false_type(), std::true_type())) {
+    v = T(real, 0);
+    return 1;
+  }
+
+  return 0;
 }
 
 template <typename T> T PyBlitzArrayCxx_AsCScalar(PyObject* o) {
 
-  int type_num = PyBlitzArrayCxx_CToTypenum<T>();
-  if (PyErr_Occurred()) {
-    T retval = 0;
-    return retval;
+  constexpr int type_num = PyBlitzArrayCxx_CToTypenum<T>();
+
+  T retval = 0;
+
+  // python built-in numbers
+  if (PyBlitzArrayCxx_AsCScalarFast(o, retval, std::is_integral<T>(),
+        std::is_floating_point<T>())) return retval;
+
+  // numpy scalars of the exact type
+  if (PyArray_IsScalar(o, Generic)) {
+    PyArray_Descr* descr = PyArray_DescrFromScalar(o);
+    int matches = descr && PyArray_EquivTypenums(descr->type_num, type_num);
+    Py_XDECREF(descr);
+    if (matches) {
+      PyArray_ScalarAsCtype(o, &retval);
+      return retval;
+    }
   }
 
+  // generic path: let numpy convert the object
   // create a zero-dimensional array on the expected type
   PyArrayObject* zerodim =
     reinterpret_cast<PyArrayObject*>(PyArray_SimpleNew(0, 0, type_num));
 
-  if (!zerodim) {
-    T retval = 0;
-    return retval;
-  }
+  if (!zerodim) return retval;
 
   int status = PyArray_SETITEM(zerodim,
       reinterpret_cast<char*>(PyArray_DATA(zerodim)), o);
 
   if (status != 0) {
-    T retval = 0;
+    Py_DECREF(zerodim);
     return retval;
   }
 
   // note: this will decref `zerodim'
   PyObject* scalar=PyArray_Return(zerodim);
 
-  if (!scalar) {
-    T retval = 0;
-    return retval;
-  }
+  if (!scalar) return retval;
 
-  T retval = 0;
   PyArray_ScalarAsCtype(scalar, &retval);
   Py_DECREF(scalar);
   return retval;
 }
 
-template <typename T> PyObject* PyBlitzArrayCxx_FromCScalar(T v) {
-
-  PyArray_Descr* descr = 0;
-  const std::type_info& ttype = typeid(T);
-
-  if (ttype == typeid(bool))
-    descr = PyArray_DescrFromType(NPY_BOOL);
-  else if (ttype == typeid(uint8_t))
-    descr = PyArray_DescrFromType(NPY_UINT8);
-  else if (ttype == typeid(uint16_t))
-    descr = PyArray_DescrFromType(NPY_UINT16);
-  else if (ttype == typeid(uint32_t))
-    descr = PyArray_DescrFromType(NPY_UINT32);
-  else if (ttype == typeid(uint64_t))
-    descr = PyArray_DescrFromType(NPY_UINT64);
-  else if (ttype == typeid(int8_t))
-    descr = PyArray_DescrFromType(NPY_INT8);
-  else if (ttype == typeid(int16_t))
-    descr = PyArray_DescrFromType(NPY_INT16);
-  else if (ttype == typeid(int32_t))
-    descr = PyArray_DescrFromType(NPY_INT32);
-  else if (ttype == typeid(int64_t))
-    descr = PyArray_DescrFromType(NPY_INT64);
-  else if (ttype == typeid(float))
-    descr = PyArray_DescrFromType(NPY_FLOAT32);
-  else if (ttype == typeid(double))
-    descr = PyArray_DescrFromType(NPY_FLOAT64);
-#ifdef NPY_FLOAT128
-  else if (ttype == typeid(long double))
-    descr = PyArray_DescrFromType(NPY_FLOAT128);
-#endif
-  else if (ttype == typeid(std::complex<float>))
-    descr = PyArray_DescrFromType(NPY_COMPLEX64);
-  else if (ttype == typeid(std::complex<double>))
-    descr = PyArray_DescrFromType(NPY_COMPLEX128);
-#ifdef NPY_COMPLEX256
-  else if (ttype == typeid(std::complex<long double>))
-    descr = PyArray_DescrFromType(NPY_COMPLEX256);
-#endif
-#ifdef __APPLE__
-  else if (ttype == typeid(long)) {
-    if (sizeof(long) == 4) descr = PyArray_DescrFromType(NPY_INT32);
-    else descr = PyArray_DescrFromType(NPY_INT64);
+/**
+ * Converts all elements of `o' into `out', which is resized accordingly. `C'
+ * may be any container with resize() and begin() (e.g. std::vector<T> or
+ * blitz::Array<T,1>). Returns 1 on success and 0 on failure, in which case a
+ * Python error is set.
+ */
+template <typename T, typename C>
+int PyBlitzArrayCxx_AsCScalarContainer(PyObject* o, C& out) {
+
+  // arrays are converted (and possibly cast) in a single shot
+  PyObject* nd = 0;
+  if (PyBlitzArray_Check(o)) {
+    nd = PyBlitzArray_AsNumpyArray(reinterpret_cast<PyBlitzArrayObject*>(o), 0);
+    if (!nd) return 0;
   }
-  else if (ttype == typeid(unsigned long)) {
-    if (sizeof(unsigned long) == 4) descr = PyArray_DescrFromType(NPY_UINT32);
-    else descr = PyArray_DescrFromType(NPY_UINT64);
+  else if (PyArray_Check(o)) {
+    nd = o;
+    Py_INCREF(nd);
   }
-#endif
-  else {
-    PyErr_Format(PyExc_NotImplementedError, "c++ value to numpy scalar conversion unsupported for typeid.name() == `%s'", typeid(T).name());
-    return 0;
+
+  if (nd) {
+    // note: steals the reference to the descriptor
+    PyObject* arr = PyArray_FromAny(nd,
+        PyArray_DescrFromType(PyBlitzArrayCxx_CToTypenum<T>()), 1, 1,
+#       if NPY_FEATURE_VERSION >= NUMPY17_API /* NumPy C-API version >= 1.7 */
+        NPY_ARRAY_CARRAY_RO | NPY_ARRAY_FORCECAST,
+#       else
+        NPY_CARRAY_RO | NPY_FORCECAST,
+#       endif
+        0);
+    Py_DECREF(nd);
+    if (!arr) return 0;
+    const T* data = reinterpret_cast<const T*>(PyArray_DATA(reinterpret_cast<PyArrayObject*>(arr)));
+    Py_ssize_t size = PyArray_DIM(reinterpret_cast<PyArrayObject*>(arr), 0);
+    out.resize(size);
+    std::copy(data, data+size, out.begin());
+    Py_DECREF(arr);
+    return 1;
+  }
+
+  // any other sequence is converted element by element
+  PyObject* seq = PySequence_Fast(o, "input must be a sequence of scalars");
+  if (!seq) return 0;
+
+  Py_ssize_t size = PySequence_Fast_GET_SIZE(seq);
+  PyObject** items = PySequence_Fast_ITEMS(seq);
+  out.resize(size);
+  auto it = out.begin();
+  for (Py_ssize_t i=0; i<size; ++i, ++it) {
+    *it = PyBlitzArrayCxx_AsCScalar<T>(items[i]);
+    if (PyErr_Occurred()) {
+      Py_DECREF(seq);
+      return 0;
+    }
   }
 
+  Py_DECREF(seq);
+  return 1;
+}
+
+/**
+ * Converts a Python sequence, numpy.ndarray or bob.blitz.array into a
+ * std::vector<T>. Check PyErr_Occurred() after calling this function.
+ */
+template <typename T> std::vector<T> PyBlitzArrayCxx_AsCScalarVector(PyObject* o) {
+  std::vector<T> retval;
+  PyBlitzArrayCxx_AsCScalarContainer<T>(o, retval);
+  return retval;
+}
+
+/**
+ * Converts a Python sequence, numpy.ndarray or bob.blitz.array into a
+ * blitz::Array<T,1>. Check PyErr_Occurred() after calling this function.
+ */
+template <typename T> blitz::Array<T,1> PyBlitzArrayCxx_AsCScalarArray(PyObject* o) {
+  blitz::Array<T,1> retval;
+  PyBlitzArrayCxx_AsCScalarContainer<T>(o, retval);
+  return retval;
+}
+
+template <typename T> PyObject* PyBlitzArrayCxx_FromCScalar(T v) {
+
+  PyArray_Descr* descr = PyArray_DescrFromType(PyBlitzArrayCxx_CToTypenum<T>());
+  if (!descr) return 0;
+
   PyObject* retval = PyArray_Scalar(&v, descr, 0);
   Py_DECREF(descr);
   return retval;
@@ -179,18 +289,18 @@ PyObject* PyBlitzArrayCxx_NewFromConstArray(const blitz::Array<T,N>& a) {
 
   try {
 
-    PyTypeObject& tp = PyBlitzArray_Type;
-    PyBlitzArrayObject* retval = (PyBlitzArrayObject*)PyBlitzArray_New(&tp, 0, 0);
-    retval->bzarr = static_cast<void*>(new blitz::Array<T,N>(a));
-    retval->data = const_cast<void*>(static_cast<const void*>(a.data()));
-    retval->type_num = PyBlitzArrayCxx_CToTypenum<T>();
-    retval->ndim = N;
-    for (Py_ssize_t i=0; i<N; ++i) {
-      retval->shape[i] = a.extent(i);
-      retval->stride[i] = sizeof(T)*a.stride(i); ///in **bytes**
+    Py_ssize_t shape[N];
+    Py_ssize_t stride[N];
+    for (int i=0; i<N; ++i) {
+      shape[i] = a.extent(i);
+      stride[i] = sizeof(T)*a.stride(i); ///in **bytes**
     }
-    retval->writeable = 0;
-    return reinterpret_cast<PyObject*>(retval);
+    PyObject* retval = PyBlitzArray_SimpleNewFromData(PyBlitzArrayCxx_CToTypenum<T>(), N, shape, stride, const_cast<T*>(a.data()), 0);
+    if (!retval) return 0;
+
+    // shares (and keeps alive) the memory block of the input array
+    reinterpret_cast<blitz::Array<T,N>*>(reinterpret_cast<PyBlitzArrayObject*>(retval)->bzarr)->reference(a);
+    return retval;
 
   }
 
@@ -266,7 +376,7 @@ template<typename T, int N>
 blitz::Array<T,N>* PyBlitzArrayCxx_AsBlitz(PyBlitzArrayObject* array, const char* name) {
 
   // get the python type of the templated C++ type
-  int type_num = PyBlitzArrayCxx_CToTypenum<T>();
+  constexpr int type_num = PyBlitzArrayCxx_CToTypenum<T>();
   // perform the checks
   if (array->type_num != type_num || array->ndim != N){
     const char* type_num_name = PyBlitzArray_TypenumAsString(type_num);
@@ -277,4 +387,293 @@ blitz::Array<T,N>* PyBlitzArrayCxx_AsBlitz(PyBlitzArrayObject* array, const char
   return PyBlitzArrayCxx_AsBlitz<T,N>(array);
 }
 
+template<typename T, int N> class PyBlitzArrayCxx_Handle;
+
+/**
+ * A read-only view on the memory of an array, see
+ * PyBlitzArrayCxx_Handle::const_view(). Unlike a const blitz::Array<T,N>,
+ * which can be copied into a writeable one, it only hands out constant
+ * elements: use copy() for a writeable array of its own.
+ */
+template<typename T, int N>
+class PyBlitzArrayCxx_ConstView {
+
+  public:
+
+    /**
+     * The element at the given (N) indices
+     */
+    template<typename... I>
+    const T& operator() (I... i) const { return m_array(i...); }
+
+    const T* data() const { return m_array.data(); }
+
+    const blitz::TinyVector<int,N>& shape() const { return m_array.shape(); }
+
+    int extent(int i) const { return m_array.extent(i); }
+
+    std::size_t size() const { return m_array.numElements(); }
+
+    /**
+     * A new blitz::Array<T,N> holding a copy of the elements
+     */
+    blitz::Array<T,N> copy() const { return m_array.copy(); }
+
+  private:
+
+    friend class PyBlitzArrayCxx_Handle<T,N>;
+
+    explicit PyBlitzArrayCxx_ConstView(const blitz::Array<T,N>& a):
+      m_array(a) {}
+
+    blitz::Array<T,N> m_array;
+
+};
+
+/**
+ * A handle on the memory of a bob.blitz.array, which can be used by threads
+ * not holding the GIL. Handles keep the array alive with a reference count of
+ * their own, atomic, shared by all copies of a handle: only acquiring a
+ * handle requires the GIL, copying, assigning and destroying it (from any
+ * thread) do not. While handles exist, the array also counts as exported, so
+ * its memory cannot be replaced by re-initializing it.
+ *
+ * The last handle on an array releases the Python object immediately if its
+ * thread holds the GIL, or otherwise the next time the main thread runs
+ * Python's pending calls (see PyBlitzArray_DeferRelease()).
+ *
+ * @note Blitz++ arrays sharing memory count their references without
+ * atomics, so the views of a handle must not be shared between threads:
+ * hand a copy of the handle to each thread instead, and create a view there.
+ */
+template<typename T, int N>
+class PyBlitzArrayCxx_Handle {
+
+  public:
+
+    /**
+     * An empty handle
+     */
+    PyBlitzArrayCxx_Handle(): m_pin(0) {}
+
+    /**
+     * Acquires a handle on the given array, which must hold elements of type
+     * T and have N dimensions. Requires the GIL.
+     *
+     * @throws std::bad_alloc if there is no memory left for the handle
+     */
+    explicit PyBlitzArrayCxx_Handle(PyBlitzArrayObject* o): m_pin(new pin) {
+
+      m_pin->refs = 1;
+      m_pin->owner = reinterpret_cast<PyObject*>(o);
+      m_pin->data = reinterpret_cast<T*>(o->data);
+      m_pin->writeable = o->writeable;
+
+      // same storage as the array's own: blitz++ wants the lowest address in
+      // memory for dimensions with negative strides
+      T* first = reinterpret_cast<T*>(o->data);
+      blitz::TinyVector<bool,N> ascending;
+      blitz::TinyVector<int,N> ordering;
+      for (int i=0; i<N; ++i) {
+        m_pin->shape(i) = o->shape[i];
+        m_pin->stride(i) = o->stride[i] / Py_ssize_t(sizeof(T)); ///< from **bytes**
+        ascending(i) = o->stride[i] >= 0;
+        if (!ascending(i) && o->shape[i] > 0)
+          first += m_pin->stride(i) * (o->shape[i]-1);
+        ordering(i) = i;
+      }
+      // from the fastest to the slowest varying dimension
+      std::sort(ordering.data(), ordering.data()+N, by_stride(o->stride));
+      m_pin->first = first;
+      m_pin->storage = blitz::GeneralArrayStorage<N>(ordering, ascending);
+
+      Py_INCREF(m_pin->owner);
+      ++o->exports;
+
+    }
+
+    PyBlitzArrayCxx_Handle(const PyBlitzArrayCxx_Handle& other):
+      m_pin(other.m_pin) {
+      if (m_pin) m_pin->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    PyBlitzArrayCxx_Handle(PyBlitzArrayCxx_Handle&& other): m_pin(other.m_pin) {
+      other.m_pin = 0;
+    }
+
+    PyBlitzArrayCxx_Handle& operator= (PyBlitzArrayCxx_Handle other) {
+      std::swap(m_pin, other.m_pin);
+      return *this;
+    }
+
+    ~PyBlitzArrayCxx_Handle() { reset(); }
+
+    /**
+     * Releases this handle, which becomes empty
+     */
+    void reset() {
+      if (!m_pin) return;
+      if (m_pin->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        PyBlitzArray_DeferRelease(reinterpret_cast<PyBlitzArrayObject*>(m_pin->owner));
+        delete m_pin;
+      }
+      m_pin = 0;
+    }
+
+    explicit operator bool() const { return m_pin != 0; }
+
+    /**
+     * A new blitz::Array<T,N> on the memory of the array, which is never
+     * deleted by blitz++. Valid as long as this handle (or a copy) is alive.
+     *
+     * @throws std::runtime_error if the array is not writeable (e.g., a
+     * read-only file mapping, where writes would crash): use const_view()
+     */
+    blitz::Array<T,N> view() const {
+      if (!get().writeable)
+        throw std::runtime_error("cannot make a writeable view of a read-only array, use const_view() instead");
+      return make_view();
+    }
+
+    /**
+     * A read-only view on the memory of the array, for any array, including
+     * read-only ones. Valid as long as this handle (or a copy) is alive.
+     */
+    PyBlitzArrayCxx_ConstView<T,N> const_view() const {
+      return PyBlitzArrayCxx_ConstView<T,N>(make_view());
+    }
+
+    /**
+     * Address of the first element of the array
+     */
+    T* data() const {
+      return get().data;
+    }
+
+    const blitz::TinyVector<int,N>& shape() const { return get().shape; }
+
+    /**
+     * Strides of the array, in elements
+     */
+    const blitz::TinyVector<int,N>& stride() const {
+      return get().stride;
+    }
+
+    bool writeable() const { return get().writeable; }
+
+    /**
+     * The array this handle is on, as a borrowed reference. Requires the GIL.
+     */
+    PyBlitzArrayObject* object() const {
+      return reinterpret_cast<PyBlitzArrayObject*>(m_pin ? m_pin->owner : 0);
+    }
+
+  private:
+
+    blitz::Array<T,N> make_view() const {
+      const pin& p = get();
+      return blitz::Array<T,N>(p.first, p.shape, p.stride,
+          blitz::neverDeleteData, p.storage);
+    }
+
+    // N.B.: cannot use lambdas with very old versions of gcc
+    struct by_stride {
+      const Py_ssize_t* s;
+      by_stride(const Py_ssize_t* s): s(s) {}
+      bool operator() (int i1, int i2) const {
+        Py_ssize_t a1 = s[i1] < 0 ? -s[i1] : s[i1];
+        Py_ssize_t a2 = s[i2] < 0 ? -s[i2] : s[i2];
+        if (a1 != a2) return a1 < a2;
+        return i1 > i2;
+      }
+    };
+
+    struct pin {
+      std::atomic<long> refs;
+      PyObject* owner;
+      T* data;
+      T* first;
+      blitz::TinyVector<int,N> shape;
+      blitz::TinyVector<int,N> stride;
+      blitz::GeneralArrayStorage<N> storage;
+      bool writeable;
+    };
+
+    pin* m_pin;
+
+    // the accessors throw on empty (default-constructed, moved-from or
+    // reset) handles, rather than dereferencing a null pointer
+    const pin& get() const {
+      if (!m_pin)
+        throw std::runtime_error("cannot access the array of an empty handle");
+      return *m_pin;
+    }
+
+};
+
+/**
+ * Acquires a handle on the given array after checking it holds elements of
+ * type T and has N dimensions. Requires the GIL.
+ *
+ * @param array  The python blitz array object to acquire
+ * @param name   The name of the object; this will be used to set an appropriate error message in case of problems
+ * @return The handle, which is empty (and a Python error is set) in case of problems
+ */
+template<typename T, int N>
+PyBlitzArrayCxx_Handle<T,N> PyBlitzArrayCxx_AsHandle(PyBlitzArrayObject* array,
+    const char* name) {
+
+  constexpr int type_num = PyBlitzArrayCxx_CToTypenum<T>();
+  if (array->type_num != type_num || array->ndim != N) {
+    const char* type_num_name = PyBlitzArray_TypenumAsString(type_num);
+    PyErr_Format(PyExc_TypeError, "The parameter '%s' only supports %dD arrays of type '%s'", name, N, type_num_name);
+    return PyBlitzArrayCxx_Handle<T,N>();
+  }
+
+  try {
+    return PyBlitzArrayCxx_Handle<T,N>(array);
+  }
+  catch (std::bad_alloc&) {
+    PyErr_NoMemory();
+  }
+  return PyBlitzArrayCxx_Handle<T,N>();
+
+}
+
+/**
+ * Maps a file holding a C-ordered array of T's into a new bob.blitz.array,
+ * see PyBlitzArray_FromFile(). Returns a new reference or NULL on failure.
+ */
+template<typename T, int N>
+PyObject* PyBlitzArrayCxx_FromFile(const char* path,
+    const blitz::TinyVector<int,N>& shape, Py_ssize_t offset=0,
+    const char* mode="r", int advice=-1) {
+
+  Py_ssize_t c_shape[N];
+  for (int i=0; i<N; ++i) c_shape[i] = shape(i);
+
+  return PyBlitzArray_FromFile(path, PyBlitzArrayCxx_CToTypenum<T>(), N,
+      c_shape, offset, mode, advice);
+
+}
+
+/**
+ * Maps a .npy file into a new bob.blitz.array, checking it holds a
+ * blitz::Array<T,N>. Returns a new reference or NULL on failure.
+ */
+template<typename T, int N>
+PyObject* PyBlitzArrayCxx_FromNpyFile(const char* path, const char* mode="r",
+    int advice=-1) {
+
+  PyObject* retval = PyBlitzArray_FromNpyFile(path, mode, advice);
+  if (!retval) return 0;
+
+  PyBlitzArrayObject* array = reinterpret_cast<PyBlitzArrayObject*>(retval);
+  if (PyBlitzArrayCxx_AsBlitz<T,N>(array, path)) return retval;
+
+  Py_DECREF(retval);
+  return 0;
+
+}
+
 #endif /* BOB_BLITZ_CPP_API_H */
@@ -0,0 +1,62 @@
+/**
+ * @date Sat 17 Oct 2026
+ *
+ * @brief Functions shared between the translation units of the module,
+ * which are not part of its C-API
+ */
+
+#ifndef BOB_BLITZ_INTERNAL_H
+#define BOB_BLITZ_INTERNAL_H
+
+#include <bob.blitz/capi.h>
+
+#include <functional>
+
+/* Thread pool (threads.cpp) */
+
+/**
+ * Number of threads in the pool, and its resizing (0 for the default)
+ */
+int PyBlitzThreads_Get();
+void PyBlitzThreads_Set(int threads);
+
+/**
+ * Number of tiles to split an operation on `elements' elements of
+ * `itemsize' bytes into, 1 if not worth parallelizing
+ */
+Py_ssize_t PyBlitzThreads_Tiles(Py_ssize_t elements, size_t itemsize);
+
+/**
+ * Calls `work(tile, worker)' for all tiles, using up to `workers' threads
+ * (the calling thread included), and returns once all are done
+ */
+void PyBlitzThreads_Run(Py_ssize_t tiles, int workers,
+    const std::function<void(Py_ssize_t, int)>& work);
+
+/* Arrays (api.cpp) */
+
+/**
+ * Stops the data of `o', and of the arrays it is a view of, from being
+ * released by PyBlitzArray_SimpleInit() while it is used without the GIL.
+ * Both require the GIL.
+ */
+void PyBlitzArray_PinData(PyBlitzArrayObject* o);
+void PyBlitzArray_UnpinData(PyBlitzArrayObject* o);
+
+/* Statistics (stats.cpp), see PyBlitzArray_GetStats() */
+
+void PyBlitzStats_Created();
+void PyBlitzStats_Allocated(size_t bytes);
+void PyBlitzStats_Released(size_t bytes);
+void PyBlitzStats_Copied(int reason, size_t bytes);
+void PyBlitzStats_Cast(size_t bytes);
+void PyBlitzStats_Wrapped();
+
+/**
+ * The statistics as a dictionary, and the recording of the tracebacks of
+ * copies of at least `threshold' bytes (none if negative), for the bindings
+ */
+PyObject* PyBlitzStats_AsDict();
+int PyBlitzStats_TraceCopies(Py_ssize_t threshold);
+
+#endif /* BOB_BLITZ_INTERNAL_H */
@@ -0,0 +1,161 @@
+/**
+ * @date Fri 16 Oct 2026
+ *
+ * @brief Iteration over the first dimension of bob.blitz.array's
+ */
+
+#define BOB_BLITZ_MODULE
+#include <bob.blitz/capi.h>
+#include <bob.blitz/cleanup.h>
+#include <bob.extension/documentation.h>
+
+#include <algorithm>
+
+/**
+ * Iterator over the first dimension of an array, yielding one or several
+ * rows at a time
+ */
+typedef struct {
+  PyObject_HEAD
+  PyBlitzArrayObject* array; ///< array iterated on, 0 when exhausted
+  Py_ssize_t position; ///< next row to yield
+  Py_ssize_t rows; ///< number of rows per block, or 0 to yield single rows
+} PyBlitzArrayIteratorObject;
+
+static PyTypeObject PyBlitzArrayIterator_Type = {
+    PyVarObject_HEAD_INIT(0, 0)
+    0
+};
+
+static void PyBlitzArrayIterator_Delete(PyBlitzArrayIteratorObject* self) {
+  Py_XDECREF(self->array);
+  Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+/**
+ * Returns a view on `rows' rows of `a', starting at `start'. If `drop' is
+ * set, returns a view on the single row at `start', without the first
+ * dimension.
+ */
+static PyObject* rows_view(PyBlitzArrayObject* a, Py_ssize_t start,
+    Py_ssize_t rows, bool drop) {
+
+  Py_ssize_t shape[BOB_BLITZ_MAXDIMS];
+  Py_ssize_t stride[BOB_BLITZ_MAXDIMS];
+  Py_ssize_t ndim = 0;
+
+  if (!drop) {
+    shape[ndim] = rows;
+    stride[ndim] = a->stride[0];
+    ++ndim;
+  }
+  for (Py_ssize_t i=1; i<a->ndim; ++i, ++ndim) {
+    shape[ndim] = a->shape[i];
+    stride[ndim] = a->stride[i];
+  }
+
+  char* data = reinterpret_cast<char*>(a->data) + start * a->stride[0];
+  PyObject* retval = PyBlitzArray_SimpleNewFromData(a->type_num, ndim, shape,
+      stride, data, a->writeable);
+  if (!retval) return 0;
+
+  reinterpret_cast<PyBlitzArrayObject*>(retval)->base = reinterpret_cast<PyObject*>(a);
+  Py_INCREF(a);
+  a->viewed = 1;
+  return retval;
+
+}
+
+static PyObject* PyBlitzArrayIterator_next(PyBlitzArrayIteratorObject* self) {
+
+  PyBlitzArrayObject* a = self->array;
+  if (!a) return 0;
+
+  // the array may have been re-initialized in the meanwhile
+  if (self->position >= a->shape[0]) {
+    Py_CLEAR(self->array);
+    return 0;
+  }
+
+  Py_ssize_t start = self->position;
+
+  if (!self->rows) {
+    ++self->position;
+    if (a->ndim == 1) return PyBlitzArray_GetItem(a, &start);
+    return rows_view(a, start, 1, true);
+  }
+
+  Py_ssize_t rows = std::min(self->rows, a->shape[0] - start);
+  self->position += rows;
+  return rows_view(a, start, rows, false);
+
+}
+
+static PyObject* PyBlitzArrayIterator_length_hint(PyBlitzArrayIteratorObject* self) {
+
+  Py_ssize_t remaining = 0;
+  if (self->array && self->position < self->array->shape[0]) {
+    remaining = self->array->shape[0] - self->position;
+    if (self->rows) remaining = (remaining + self->rows - 1) / self->rows;
+  }
+  return Py_BuildValue("n", remaining);
+
+}
+
+static PyMethodDef PyBlitzArrayIterator_methods[] = {
+    {
+      "__length_hint__",
+      (PyCFunction)PyBlitzArrayIterator_length_hint,
+      METH_NOARGS,
+      "Number of items left to iterate on"
+    },
+    {0}  /* Sentinel */
+};
+
+/**
+ * Creates a new iterator over `a', yielding single rows (if `rows' is 0) or
+ * blocks of `rows' rows
+ */
+static PyObject* iterator_new(PyBlitzArrayObject* a, Py_ssize_t rows) {
+
+  PyBlitzArrayIteratorObject* retval = PyObject_New(PyBlitzArrayIteratorObject, &PyBlitzArrayIterator_Type);
+  if (!retval) return 0;
+
+  retval->array = a;
+  Py_INCREF(a);
+  retval->position = 0;
+  retval->rows = rows;
+  return reinterpret_cast<PyObject*>(retval);
+
+}
+
+PyObject* PyBlitzArray_Iter(PyBlitzArrayObject* a) {
+  return iterator_new(a, 0);
+}
+
+PyObject* PyBlitzArray_Chunks(PyBlitzArrayObject* a, Py_ssize_t rows) {
+
+  if (rows < 1) {
+    PyErr_Format(PyExc_ValueError, "chunks of %s(@%" PY_FORMAT_SIZE_T "d,'%s') should have at least one row, not %" PY_FORMAT_SIZE_T "d", Py_TYPE(a)->tp_name, a->ndim, PyBlitzArray_TypenumAsString(a->type_num), rows);
+    return 0;
+  }
+
+  return iterator_new(a, rows);
+
+}
+
+bool init_ArrayIterator() {
+
+  PyBlitzArrayIterator_Type.tp_name = BOB_EXT_MODULE_PREFIX ".array_iterator";
+  PyBlitzArrayIterator_Type.tp_basicsize = sizeof(PyBlitzArrayIteratorObject);
+  PyBlitzArrayIterator_Type.tp_flags = Py_TPFLAGS_DEFAULT;
+  PyBlitzArrayIterator_Type.tp_doc = "Iterator over the first dimension of a " BOB_EXT_MODULE_PREFIX ".array";
+  PyBlitzArrayIterator_Type.tp_dealloc = reinterpret_cast<destructor>(PyBlitzArrayIterator_Delete);
+  PyBlitzArrayIterator_Type.tp_iter = PyObject_SelfIter;
+  PyBlitzArrayIterator_Type.tp_iternext = reinterpret_cast<iternextfunc>(PyBlitzArrayIterator_next);
+  PyBlitzArrayIterator_Type.tp_methods = PyBlitzArrayIterator_methods;
+
+  // check that everyting is fine
+  return PyType_Ready(&PyBlitzArrayIterator_Type) >= 0;
+
+}
@@ -12,8 +12,18 @@
 #include <bob.blitz/capi.h>
 #include <bob.blitz/cleanup.h>
 #include <bob.extension/documentation.h>
+#include "internal.h"
 
 extern bool init_BlitzArray(PyObject* module);
+extern bool init_SharedMemory(PyObject* module);
+extern bool init_ArrayIterator();
+extern bool init_BlitzExpr(PyObject* module);
+extern bool init_Reductions(PyObject* module);
+extern bool init_Threads();
+extern bool init_Casts();
+extern void PyBlitzArray_SetHugepageThreshold(size_t threshold);
+extern void PyBlitzArray_SetCacheLimit(size_t limit);
+extern PyObject* PyBlitzArray_CacheStats();
 
 auto as_blitz = bob::extension::FunctionDoc(
   "as_blitz",
@@ -41,6 +51,293 @@ static PyObject* PyBlitzArray_as_blitz(PyObject*, PyObject* args, PyObject* kwds
 
 }
 
+auto set_allocator = bob::extension::FunctionDoc(
+  "set_allocator",
+  "Selects how the data of newly created :py:class:`" BOB_EXT_MODULE_PREFIX ".array`'s is allocated",
+  "The following policies are available:\n\n"
+  "* ``'blitz'`` (default): Blitz++ allocates (and owns) the data itself\n"
+  "* ``'malloc'``: plain ``malloc()``\n"
+  "* ``'aligned64'``: memory is aligned to 64 bytes, suitable for the widest vector loads\n"
+  "* ``'hugepage'``: like ``'aligned64'``, but blocks of at least ``threshold`` bytes are aligned to 2 MiB and advised for transparent huge pages (on platforms supporting it)\n\n"
+  "The policy only affects arrays created after this call. "
+  "Third-party allocators can be installed from C/C++ using :c:func:`PyBlitzArray_SetAllocator`."
+)
+.add_prototype("name, [threshold]", "None")
+.add_parameter("name", "str", "The name of the allocation policy")
+.add_parameter("threshold", "int", "[Default: ``4194304``] For the ``'hugepage'`` policy only: the minimum block size, in bytes, to use huge pages for")
+;
+
+static PyObject* PyBlitzArray_set_allocator(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"name", "threshold", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  const char* name = 0;
+  Py_ssize_t threshold = -1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|n", kwlist, &name, &threshold)) return 0;
+
+  const PyBlitzArrayAllocator* allocator = PyBlitzArray_AllocatorByName(name);
+  if (!allocator) return 0;
+
+  if (threshold >= 0) {
+    if (allocator->ctx == 0) {
+      PyErr_Format(PyExc_ValueError, "data allocator `%s' does not take a threshold", name);
+      return 0;
+    }
+    PyBlitzArray_SetHugepageThreshold(threshold);
+  }
+
+  if (PyBlitzArray_SetAllocator(allocator) != 0) return 0;
+
+  Py_RETURN_NONE;
+
+}
+
+auto get_allocator = bob::extension::FunctionDoc(
+  "get_allocator",
+  "Returns the name of the allocation policy currently used for the data of new :py:class:`" BOB_EXT_MODULE_PREFIX ".array`'s",
+  "See :py:func:`set_allocator` for details."
+)
+.add_prototype("", "name")
+.add_return("name", "str", "The name of the active allocation policy")
+;
+
+static PyObject* PyBlitzArray_get_allocator(PyObject*) {
+  return Py_BuildValue("s", PyBlitzArray_GetAllocator()->name);
+}
+
+auto set_cache_limit = bob::extension::FunctionDoc(
+  "set_cache_limit",
+  "Sets the maximum number of bytes kept by the recycling cache of array data",
+  "When the limit is not zero, the data of arrays released is kept (rounded up to a size class) instead of being returned to the allocator, so that new arrays of similar size can reuse it without going back to the system. "
+  "This helps when arrays of the same shape and type are created and destroyed repeatedly, e.g. once per video frame. "
+  "Each thread keeps a few blocks for itself before sharing them with others. "
+  "Only data allocated through a policy other than ``'blitz'`` is cached (see :py:func:`set_allocator`). "
+  "Setting the limit to ``0`` (the default) disables the cache and releases all blocks kept by it."
+)
+.add_prototype("limit", "None")
+.add_parameter("limit", "int", "The maximum number of bytes to keep cached")
+;
+
+static PyObject* PyBlitzArray_set_cache_limit(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"limit", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  Py_ssize_t limit = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "n", kwlist, &limit)) return 0;
+
+  if (limit < 0) {
+    PyErr_Format(PyExc_ValueError, "cache limit should be zero or positive, not %" PY_FORMAT_SIZE_T "d", limit);
+    return 0;
+  }
+
+  PyBlitzArray_SetCacheLimit(limit);
+
+  Py_RETURN_NONE;
+
+}
+
+auto cache_stats = bob::extension::FunctionDoc(
+  "cache_stats",
+  "Reports on the use of the recycling cache of array data",
+  "See :py:func:`set_cache_limit` for details. "
+  "The returned dictionary contains the number of allocations served from the cache (``hits``) and not (``misses``), the number of released blocks that could not be kept because of the limit (``dropped``), the number of bytes currently kept (``bytes``) and the limit itself (``limit``)."
+)
+.add_prototype("", "stats")
+.add_return("stats", "dict", "The cache statistics")
+;
+
+static PyObject* PyBlitzArray_cache_stats(PyObject*) {
+  return PyBlitzArray_CacheStats();
+}
+
+auto stats = bob::extension::FunctionDoc(
+  "stats",
+  "Reports on the arrays created and the data they allocated and copied",
+  "Counters are always on and start when the module is loaded. "
+  "The returned dictionary contains the number of :py:class:`array`'s created (``arrays``), the bytes of data allocated for them (``bytes_allocated``) and still held by those alive (``live_bytes``), "
+  "the number of copies of converted inputs (``copies``, a dictionary by reason: ``non_contiguous``, ``misaligned`` or ``dtype``, for a non-native byte order) and the bytes copied (``bytes_copied``), "
+  "the number of type conversions (``casts``, see :py:meth:`array.cast`, including those of operands of arithmetic operations) and the bytes they wrote (``bytes_cast``), "
+  "the number of :py:class:`numpy.ndarray` wraps of new arrays (``numpy_wraps``) and the tracebacks recorded since the last call to :py:func:`trace_copies` (``traces``)."
+)
+.add_prototype("", "stats")
+.add_return("stats", "dict", "The counters")
+;
+
+static PyObject* PyBlitzArray_stats(PyObject*) {
+  return PyBlitzStats_AsDict();
+}
+
+auto trace_copies = bob::extension::FunctionDoc(
+  "trace_copies",
+  "Records where large copies and casts happen",
+  "Once set, each copy of a converted input and each cast of at least ``threshold`` bytes records a dictionary with its ``reason``, its size in ``bytes`` and the Python ``traceback`` (a list of strings, as from :py:func:`traceback.format_stack`) leading to it. "
+  "Only the latest 100 records are kept, and returned by :py:func:`stats`. "
+  "Setting a threshold discards previous records, a negative one stops recording."
+)
+.add_prototype("threshold", "None")
+.add_parameter("threshold", "int", "The minimum size of the copies to record, in bytes")
+;
+
+static PyObject* PyBlitzArray_trace_copies(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"threshold", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  Py_ssize_t threshold = -1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "n", kwlist, &threshold)) return 0;
+
+  if (PyBlitzStats_TraceCopies(threshold) < 0) return 0;
+
+  Py_RETURN_NONE;
+
+}
+
+auto set_num_threads = bob::extension::FunctionDoc(
+  "set_num_threads",
+  "Sets the number of threads used to process large arrays",
+  "Element-wise arithmetic and comparisons, assignments, lazy expressions (see :py:class:`expr`) and reductions on arrays of more than 256 KiB are split into tiles of 64 KiB, processed in parallel by a pool of threads, without holding the Python global interpreter lock. "
+  "Smaller arrays are always processed by the calling thread. "
+  "Results do not depend on the number of threads. "
+  "By default, as many threads as processors are used. "
+  "Setting the number to ``1`` disables the pool, and ``0`` restores the default."
+)
+.add_prototype("n", "None")
+.add_parameter("n", "int", "The number of threads, including the calling one")
+;
+
+static PyObject* PyBlitzArray_set_num_threads(PyObject*, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  static const char* const_kwlist[] = {"n", 0};
+  static char** kwlist = const_cast<char**>(const_kwlist);
+
+  int n = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "i", kwlist, &n)) return 0;
+
+  if (n < 0) {
+    PyErr_Format(PyExc_ValueError, "number of threads should be zero or positive, not %d", n);
+    return 0;
+  }
+
+  PyBlitzThreads_Set(n);
+
+  Py_RETURN_NONE;
+
+}
+
+auto get_num_threads = bob::extension::FunctionDoc(
+  "get_num_threads",
+  "Returns the number of threads used to process large arrays",
+  "See :py:func:`set_num_threads` for details."
+)
+.add_prototype("", "n")
+.add_return("n", "int", "The number of threads, including the calling one")
+;
+
+static PyObject* PyBlitzArray_get_num_threads(PyObject*) {
+  return Py_BuildValue("i", PyBlitzThreads_Get());
+}
+
+auto _reconstruct = bob::extension::FunctionDoc(
+  "_reconstruct",
+  "Re-creates a pickled :py:class:`" BOB_EXT_MODULE_PREFIX ".array` (internal)",
+  "Whenever possible, the new array points directly to the memory of ``buffer``, which is kept alive as its :py:attr:`" BOB_EXT_MODULE_PREFIX ".array.base`. "
+  "A copy is made if the memory is not suitably aligned, or if it comes from a (read-only) bytes object while the original array was writeable."
+)
+.add_prototype("buffer, dtype, shape, order, writeable", "array")
+.add_parameter("buffer", "object", "An object exporting the array memory through the buffer protocol")
+.add_parameter("dtype", ":py:class:`numpy.dtype`", "The data type of the elements")
+.add_parameter("shape", "tuple", "The shape of the array")
+.add_parameter("order", "str", "``'C'`` or ``'F'``, the storage order of the elements in ``buffer``")
+.add_parameter("writeable", "bool", "If the pickled array was writeable")
+.add_return("array", ":py:class:`" BOB_EXT_MODULE_PREFIX ".array`", "The reconstructed array")
+;
+
+static PyObject* PyBlitzArray_reconstruct(PyObject*, PyObject* args) {
+
+  PyObject* buffer = 0;
+  int type_num = NPY_NOTYPE;
+  PyBlitzArrayObject shape;
+  PyBlitzArrayObject* shape_p = &shape;
+  const char* order = 0;
+  PyObject* writeable_obj = 0;
+
+  if (!PyArg_ParseTuple(args, "OO&O&sO", &buffer,
+        &PyBlitzArray_TypenumConverter, &type_num,
+        &PyBlitzArray_IndexConverter, &shape_p,
+        &order, &writeable_obj)) return 0;
+
+  if ((order[0] != 'C' && order[0] != 'F') || order[1]) {
+    PyErr_Format(PyExc_ValueError, "storage order should be either `C' or `F', not `%s'", order);
+    return 0;
+  }
+
+  const int writeable = PyObject_IsTrue(writeable_obj);
+  if (writeable < 0) return 0;
+
+  PyObject* memory = PyMemoryView_FromObject(buffer);
+  if (!memory) return 0;
+  auto memory_ = make_safe(memory);
+  Py_buffer* view = PyMemoryView_GET_BUFFER(memory);
+
+  const Py_ssize_t itemsize = PyBlitzArray_TypenumSize(type_num);
+  Py_ssize_t stride[BOB_BLITZ_MAXDIMS];
+  Py_ssize_t nbytes = itemsize;
+  for (Py_ssize_t k=0; k<shape.ndim; ++k) {
+    Py_ssize_t i = (order[0] == 'F') ? k : shape.ndim - 1 - k;
+    stride[i] = nbytes;
+    nbytes *= shape.shape[i];
+  }
+
+  if (view->len != nbytes) {
+    PyErr_Format(PyExc_ValueError, "cannot reconstruct %s with %" PY_FORMAT_SIZE_T "d bytes from a buffer of %" PY_FORMAT_SIZE_T "d bytes", PyBlitzArray_Type.tp_name, nbytes, view->len);
+    return 0;
+  }
+
+  Py_ssize_t alignment = PyTypeNum_ISCOMPLEX(type_num) ? itemsize/2 : itemsize;
+  if (alignment > 16) alignment = 16;
+  const bool aligned = (reinterpret_cast<size_t>(view->buf) % alignment) == 0;
+
+  if (aligned && !(writeable && view->readonly && PyBytes_Check(buffer))) {
+    PyObject* retval = PyBlitzArray_SimpleNewFromData(type_num, shape.ndim,
+        shape.shape, stride, view->buf, !view->readonly);
+    if (!retval) return 0;
+    reinterpret_cast<PyBlitzArrayObject*>(retval)->base = memory;
+    Py_INCREF(memory); ///< the memoryview keeps the buffer alive
+    return retval;
+  }
+
+  // copies the contents into a freshly allocated array
+  PyObject* retval = PyBlitzArray_SimpleNew(type_num, shape.ndim, shape.shape);
+  if (!retval) return 0;
+  auto retval_ = make_safe(retval);
+
+  npy_intp dims[BOB_BLITZ_MAXDIMS];
+  npy_intp strides[BOB_BLITZ_MAXDIMS];
+  for (Py_ssize_t i=0; i<shape.ndim; ++i) {
+    dims[i] = shape.shape[i];
+    strides[i] = stride[i];
+  }
+  PyObject* src = PyArray_New(&PyArray_Type, shape.ndim, dims, type_num,
+      strides, view->buf, 0, 0, 0);
+  if (!src) return 0;
+  auto src_ = make_safe(src);
+
+  PyObject* dst = PyBlitzArray_AsNumpyArray(reinterpret_cast<PyBlitzArrayObject*>(retval), 0);
+  if (!dst) return 0;
+  auto dst_ = make_safe(dst);
+
+  if (PyArray_CopyInto(reinterpret_cast<PyArrayObject*>(dst), reinterpret_cast<PyArrayObject*>(src)) != 0) return 0;
+
+  return Py_BuildValue("O", retval);
+
+}
+
 static PyMethodDef module_methods[] = {
     {
       as_blitz.name(),
@@ -48,6 +345,60 @@ static PyMethodDef module_methods[] = {
       METH_VARARGS|METH_KEYWORDS,
       as_blitz.doc()
     },
+    {
+      set_allocator.name(),
+      (PyCFunction)PyBlitzArray_set_allocator,
+      METH_VARARGS|METH_KEYWORDS,
+      set_allocator.doc()
+    },
+    {
+      get_allocator.name(),
+      (PyCFunction)PyBlitzArray_get_allocator,
+      METH_NOARGS,
+      get_allocator.doc()
+    },
+    {
+      set_cache_limit.name(),
+      (PyCFunction)PyBlitzArray_set_cache_limit,
+      METH_VARARGS|METH_KEYWORDS,
+      set_cache_limit.doc()
+    },
+    {
+      cache_stats.name(),
+      (PyCFunction)PyBlitzArray_cache_stats,
+      METH_NOARGS,
+      cache_stats.doc()
+    },
+    {
+      stats.name(),
+      (PyCFunction)PyBlitzArray_stats,
+      METH_NOARGS,
+      stats.doc()
+    },
+    {
+      trace_copies.name(),
+      (PyCFunction)PyBlitzArray_trace_copies,
+      METH_VARARGS|METH_KEYWORDS,
+      trace_copies.doc()
+    },
+    {
+      set_num_threads.name(),
+      (PyCFunction)PyBlitzArray_set_num_threads,
+      METH_VARARGS|METH_KEYWORDS,
+      set_num_threads.doc()
+    },
+    {
+      get_num_threads.name(),
+      (PyCFunction)PyBlitzArray_get_num_threads,
+      METH_NOARGS,
+      get_num_threads.doc()
+    },
+    {
+      _reconstruct.name(),
+      (PyCFunction)PyBlitzArray_reconstruct,
+      METH_VARARGS,
+      _reconstruct.doc()
+    },
     {0}  /* Sentinel */
 };
 
@@ -80,6 +431,15 @@ static PyObject* create_module (void) {
 
   /* register the type object to python */
   if (!init_BlitzArray(m)) return NULL;
+  if (!init_SharedMemory(m)) return NULL;
+  if (!init_ArrayIterator()) return NULL;
+  if (!init_BlitzExpr(m)) return NULL;
+  if (!init_Reductions(m)) return NULL;
+  if (!init_Threads()) return NULL;
+  if (!init_Casts()) return NULL;
+
+  /* domain of the data of arrays in tracemalloc snapshots */
+  if (PyModule_AddIntConstant(m, "tracemalloc_domain", BOB_BLITZ_TRACEMALLOC_DOMAIN) < 0) return NULL;
 
   static void* PyBlitzArray_API[PyBlitzArray_API_pointers];
 
@@ -130,6 +490,44 @@ static PyObject* create_module (void) {
   PyBlitzArray_API[PyBlitzArray_TypenumSize_NUM] = (void *)PyBlitzArray_TypenumSize;
   PyBlitzArray_API[PyBlitzArray_Cast_NUM] = (void *)PyBlitzArray_Cast;
 
+  // Data Allocators
+  PyBlitzArray_API[PyBlitzArray_SetAllocator_NUM] = (void *)PyBlitzArray_SetAllocator;
+  PyBlitzArray_API[PyBlitzArray_GetAllocator_NUM] = (void *)PyBlitzArray_GetAllocator;
+  PyBlitzArray_API[PyBlitzArray_AllocatorByName_NUM] = (void *)PyBlitzArray_AllocatorByName;
+
+  // Memory-mapped Files
+  PyBlitzArray_API[PyBlitzArray_FromFile_NUM] = (void *)PyBlitzArray_FromFile;
+  PyBlitzArray_API[PyBlitzArray_FromNpyFile_NUM] = (void *)PyBlitzArray_FromNpyFile;
+
+  // Shared Memory
+  PyBlitzArray_API[PyBlitzArray_SharedNew_NUM] = (void *)PyBlitzArray_SharedNew;
+  PyBlitzArray_API[PyBlitzArray_SharedAttach_NUM] = (void *)PyBlitzArray_SharedAttach;
+
+  // Slicing
+  PyBlitzArray_API[PyBlitzArray_GetSubscript_NUM] = (void *)PyBlitzArray_GetSubscript;
+  PyBlitzArray_API[PyBlitzArray_SetSubscript_NUM] = (void *)PyBlitzArray_SetSubscript;
+
+  // Bulk Element Access
+  PyBlitzArray_API[PyBlitzArray_Take_NUM] = (void *)PyBlitzArray_Take;
+  PyBlitzArray_API[PyBlitzArray_Put_NUM] = (void *)PyBlitzArray_Put;
+
+  // Reductions
+  PyBlitzArray_API[PyBlitzArray_Reduce_NUM] = (void *)PyBlitzArray_Reduce;
+  PyBlitzArray_API[PyBlitzArray_Dot_NUM] = (void *)PyBlitzArray_Dot;
+
+  // Casts
+  PyBlitzArray_API[PyBlitzArray_CastInto_NUM] = (void *)PyBlitzArray_CastInto;
+  PyBlitzArray_API[PyBlitzArray_CastMode_NUM] = (void *)PyBlitzArray_CastMode;
+  PyBlitzArray_API[PyBlitzArray_CastIntoMode_NUM] = (void *)PyBlitzArray_CastIntoMode;
+  PyBlitzArray_API[PyBlitzArray_CastModeConverter_NUM] = (void *)PyBlitzArray_CastModeConverter;
+
+  // Threads
+  PyBlitzArray_API[PyBlitzArray_DeferDecRef_NUM] = (void *)PyBlitzArray_DeferDecRef;
+  PyBlitzArray_API[PyBlitzArray_DeferRelease_NUM] = (void *)PyBlitzArray_DeferRelease;
+
+  // Statistics
+  PyBlitzArray_API[PyBlitzArray_GetStats_NUM] = (void *)PyBlitzArray_GetStats;
+
 #if PY_VERSION_HEX >= 0x02070000
 
   /* defines the PyCapsule */
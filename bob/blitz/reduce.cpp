@@ -0,0 +1,814 @@
+/**
+ * @date Fri 16 Oct 2026
+ *
+ * @brief Full-array reductions (sum, minimum, maximum, mean, norm and dot
+ * product) of bob.blitz.array's
+ */
+
+#define BOB_BLITZ_MODULE
+#include <bob.blitz/capi.h>
+#include <bob.blitz/cppapi.h>
+#include <bob.blitz/cleanup.h>
+#include "internal.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/***********************
+ * Accumulation Traits *
+ ***********************/
+
+/**
+ * Types in which reductions of arrays with elements of type T are carried
+ * out, following numpy: integer sums and dot products wrap around in 64 bits
+ * (accumulated unsigned, so overflows are well defined), means and norms of
+ * integers are computed in double precision and floating-point reductions
+ * stay in the type of the array.
+ */
+template <typename T, bool integral = std::is_integral<T>::value>
+struct reduce_traits {
+  typedef T sum_type; ///< accumulator of sums and dot products
+  typedef T mean_type; ///< accumulator (and result) of means
+  typedef T norm_type; ///< accumulator (and result) of norms
+  typedef std::false_type is_complex;
+  static constexpr int sum_type_num = PyBlitzArrayCxx_CToTypenum<T>();
+};
+
+template <typename T>
+struct reduce_traits<std::complex<T>, false> {
+  typedef std::complex<T> sum_type;
+  typedef std::complex<T> mean_type;
+  typedef T norm_type;
+  typedef std::true_type is_complex;
+  static constexpr int sum_type_num = PyBlitzArrayCxx_CToTypenum<std::complex<T>>();
+};
+
+template <typename T>
+struct reduce_traits<T, true> {
+  typedef npy_uint64 sum_type;
+  typedef double mean_type;
+  typedef double norm_type;
+  typedef std::false_type is_complex;
+  static constexpr int sum_type_num = (std::is_unsigned<T>::value && !std::is_same<T,bool>::value) ? NPY_UINT64 : NPY_INT64;
+};
+
+template <typename A, typename T> inline A reduce_square(T x) {
+  return A(x) * A(x);
+}
+
+template <typename A, typename T> inline A reduce_square(std::complex<T> x) {
+  return A(x.real()) * A(x.real()) + A(x.imag()) * A(x.imag());
+}
+
+template <typename A, typename T> inline A reduce_product(T x, T y) {
+  return A(x) * A(y);
+}
+
+/**
+ * Plain complex products, without the C99 special-casing of infinities that
+ * std::complex applies (and which prevents vectorization)
+ */
+template <typename A, typename T> inline A reduce_product(std::complex<T> x, std::complex<T> y) {
+  return A(x.real()*y.real() - x.imag()*y.imag(), x.real()*y.imag() + x.imag()*y.real());
+}
+
+template <typename T> inline bool reduce_isnan(T x) { return x != x; }
+template <typename T> inline bool reduce_isnan(std::complex<T>) { return false; }
+
+/***********
+ * Kernels *
+ ***********/
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define BOB_BLITZ_REDUCE_DISPATCH 1
+#  define BOB_BLITZ_REDUCE_INLINE inline __attribute__((always_inline))
+#else
+#  define BOB_BLITZ_REDUCE_INLINE inline
+#endif
+
+/**
+ * Number of independent partial results kept by each kernel. They map to
+ * vector registers, whose width depends on the instruction set the kernels
+ * are compiled for, but the number of lanes is fixed so that results do not
+ * depend on the CPU the code runs on.
+ */
+static const Py_ssize_t REDUCE_LANES = 8;
+
+/**
+ * Number of elements summed in lanes before pairwise summation takes over,
+ * as numpy does
+ */
+static const Py_ssize_t REDUCE_BLOCK = 128;
+
+/**
+ * Pairwise summation of a stream of partial sums: partials of equal weight
+ * are added together as soon as possible (as the digits of a binary counter),
+ * so the rounding error grows with the logarithm of the number of elements
+ * instead of linearly
+ */
+template <typename A>
+class pairwise_accumulator {
+
+  public:
+
+    pairwise_accumulator(): m_count(0), m_top(0) {}
+
+    void push(A x) {
+      for (npy_uint64 c = m_count++; c & 1; c >>= 1) x = m_partial[--m_top] + x;
+      m_partial[m_top++] = x;
+    }
+
+    A total() const {
+      A acc = A();
+      for (int i=m_top-1; i>=0; --i) acc = m_partial[i] + acc;
+      return acc;
+    }
+
+  private:
+
+    npy_uint64 m_count;
+    int m_top;
+    A m_partial[64];
+
+};
+
+/**
+ * Sums term(0), ..., term(n-1), for n <= REDUCE_BLOCK, in REDUCE_LANES lanes
+ */
+template <typename A, typename F>
+static BOB_BLITZ_REDUCE_INLINE A block_sum(Py_ssize_t n, F term) {
+
+  if (n < REDUCE_LANES) {
+    A acc = A();
+    for (Py_ssize_t i=0; i<n; ++i) acc += term(i);
+    return acc;
+  }
+
+  A lane[REDUCE_LANES];
+  for (Py_ssize_t j=0; j<REDUCE_LANES; ++j) lane[j] = term(j);
+
+  Py_ssize_t i = REDUCE_LANES;
+  for (; i + REDUCE_LANES <= n; i += REDUCE_LANES)
+    for (Py_ssize_t j=0; j<REDUCE_LANES; ++j) lane[j] += term(i + j);
+
+  A acc = ((lane[0] + lane[1]) + (lane[2] + lane[3])) +
+    ((lane[4] + lane[5]) + (lane[6] + lane[7]));
+  for (; i<n; ++i) acc += term(i);
+  return acc;
+
+}
+
+template <typename A, typename F>
+static BOB_BLITZ_REDUCE_INLINE void pairwise_sum(pairwise_accumulator<A>& acc,
+    Py_ssize_t n, F term) {
+  for (Py_ssize_t i=0; i<n; i+=REDUCE_BLOCK)
+    acc.push(block_sum<A>(std::min(REDUCE_BLOCK, n - i),
+          [&](Py_ssize_t k) { return term(i + k); }));
+}
+
+/**
+ * Kernels over `n' elements, `s' elements apart: the contiguous case is
+ * written separately so that it is vectorized
+ */
+template <typename A, typename T>
+static BOB_BLITZ_REDUCE_INLINE void sum_row(pairwise_accumulator<A>& acc,
+    const T* x, Py_ssize_t n, Py_ssize_t s) {
+  if (s == 1) pairwise_sum(acc, n, [x](Py_ssize_t i) { return A(x[i]); });
+  else pairwise_sum(acc, n, [x,s](Py_ssize_t i) { return A(x[i*s]); });
+}
+
+template <typename A, typename T>
+static BOB_BLITZ_REDUCE_INLINE void sumsq_row(pairwise_accumulator<A>& acc,
+    const T* x, Py_ssize_t n, Py_ssize_t s) {
+  if (s == 1) pairwise_sum(acc, n, [x](Py_ssize_t i) { return reduce_square<A>(x[i]); });
+  else pairwise_sum(acc, n, [x,s](Py_ssize_t i) { return reduce_square<A>(x[i*s]); });
+}
+
+template <typename A, typename T>
+static BOB_BLITZ_REDUCE_INLINE void dot_row(pairwise_accumulator<A>& acc,
+    const T* x, Py_ssize_t sx, const T* y, Py_ssize_t sy, Py_ssize_t n) {
+  if (sx == 1 && sy == 1) pairwise_sum(acc, n, [x,y](Py_ssize_t i) { return reduce_product<A>(x[i], y[i]); });
+  else pairwise_sum(acc, n, [x,sx,y,sy](Py_ssize_t i) { return reduce_product<A>(x[i*sx], y[i*sy]); });
+}
+
+/**
+ * Updates `value' with the minimum (or maximum) of `n' elements. NaNs are
+ * tracked on the side, so that the comparisons stay vectorizable, and
+ * propagate to the result, as in numpy.
+ */
+template <bool maximum, typename T, typename F>
+static BOB_BLITZ_REDUCE_INLINE void extremum(T& value, Py_ssize_t n, F element) {
+
+  T lane[REDUCE_LANES];
+  bool nan[REDUCE_LANES];
+  for (Py_ssize_t j=0; j<REDUCE_LANES; ++j) {
+    lane[j] = value;
+    nan[j] = false;
+  }
+
+  Py_ssize_t i = 0;
+  for (; i + REDUCE_LANES <= n; i += REDUCE_LANES)
+    for (Py_ssize_t j=0; j<REDUCE_LANES; ++j) {
+      const T x = element(i + j);
+      lane[j] = (maximum ? lane[j] < x : x < lane[j]) ? x : lane[j];
+      nan[j] |= reduce_isnan(x);
+    }
+  for (; i<n; ++i) {
+    const T x = element(i);
+    lane[0] = (maximum ? lane[0] < x : x < lane[0]) ? x : lane[0];
+    nan[0] |= reduce_isnan(x);
+  }
+
+  for (Py_ssize_t j=0; j<REDUCE_LANES; ++j) {
+    if (nan[j]) value = std::numeric_limits<T>::quiet_NaN();
+    if (reduce_isnan(value)) return;
+    value = (maximum ? value < lane[j] : lane[j] < value) ? lane[j] : value;
+  }
+
+}
+
+template <bool maximum, typename T>
+static BOB_BLITZ_REDUCE_INLINE void extremum_row(T& value, const T* x,
+    Py_ssize_t n, Py_ssize_t s, std::false_type /*complex*/) {
+  if (s == 1) extremum<maximum>(value, n, [x](Py_ssize_t i) { return x[i]; });
+  else extremum<maximum>(value, n, [x,s](Py_ssize_t i) { return x[i*s]; });
+}
+
+/**
+ * Complex numbers are not ordered: never called
+ */
+template <bool maximum, typename T>
+static BOB_BLITZ_REDUCE_INLINE void extremum_row(T&, const T*, Py_ssize_t,
+    Py_ssize_t, std::true_type /*complex*/) {
+}
+
+/**
+ * The kernels used for arrays of type T, for a given instruction set
+ */
+template <typename T>
+struct reduce_kernels {
+  typedef reduce_traits<T> traits;
+  typedef typename traits::sum_type S;
+  typedef typename traits::mean_type M;
+  typedef typename traits::norm_type N;
+  void (*sum)(pairwise_accumulator<S>&, const T*, Py_ssize_t, Py_ssize_t);
+  void (*mean)(pairwise_accumulator<M>&, const T*, Py_ssize_t, Py_ssize_t);
+  void (*sumsq)(pairwise_accumulator<N>&, const T*, Py_ssize_t, Py_ssize_t);
+  void (*dot)(pairwise_accumulator<S>&, const T*, Py_ssize_t, const T*, Py_ssize_t, Py_ssize_t);
+  void (*min)(T&, const T*, Py_ssize_t, Py_ssize_t);
+  void (*max)(T&, const T*, Py_ssize_t, Py_ssize_t);
+};
+
+/**
+ * Instantiates all kernels as functions compiled for one instruction set,
+ * into which the generic code above is inlined
+ */
+#define BOB_BLITZ_REDUCE_KERNELS(isa, attributes) \
+  template <typename T> struct isa##_kernels { \
+    typedef reduce_kernels<T> K; \
+    attributes static void sum(pairwise_accumulator<typename K::S>& acc, const T* x, Py_ssize_t n, Py_ssize_t s) { sum_row(acc, x, n, s); } \
+    attributes static void mean(pairwise_accumulator<typename K::M>& acc, const T* x, Py_ssize_t n, Py_ssize_t s) { sum_row(acc, x, n, s); } \
+    attributes static void sumsq(pairwise_accumulator<typename K::N>& acc, const T* x, Py_ssize_t n, Py_ssize_t s) { sumsq_row(acc, x, n, s); } \
+    attributes static void dot(pairwise_accumulator<typename K::S>& acc, const T* x, Py_ssize_t sx, const T* y, Py_ssize_t sy, Py_ssize_t n) { dot_row(acc, x, sx, y, sy, n); } \
+    attributes static void min(T& v, const T* x, Py_ssize_t n, Py_ssize_t s) { extremum_row<false>(v, x, n, s, typename K::traits::is_complex()); } \
+    attributes static void max(T& v, const T* x, Py_ssize_t n, Py_ssize_t s) { extremum_row<true>(v, x, n, s, typename K::traits::is_complex()); } \
+    static K table() { K k = {sum, mean, sumsq, dot, min, max}; return k; } \
+  };
+
+BOB_BLITZ_REDUCE_KERNELS(generic, )
+#ifdef BOB_BLITZ_REDUCE_DISPATCH
+BOB_BLITZ_REDUCE_KERNELS(avx2, __attribute__((target("avx2"))))
+BOB_BLITZ_REDUCE_KERNELS(avx512, __attribute__((target("avx512f,avx512bw"))))
+#endif
+
+/**
+ * Instruction sets the kernels are compiled for
+ */
+typedef enum {
+  REDUCE_GENERIC = 0,
+  REDUCE_AVX2,
+  REDUCE_AVX512
+} reduce_isa;
+
+static const char* reduce_isa_name[] = {"generic", "avx2", "avx512"};
+
+/**
+ * The best instruction set supported by the CPU (and operating system) we
+ * run on, detected when the module is imported
+ */
+static reduce_isa current_isa = REDUCE_GENERIC;
+
+template <typename T>
+static const reduce_kernels<T>& kernels() {
+  static const reduce_kernels<T> k = [] {
+    switch (current_isa) {
+#ifdef BOB_BLITZ_REDUCE_DISPATCH
+      case REDUCE_AVX512: return avx512_kernels<T>::table();
+      case REDUCE_AVX2: return avx2_kernels<T>::table();
+#endif
+      default: return generic_kernels<T>::table();
+    }
+  }();
+  return k;
+}
+
+/**************
+ * Traversals *
+ **************/
+
+/**
+ * Number of elements reduced together, by a single thread. The results of
+ * tiles are combined in order, so that the results of reductions do not
+ * depend on the number of threads that computed them.
+ */
+static const Py_ssize_t REDUCE_TILE = 1 << 15;
+
+/**
+ * Arrays smaller than this are reduced without releasing the GIL, which
+ * would cost more than the reduction itself
+ */
+static const Py_ssize_t REDUCE_NOGIL_THRESHOLD = 1 << 14;
+
+static Py_ssize_t reduce_size(PyBlitzArrayObject* a) {
+  Py_ssize_t size = 1;
+  for (Py_ssize_t i=0; i<a->ndim; ++i) size *= a->shape[i];
+  return size;
+}
+
+/**
+ * Splits the elements of `a' (and of `b', of the same shape, if given) into
+ * rows: runs along their last dimension, or, if both arrays are C-contiguous,
+ * consecutive runs of REDUCE_TILE elements. Rows are grouped into tiles of
+ * about REDUCE_TILE elements.
+ */
+template <typename T>
+class reduce_traversal {
+
+  public:
+
+    reduce_traversal(PyBlitzArrayObject* a, PyBlitzArrayObject* b):
+      m_a(a), m_b(b ? b : a), m_size(1), m_contiguous(true) {
+
+      for (Py_ssize_t i=a->ndim-1; i>=0; --i) {
+        if (m_a->stride[i] != m_size * (Py_ssize_t)sizeof(T)) m_contiguous = false;
+        if (m_b->stride[i] != m_size * (Py_ssize_t)sizeof(T)) m_contiguous = false;
+        m_size *= a->shape[i];
+      }
+
+      if (m_contiguous) {
+        m_length = REDUCE_TILE;
+        m_rows = (m_size + REDUCE_TILE - 1) / REDUCE_TILE;
+        m_rows_per_tile = 1;
+      }
+      else {
+        m_length = a->shape[a->ndim-1];
+        m_rows = m_length ? m_size / m_length : 0;
+        m_rows_per_tile = std::max<Py_ssize_t>(1, REDUCE_TILE / std::max<Py_ssize_t>(1, m_length));
+      }
+
+    }
+
+    Py_ssize_t size() const { return m_size; }
+
+    /**
+     * The first (0) or second (1) array traversed
+     */
+    PyBlitzArrayObject* array(int i) const { return i ? m_b : m_a; }
+
+    Py_ssize_t tiles() const {
+      return (m_rows + m_rows_per_tile - 1) / m_rows_per_tile;
+    }
+
+    /**
+     * Calls `row(x, sx, y, sy, n)' for each row of tile `t', made of `n'
+     * elements `sx' (`sy') elements apart
+     */
+    template <typename F>
+    void tile(Py_ssize_t t, F row) const {
+
+      const Py_ssize_t first = t * m_rows_per_tile;
+      const Py_ssize_t last = std::min(m_rows, first + m_rows_per_tile);
+      const T* x = reinterpret_cast<const T*>(m_a->data);
+      const T* y = reinterpret_cast<const T*>(m_b->data);
+
+      if (m_contiguous) {
+        for (Py_ssize_t r=first; r<last; ++r)
+          row(x + r*m_length, 1, y + r*m_length, 1,
+              std::min(m_length, m_size - r*m_length));
+        return;
+      }
+
+      // odometer over all dimensions but the last one, from row `first'
+      const Py_ssize_t end = m_a->ndim - 1;
+      Py_ssize_t index[BOB_BLITZ_MAXDIMS];
+      for (Py_ssize_t i=end-1, r=first; i>=0; --i) {
+        index[i] = r % m_a->shape[i];
+        r /= m_a->shape[i];
+        x += index[i] * (m_a->stride[i] / (Py_ssize_t)sizeof(T));
+        y += index[i] * (m_b->stride[i] / (Py_ssize_t)sizeof(T));
+      }
+
+      const Py_ssize_t sx = m_a->stride[end] / (Py_ssize_t)sizeof(T);
+      const Py_ssize_t sy = m_b->stride[end] / (Py_ssize_t)sizeof(T);
+      for (Py_ssize_t r=first; r<last; ++r) {
+        row(x, sx, y, sy, m_length);
+        for (Py_ssize_t i=end-1; i>=0; --i) {
+          x += m_a->stride[i] / (Py_ssize_t)sizeof(T);
+          y += m_b->stride[i] / (Py_ssize_t)sizeof(T);
+          if (++index[i] < m_a->shape[i]) break;
+          x -= index[i] * (m_a->stride[i] / (Py_ssize_t)sizeof(T));
+          y -= index[i] * (m_b->stride[i] / (Py_ssize_t)sizeof(T));
+          index[i] = 0;
+        }
+      }
+
+    }
+
+  private:
+
+    PyBlitzArrayObject* m_a;
+    PyBlitzArrayObject* m_b;
+    Py_ssize_t m_size; ///< total number of elements
+    bool m_contiguous;
+    Py_ssize_t m_length; ///< elements per row
+    Py_ssize_t m_rows;
+    Py_ssize_t m_rows_per_tile;
+
+};
+
+/**
+ * Calls `tile(t)' for all tiles of `r', using the thread pool for large
+ * arrays
+ */
+template <typename T, typename F>
+static void reduce_tiles(const reduce_traversal<T>& r, F tile) {
+
+  auto work = [&](Py_ssize_t t, int) { tile(t); };
+
+  if (r.size() < REDUCE_NOGIL_THRESHOLD) {
+    PyBlitzThreads_Run(r.tiles(), 1, work);
+    return;
+  }
+
+  const int workers = PyBlitzThreads_Tiles(r.size(), sizeof(T)) > 1 ? PyBlitzThreads_Get() : 1;
+  PyBlitzArray_PinData(r.array(0));
+  PyBlitzArray_PinData(r.array(1));
+  Py_BEGIN_ALLOW_THREADS
+  PyBlitzThreads_Run(r.tiles(), workers, work);
+  Py_END_ALLOW_THREADS
+  PyBlitzArray_UnpinData(r.array(1));
+  PyBlitzArray_UnpinData(r.array(0));
+
+}
+
+/**
+ * Sums, pairwise, what `kernel(acc, x, sx, y, sy, n)' accumulates over all
+ * rows of `a' (and `b')
+ */
+template <typename A, typename T, typename K>
+static A pairwise_reduce(PyBlitzArrayObject* a, PyBlitzArrayObject* b,
+    K kernel) {
+
+  const reduce_traversal<T> r(a, b);
+  std::vector<A> partial(r.tiles());
+
+  reduce_tiles(r, [&](Py_ssize_t t) {
+      pairwise_accumulator<A> acc;
+      r.tile(t, [&](const T* x, Py_ssize_t sx, const T* y, Py_ssize_t sy, Py_ssize_t n) {
+          kernel(acc, x, sx, y, sy, n);
+      });
+      partial[t] = acc.total();
+  });
+
+  pairwise_accumulator<A> acc;
+  for (auto& p : partial) acc.push(p);
+  return acc.total();
+
+}
+
+/**
+ * Returns a numpy scalar of type `type_num', copied from `value'
+ */
+static PyObject* reduce_scalar(int type_num, void* value) {
+  PyArray_Descr* descr = PyArray_DescrFromType(type_num);
+  if (!descr) return 0;
+  PyObject* retval = PyArray_Scalar(value, descr, 0);
+  Py_DECREF(descr);
+  return retval;
+}
+
+/**************
+ * Reductions *
+ **************/
+
+typedef enum {
+  REDUCE_SUM = 0,
+  REDUCE_MIN,
+  REDUCE_MAX,
+  REDUCE_MEAN,
+  REDUCE_NORM
+} reduce_op;
+
+static const char* reduce_op_name[] = {"sum", "min", "max", "mean", "norm"};
+
+template <bool maximum, typename T>
+static PyObject* extremum_inner(PyBlitzArrayObject* a, std::false_type /*complex*/) {
+
+  if (!reduce_size(a)) {
+    PyErr_Format(PyExc_ValueError, "cannot compute the %s of %s(@%" PY_FORMAT_SIZE_T "d,'%s') without elements", reduce_op_name[maximum ? REDUCE_MAX : REDUCE_MIN], Py_TYPE(a)->tp_name, a->ndim, PyBlitzArray_TypenumAsString(a->type_num));
+    return 0;
+  }
+
+  const reduce_kernels<T>& k = kernels<T>();
+  auto extremum = maximum ? k.max : k.min;
+
+  // tiles all start from an element of the array
+  // (not a std::vector, which would pack booleans into bits)
+  const reduce_traversal<T> r(a, 0);
+  std::unique_ptr<T[]> partial(new T[r.tiles()]);
+  std::fill(partial.get(), partial.get() + r.tiles(), *reinterpret_cast<const T*>(a->data));
+
+  reduce_tiles(r, [&](Py_ssize_t t) {
+      r.tile(t, [&](const T* x, Py_ssize_t sx, const T*, Py_ssize_t, Py_ssize_t n) {
+          extremum(partial[t], x, n, sx);
+      });
+  });
+
+  T value = partial[0];
+  extremum(value, partial.get(), r.tiles(), 1);
+  return reduce_scalar(a->type_num, &value);
+
+}
+
+template <bool maximum, typename T>
+static PyObject* extremum_inner(PyBlitzArrayObject* a, std::true_type /*complex*/) {
+  PyErr_Format(PyExc_TypeError, "cannot compute the %s of %s(@%" PY_FORMAT_SIZE_T "d,'%s'): complex numbers are not ordered", reduce_op_name[maximum ? REDUCE_MAX : REDUCE_MIN], Py_TYPE(a)->tp_name, a->ndim, PyBlitzArray_TypenumAsString(a->type_num));
+  return 0;
+}
+
+template <typename T>
+static PyObject* reduce_inner(PyBlitzArrayObject* a, reduce_op op) {
+
+  typedef reduce_kernels<T> K;
+  typedef typename K::traits::is_complex is_complex;
+  const K& k = kernels<T>();
+
+  switch (op) {
+
+    case REDUCE_SUM:
+      {
+        typename K::S value = pairwise_reduce<typename K::S,T>(a, 0,
+            [&](pairwise_accumulator<typename K::S>& acc, const T* x,
+              Py_ssize_t sx, const T*, Py_ssize_t, Py_ssize_t n) {
+            k.sum(acc, x, n, sx);
+        });
+        return reduce_scalar(K::traits::sum_type_num, &value);
+      }
+
+    case REDUCE_MEAN:
+      {
+        const Py_ssize_t size = reduce_size(a);
+        if (!size && PyErr_WarnEx(PyExc_RuntimeWarning, "mean of an array without elements", 1) < 0) return 0;
+        typename K::M value = pairwise_reduce<typename K::M,T>(a, 0,
+            [&](pairwise_accumulator<typename K::M>& acc, const T* x,
+              Py_ssize_t sx, const T*, Py_ssize_t, Py_ssize_t n) {
+            k.mean(acc, x, n, sx);
+        });
+        if (size) value /= typename K::N(size);
+        else value = typename K::M(std::numeric_limits<typename K::N>::quiet_NaN());
+        return reduce_scalar(PyBlitzArrayCxx_CToTypenum<typename K::M>(), &value);
+      }
+
+    case REDUCE_NORM:
+      {
+        typename K::N value = std::sqrt(pairwise_reduce<typename K::N,T>(a, 0,
+            [&](pairwise_accumulator<typename K::N>& acc, const T* x,
+              Py_ssize_t sx, const T*, Py_ssize_t, Py_ssize_t n) {
+            k.sumsq(acc, x, n, sx);
+        }));
+        return reduce_scalar(PyBlitzArrayCxx_CToTypenum<typename K::N>(), &value);
+      }
+
+    case REDUCE_MIN:
+      return extremum_inner<false,T>(a, is_complex());
+
+    case REDUCE_MAX:
+      return extremum_inner<true,T>(a, is_complex());
+
+  }
+
+  return 0;
+
+}
+
+PyObject* PyBlitzArray_Reduce(PyBlitzArrayObject* a, const char* op) {
+
+  int o = -1;
+  for (int i=0; i<(int)(sizeof(reduce_op_name)/sizeof(reduce_op_name[0])); ++i)
+    if (std::strcmp(op, reduce_op_name[i]) == 0) o = i;
+
+  if (o < 0) {
+    PyErr_Format(PyExc_ValueError, "unknown reduction `%s' - valid reductions are `sum', `min', `max', `mean' and `norm'", op);
+    return 0;
+  }
+
+  switch (a->type_num) {
+
+    case NPY_BOOL:
+      return reduce_inner<bool>(a, reduce_op(o));
+
+    case NPY_INT8:
+      return reduce_inner<int8_t>(a, reduce_op(o));
+
+    case NPY_INT16:
+      return reduce_inner<int16_t>(a, reduce_op(o));
+
+    case NPY_INT32:
+      return reduce_inner<int32_t>(a, reduce_op(o));
+
+    case NPY_INT64:
+      return reduce_inner<int64_t>(a, reduce_op(o));
+
+    case NPY_UINT8:
+      return reduce_inner<uint8_t>(a, reduce_op(o));
+
+    case NPY_UINT16:
+      return reduce_inner<uint16_t>(a, reduce_op(o));
+
+    case NPY_UINT32:
+      return reduce_inner<uint32_t>(a, reduce_op(o));
+
+    case NPY_UINT64:
+      return reduce_inner<uint64_t>(a, reduce_op(o));
+
+    case NPY_FLOAT32:
+      return reduce_inner<float>(a, reduce_op(o));
+
+    case NPY_FLOAT64:
+      return reduce_inner<double>(a, reduce_op(o));
+
+#ifdef NPY_FLOAT128
+    case NPY_FLOAT128:
+      return reduce_inner<long double>(a, reduce_op(o));
+
+#endif
+
+    case NPY_COMPLEX64:
+      return reduce_inner<std::complex<float>>(a, reduce_op(o));
+
+    case NPY_COMPLEX128:
+      return reduce_inner<std::complex<double>>(a, reduce_op(o));
+
+#ifdef NPY_COMPLEX256
+    case NPY_COMPLEX256:
+      return reduce_inner<std::complex<long double>>(a, reduce_op(o));
+
+#endif
+
+    default:
+      PyErr_Format(PyExc_NotImplementedError, "cannot compute the %s of %s(@%" PY_FORMAT_SIZE_T "d,T) with T being a data type with an unsupported numpy type number = %d", op, Py_TYPE(a)->tp_name, a->ndim, a->type_num);
+      return 0;
+
+  }
+
+}
+
+/****************
+ * Dot Products *
+ ****************/
+
+template <typename T>
+static PyObject* dot_inner(PyBlitzArrayObject* a, PyBlitzArrayObject* b) {
+
+  typedef reduce_kernels<T> K;
+  const K& k = kernels<T>();
+
+  typename K::S total = pairwise_reduce<typename K::S,T>(a, b,
+      [&](pairwise_accumulator<typename K::S>& acc, const T* x, Py_ssize_t sx,
+        const T* y, Py_ssize_t sy, Py_ssize_t n) {
+      k.dot(acc, x, sx, y, sy, n);
+  });
+
+  // integer products wrap around in the type of the arrays, as in numpy
+  T value = static_cast<T>(total);
+  return reduce_scalar(a->type_num, &value);
+
+}
+
+PyObject* PyBlitzArray_Dot(PyBlitzArrayObject* a, PyBlitzArrayObject* b) {
+
+  bool same_shape = (a->ndim == b->ndim);
+  for (Py_ssize_t i=0; same_shape && i<a->ndim; ++i)
+    same_shape = (a->shape[i] == b->shape[i]);
+
+  if (!same_shape) {
+    PyErr_Format(PyExc_ValueError, "cannot compute the dot product of %s(@%" PY_FORMAT_SIZE_T "d,'%s') and %s(@%" PY_FORMAT_SIZE_T "d,'%s'): both arrays should have the same shape", Py_TYPE(a)->tp_name, a->ndim, PyBlitzArray_TypenumAsString(a->type_num), Py_TYPE(b)->tp_name, b->ndim, PyBlitzArray_TypenumAsString(b->type_num));
+    return 0;
+  }
+
+  // arrays of different types are first cast to their common type
+  if (a->type_num != b->type_num) {
+    PyArray_Descr* da = PyArray_DescrFromType(a->type_num);
+    auto da_ = make_xsafe(da);
+    PyArray_Descr* db = PyArray_DescrFromType(b->type_num);
+    auto db_ = make_xsafe(db);
+    if (!da || !db) return 0;
+    PyArray_Descr* common = PyArray_PromoteTypes(da, db);
+    if (!common) return 0;
+    const int type_num = common->type_num;
+    Py_DECREF(common);
+
+    PyObject* ca = PyBlitzArray_Cast(a, type_num);
+    if (!ca) return 0;
+    auto ca_ = make_safe(ca);
+    PyObject* cb = PyBlitzArray_Cast(b, type_num);
+    if (!cb) return 0;
+    auto cb_ = make_safe(cb);
+    return PyBlitzArray_Dot(reinterpret_cast<PyBlitzArrayObject*>(ca),
+        reinterpret_cast<PyBlitzArrayObject*>(cb));
+  }
+
+  switch (a->type_num) {
+
+    case NPY_BOOL:
+      return dot_inner<bool>(a, b);
+
+    case NPY_INT8:
+      return dot_inner<int8_t>(a, b);
+
+    case NPY_INT16:
+      return dot_inner<int16_t>(a, b);
+
+    case NPY_INT32:
+      return dot_inner<int32_t>(a, b);
+
+    case NPY_INT64:
+      return dot_inner<int64_t>(a, b);
+
+    case NPY_UINT8:
+      return dot_inner<uint8_t>(a, b);
+
+    case NPY_UINT16:
+      return dot_inner<uint16_t>(a, b);
+
+    case NPY_UINT32:
+      return dot_inner<uint32_t>(a, b);
+
+    case NPY_UINT64:
+      return dot_inner<uint64_t>(a, b);
+
+    case NPY_FLOAT32:
+      return dot_inner<float>(a, b);
+
+    case NPY_FLOAT64:
+      return dot_inner<double>(a, b);
+
+#ifdef NPY_FLOAT128
+    case NPY_FLOAT128:
+      return dot_inner<long double>(a, b);
+
+#endif
+
+    case NPY_COMPLEX64:
+      return dot_inner<std::complex<float>>(a, b);
+
+    case NPY_COMPLEX128:
+      return dot_inner<std::complex<double>>(a, b);
+
+#ifdef NPY_COMPLEX256
+    case NPY_COMPLEX256:
+      return dot_inner<std::complex<long double>>(a, b);
+
+#endif
+
+    default:
+      PyErr_Format(PyExc_NotImplementedError, "cannot compute the dot product of %s(@%" PY_FORMAT_SIZE_T "d,T) with T being a data type with an unsupported numpy type number = %d", Py_TYPE(a)->tp_name, a->ndim, a->type_num);
+      return 0;
+
+  }
+
+}
+
+/**
+ * Selects the kernels for the CPU we run on
+ */
+bool init_Reductions(PyObject* module) {
+
+#ifdef BOB_BLITZ_REDUCE_DISPATCH
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+    current_isa = REDUCE_AVX512;
+  else if (__builtin_cpu_supports("avx2"))
+    current_isa = REDUCE_AVX2;
+#endif
+
+  return PyModule_AddStringConstant(module, "simd", reduce_isa_name[current_isa]) >= 0;
+
+}
@@ -0,0 +1,211 @@
+#!/usr/bin/env python
+# vim: set fileencoding=utf-8 :
+# Sat 17 Oct 2026
+
+"""Times the C/C++ and Python APIs of bob.blitz over a grid of element types,
+ranks and sizes, printing the results as JSON.
+
+Each result records the time taken by one call, the calls per second and the
+bytes copied by one call. Given a baseline (the saved results of a previous
+run), results slower by more than the tolerance, or copying more bytes, are
+reported as regressions, and the program exits with status 1.
+"""
+
+import sys
+import json
+import timeit
+import platform
+import argparse
+
+import numpy
+
+DTYPES = ('bool', 'uint8', 'int16', 'int32', 'int64', 'float32', 'float64',
+    'complex128')
+RANKS = (1, 2, 3, 4)
+SIZES = (1, 1000, 1000000)
+
+def _shape(rank, size):
+  """The shape of the array with ``rank`` dimensions of equal extents and
+  about ``size`` elements"""
+
+  extent = max(1, int(round(size ** (1. / rank))))
+  return (extent,) * rank
+
+def _input(dtype, shape):
+  """A behaved array of the given type and shape, with non-zero values"""
+
+  size = int(numpy.prod(shape))
+  return (numpy.arange(size) % 100 + 1).astype(dtype).reshape(shape)
+
+def _cast_type(dtype):
+  """The type arrays of ``dtype`` are cast into"""
+
+  return 'float32' if numpy.dtype(dtype) == numpy.float64 else 'float64'
+
+def _bytes_copied(result, source):
+  """Bytes of ``result`` not shared with ``source``"""
+
+  result = numpy.asarray(result)
+  if source is not None and numpy.may_share_memory(result, source): return 0
+  return result.nbytes
+
+def _time(call, min_time, repeat):
+  """Seconds taken by one call, the fastest of ``repeat`` loops lasting at
+  least ``min_time`` seconds each"""
+
+  timer = timeit.Timer(call)
+  number = 1
+  while True:
+    elapsed = timer.timeit(number)
+    if elapsed >= min_time: break
+    factor = 1.2 * min_time / elapsed if elapsed > 0 else 10.
+    number *= int(max(2, min(10, factor)))
+  best = min([elapsed] + timer.repeat(repeat - 1, number)) if repeat > 1 \
+      else elapsed
+  return best / number
+
+def python_benchmarks(nd, cast):
+  """Calls of the Python API on (a copy of) ``nd``, with their results
+  compared against ``nd`` for bytes copied (or ``None`` if nothing is ever
+  copied)"""
+
+  import bob.blitz
+  bz = bob.blitz.as_blitz(nd)
+  # not based on an ndarray, as arrays returned by bob.blitz
+  own = bob.blitz.array(nd.shape, nd.dtype)
+  own[...] = nd
+  index = (0,) * nd.ndim
+
+  return {
+      'array': (lambda: bob.blitz.array(nd.shape, nd.dtype), None),
+      'as_blitz': (lambda: bob.blitz.as_blitz(nd), nd),
+      'as_ndarray': (lambda: own.as_ndarray(), own),
+      '__array__': (lambda: numpy.asarray(own), own),
+      'getitem': (lambda: own[index], None),
+      'cast': (lambda: bz.cast(cast), nd),
+      }
+
+def run(dtypes=DTYPES, ranks=RANKS, sizes=SIZES, suites=('c++', 'python'),
+    min_time=0.02, repeat=3):
+  """Runs the benchmarks of the given suites over the grid of element types,
+  ranks and sizes, returning the results as a dictionary"""
+
+  import bob.blitz
+
+  results = []
+  for dtype in dtypes:
+    for rank in ranks:
+      for size in sizes:
+
+        shape = _shape(rank, size)
+        nd = _input(dtype, shape)
+        cast = _cast_type(dtype)
+
+        timings = []
+        if 'c++' in suites:
+          from .. import _benchmark
+          for name in sorted(_benchmark.benchmarks):
+            seconds, copied = _benchmark.measure(name, nd, cast, min_time,
+                repeat)
+            timings.append(('c++', name, seconds, copied))
+
+        if 'python' in suites:
+          for name, (call, source) in sorted(python_benchmarks(nd, cast).items()):
+            seconds = _time(call, min_time, repeat)
+            copied = _bytes_copied(call(), source) if source is not None else 0
+            timings.append(('python', name, seconds, copied))
+
+        for suite, name, seconds, copied in timings:
+          results.append({
+            'suite': suite,
+            'benchmark': name,
+            'dtype': dtype,
+            'shape': list(shape),
+            'seconds': seconds,
+            'calls_per_second': 1. / seconds if seconds > 0 else float('inf'),
+            'bytes_copied': int(copied),
+            })
+
+  return {
+      'version': bob.blitz.__version__,
+      'python': platform.python_version(),
+      'numpy': numpy.__version__,
+      'threads': bob.blitz.get_num_threads(),
+      'results': results,
+      }
+
+def _key(result):
+  return (result['suite'], result['benchmark'], result['dtype'],
+      tuple(result['shape']))
+
+def compare(current, baseline, tolerance=0.25):
+  """Annotates the results of ``current`` with their speed-up relative to
+  ``baseline``, returning those slower by more than ``tolerance`` (a
+  fraction), or copying more bytes, than in the baseline"""
+
+  reference = dict((_key(k), k) for k in baseline['results'])
+
+  regressions = []
+  for result in current['results']:
+    base = reference.get(_key(result))
+    if base is None: continue
+    result['speedup'] = base['seconds'] / result['seconds'] \
+        if result['seconds'] > 0 else float('inf')
+    if result['seconds'] > base['seconds'] * (1. + tolerance) or \
+        result['bytes_copied'] > base['bytes_copied']:
+      regressions.append(result)
+
+  return regressions
+
+def main(user_input=None):
+
+  parser = argparse.ArgumentParser(description=__doc__,
+      formatter_class=argparse.RawDescriptionHelpFormatter)
+  parser.add_argument('-d', '--dtype', action='append', dest='dtypes',
+      help='element types to benchmark (may be repeated, defaults to %s)' % \
+          ', '.join(DTYPES))
+  parser.add_argument('-r', '--rank', action='append', dest='ranks', type=int,
+      help='ranks to benchmark (may be repeated, defaults to %s)' % \
+          ', '.join(str(k) for k in RANKS))
+  parser.add_argument('-s', '--size', action='append', dest='sizes', type=int,
+      help='numbers of elements to benchmark (may be repeated, defaults to %s)' % \
+          ', '.join(str(k) for k in SIZES))
+  parser.add_argument('-S', '--suite', action='append', dest='suites',
+      choices=('c++', 'python'),
+      help='suites to run (may be repeated, defaults to both)')
+  parser.add_argument('-t', '--min-time', type=float, default=0.02,
+      help='minimum duration of each timing loop, in seconds (defaults to %(default)s)')
+  parser.add_argument('-n', '--repeat', type=int, default=3,
+      help='number of timing loops, the fastest is kept (defaults to %(default)s)')
+  parser.add_argument('-b', '--baseline',
+      help='JSON file with the results of a previous run, to compare against')
+  parser.add_argument('-T', '--tolerance', type=float, default=0.25,
+      help='slow down, as a fraction of the baseline, considered a regression (defaults to %(default)s)')
+  parser.add_argument('-o', '--output',
+      help='JSON file to save the results to (e.g., as a new baseline), instead of printing them')
+  args = parser.parse_args(user_input)
+
+  current = run(args.dtypes or DTYPES, args.ranks or RANKS,
+      args.sizes or SIZES, args.suites or ('c++', 'python'), args.min_time,
+      args.repeat)
+
+  regressions = []
+  if args.baseline:
+    with open(args.baseline) as f: baseline = json.load(f)
+    regressions = compare(current, baseline, args.tolerance)
+
+  if args.output:
+    with open(args.output, 'w') as f: json.dump(current, f, indent=2)
+  else:
+    json.dump(current, sys.stdout, indent=2)
+    sys.stdout.write('\n')
+
+  for k in regressions:
+    sys.stderr.write('regression: %s %s(%s, %s): %.3g s/call, speed-up %.2f, %d bytes copied\n' % \
+        (k['suite'], k['benchmark'], k['dtype'], tuple(k['shape']),
+          k['seconds'], k['speedup'], k['bytes_copied']))
+
+  return 1 if regressions else 0
+
+if __name__ == '__main__':
+  sys.exit(main())
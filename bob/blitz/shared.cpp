@@ -0,0 +1,313 @@
+/**
+ * @date Fri 16 Oct 2026
+ *
+ * @brief Arrays allocated in shared memory, for use by several processes
+ */
+
+#define BOB_BLITZ_MODULE
+#include <bob.blitz/capi.h>
+#include <bob.blitz/cleanup.h>
+#include <bob.extension/documentation.h>
+#include <structmember.h>
+
+#include <cstring>
+#include <string>
+#include <limits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Owner of a shared memory mapping, kept as the base of the arrays using it
+ */
+typedef struct {
+  PyObject_HEAD
+  void* addr; ///< start of the mapping
+  size_t length; ///< length of the mapping, in bytes
+  int fd; ///< descriptor of the segment, or -1 if not kept
+  PyObject* name; ///< name of the segment, or None for anonymous ones
+  int unlink; ///< 1 if the name is removed when this object is deleted
+} PyBlitzSharedMemoryObject;
+
+auto shared_memory_doc = bob::extension::ClassDoc(
+  BOB_EXT_MODULE_PREFIX ".shared_memory",
+  "A shared memory segment, mapped into this process",
+  "Objects of this class are created by :py:meth:`" BOB_EXT_MODULE_PREFIX ".array.shared` and :py:meth:`" BOB_EXT_MODULE_PREFIX ".array.attach` and kept as the :py:attr:`" BOB_EXT_MODULE_PREFIX ".array.base` of the returned arrays. "
+  "The segment is unmapped when the last array using it is deleted. "
+  "Named segments are also removed from the system at that point, if they were created (not attached to) by this process."
+);
+
+static void PyBlitzSharedMemory_Delete(PyBlitzSharedMemoryObject* self) {
+  if (self->addr) munmap(self->addr, self->length);
+  if (self->fd >= 0) close(self->fd);
+  if (self->unlink && self->name != Py_None) {
+    PyObject* name = PyUnicode_AsUTF8String(self->name);
+    if (name) {
+      shm_unlink(PyBytes_AS_STRING(name));
+      Py_DECREF(name);
+    }
+    else PyErr_Clear();
+  }
+  Py_XDECREF(self->name);
+  Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+auto shared_memory_name = bob::extension::VariableDoc(
+  "name",
+  "str or None",
+  "The name of the segment, or ``None`` if it is anonymous"
+);
+static PyObject* PyBlitzSharedMemory_name(PyBlitzSharedMemoryObject* self, void*) {
+  Py_INCREF(self->name);
+  return self->name;
+}
+
+auto shared_memory_fd = bob::extension::VariableDoc(
+  "fd",
+  "int",
+  "A file descriptor for the segment, which other processes may use with :py:meth:`" BOB_EXT_MODULE_PREFIX ".array.attach` (e.g. after receiving it through a UNIX socket), or ``-1`` if no descriptor is kept"
+);
+static PyObject* PyBlitzSharedMemory_fd(PyBlitzSharedMemoryObject* self, void*) {
+  return Py_BuildValue("i", self->fd);
+}
+
+auto shared_memory_size = bob::extension::VariableDoc(
+  "size",
+  "int",
+  "The size of the mapped segment, in bytes"
+);
+static PyObject* PyBlitzSharedMemory_size(PyBlitzSharedMemoryObject* self, void*) {
+  return Py_BuildValue("n", (Py_ssize_t)self->length);
+}
+
+static PyGetSetDef PyBlitzSharedMemory_getseters[] = {
+    {
+      shared_memory_name.name(),
+      (getter)PyBlitzSharedMemory_name,
+      0,
+      shared_memory_name.doc(),
+      0,
+    },
+    {
+      shared_memory_fd.name(),
+      (getter)PyBlitzSharedMemory_fd,
+      0,
+      shared_memory_fd.doc(),
+      0,
+    },
+    {
+      shared_memory_size.name(),
+      (getter)PyBlitzSharedMemory_size,
+      0,
+      shared_memory_size.doc(),
+      0,
+    },
+    {0}  /* Sentinel */
+};
+
+static PyTypeObject PyBlitzSharedMemory_Type = {
+    PyVarObject_HEAD_INIT(0, 0)
+    0
+};
+
+/**
+ * Computes the number of bytes taken by an array, checking for overflows
+ */
+static int shared_nbytes(int type_num, Py_ssize_t ndim, Py_ssize_t* shape,
+    size_t* nbytes) {
+
+  *nbytes = PyBlitzArray_TypenumSize(type_num);
+  if (!*nbytes) return -1;
+
+  for (Py_ssize_t i=0; i<ndim; ++i) {
+    if (shape[i] <= 0 || *nbytes > std::numeric_limits<size_t>::max() / shape[i]) {
+      PyErr_Format(PyExc_ValueError, "invalid shape for a shared %s: extents should be positive and the total size addressable", PyBlitzArray_Type.tp_name);
+      return -1;
+    }
+    *nbytes *= shape[i];
+  }
+
+  return 0;
+
+}
+
+/**
+ * Maps `length' bytes of `fd' and wraps them as an array, whose base becomes
+ * a new shared_memory object. Takes ownership of `fd' if `keep_fd' is set,
+ * closing it on failure.
+ */
+static PyObject* shared_wrap(int fd, bool keep_fd, size_t length,
+    PyObject* name, bool unlink, int writeable, int type_num,
+    Py_ssize_t ndim, Py_ssize_t* shape) {
+
+  int prot = PROT_READ | (writeable ? PROT_WRITE : 0);
+  void* addr = mmap(0, length, prot, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    PyErr_SetFromErrno(PyExc_OSError);
+    if (keep_fd) close(fd);
+    if (unlink && name != Py_None) {
+      PyObject* bytes = PyUnicode_AsUTF8String(name);
+      if (bytes) {
+        shm_unlink(PyBytes_AS_STRING(bytes));
+        Py_DECREF(bytes);
+      }
+    }
+    return 0;
+  }
+
+  PyBlitzSharedMemoryObject* owner = PyObject_New(PyBlitzSharedMemoryObject, &PyBlitzSharedMemory_Type);
+  if (!owner) {
+    munmap(addr, length);
+    if (keep_fd) close(fd);
+    return 0;
+  }
+  owner->addr = addr;
+  owner->length = length;
+  owner->fd = keep_fd ? fd : -1;
+  owner->name = name;
+  Py_INCREF(name);
+  owner->unlink = unlink ? 1 : 0;
+  auto owner_ = make_safe(owner);
+
+  Py_ssize_t stride[BOB_BLITZ_MAXDIMS];
+  Py_ssize_t acc = PyBlitzArray_TypenumSize(type_num);
+  for (Py_ssize_t i=ndim-1; i>=0; --i) {
+    stride[i] = acc;
+    acc *= shape[i];
+  }
+
+  PyObject* retval = PyBlitzArray_SimpleNewFromData(type_num, ndim, shape,
+      stride, addr, writeable);
+  if (!retval) return 0;
+
+  // the array keeps the mapping alive
+  reinterpret_cast<PyBlitzArrayObject*>(retval)->base = reinterpret_cast<PyObject*>(owner);
+  Py_INCREF(owner);
+  return retval;
+
+}
+
+/**
+ * POSIX shared memory names must start with a single `/'
+ */
+static std::string shm_name(const char* name) {
+  if (name[0] == '/') return name;
+  return std::string("/") + name;
+}
+
+PyObject* PyBlitzArray_SharedNew(int type_num, Py_ssize_t ndim,
+    Py_ssize_t* shape, const char* name) {
+
+  size_t nbytes = 0;
+  if (shared_nbytes(type_num, ndim, shape, &nbytes) != 0) return 0;
+
+  int fd = -1;
+  PyObject* py_name = Py_None;
+  auto py_name_ = make_xsafe<PyObject>(0);
+  bool unlink = false;
+
+  if (name) {
+    const std::string n = shm_name(name);
+    fd = shm_open(n.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return PyErr_SetFromErrnoWithFilename(PyExc_OSError, n.c_str());
+    py_name = PyUnicode_FromString(n.c_str());
+    if (!py_name) {
+      close(fd);
+      shm_unlink(n.c_str());
+      return 0;
+    }
+    py_name_ = make_safe(py_name);
+    unlink = true;
+  }
+
+  else {
+#   if defined(MFD_ALLOW_SEALING)
+    fd = memfd_create(BOB_BLITZ_PREFIX, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) return PyErr_SetFromErrno(PyExc_OSError);
+#   else
+    // no memfd: creates a uniquely named segment and removes the name
+    static unsigned counter = 0;
+    const std::string n = "/" BOB_BLITZ_PREFIX "." + std::to_string(getpid()) + "." + std::to_string(counter++);
+    fd = shm_open(n.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return PyErr_SetFromErrnoWithFilename(PyExc_OSError, n.c_str());
+    shm_unlink(n.c_str());
+#   endif
+  }
+
+  if (ftruncate(fd, nbytes) != 0) {
+    PyErr_SetFromErrno(PyExc_OSError);
+    close(fd);
+    if (name) shm_unlink(shm_name(name).c_str());
+    return 0;
+  }
+
+# if defined(MFD_ALLOW_SEALING)
+  // anonymous segments cannot be resized by whoever attaches to them
+  if (!name) fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+# endif
+
+  return shared_wrap(fd, true, nbytes, py_name, unlink, 1, type_num, ndim,
+      shape);
+
+}
+
+PyObject* PyBlitzArray_SharedAttach(const char* name, int fd, int type_num,
+    Py_ssize_t ndim, Py_ssize_t* shape, int writeable) {
+
+  size_t nbytes = 0;
+  if (shared_nbytes(type_num, ndim, shape, &nbytes) != 0) return 0;
+
+  PyObject* py_name = Py_None;
+  auto py_name_ = make_xsafe<PyObject>(0);
+
+  if (name) {
+    const std::string n = shm_name(name);
+    fd = shm_open(n.c_str(), writeable ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) return PyErr_SetFromErrnoWithFilename(PyExc_OSError, n.c_str());
+    py_name = PyUnicode_FromString(n.c_str());
+    if (!py_name) {
+      close(fd);
+      return 0;
+    }
+    py_name_ = make_safe(py_name);
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    PyErr_SetFromErrno(PyExc_OSError);
+    if (name) close(fd);
+    return 0;
+  }
+
+  if ((size_t)st.st_size < nbytes) {
+    PyErr_Format(PyExc_ValueError, "shared memory segment has %" PY_FORMAT_SIZE_T "d bytes, but %" PY_FORMAT_SIZE_T "u are required", (Py_ssize_t)st.st_size, nbytes);
+    if (name) close(fd);
+    return 0;
+  }
+
+  // descriptors given by the caller stay theirs; ours are not needed anymore
+  PyObject* retval = shared_wrap(fd, false, nbytes, py_name, false,
+      writeable, type_num, ndim, shape);
+  if (name) close(fd);
+  return retval;
+
+}
+
+bool init_SharedMemory(PyObject* module) {
+
+  PyBlitzSharedMemory_Type.tp_name = shared_memory_doc.name();
+  PyBlitzSharedMemory_Type.tp_basicsize = sizeof(PyBlitzSharedMemoryObject);
+  PyBlitzSharedMemory_Type.tp_flags = Py_TPFLAGS_DEFAULT;
+  PyBlitzSharedMemory_Type.tp_doc = shared_memory_doc.doc();
+  PyBlitzSharedMemory_Type.tp_dealloc = reinterpret_cast<destructor>(PyBlitzSharedMemory_Delete);
+  PyBlitzSharedMemory_Type.tp_getset = PyBlitzSharedMemory_getseters;
+
+  // check that everyting is fine
+  if (PyType_Ready(&PyBlitzSharedMemory_Type) < 0)
+    return false;
+
+  // add the type to the module
+  Py_INCREF(&PyBlitzSharedMemory_Type);
+  return PyModule_AddObject(module, "shared_memory", (PyObject*)&PyBlitzSharedMemory_Type) >= 0;
+}
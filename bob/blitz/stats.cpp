@@ -0,0 +1,149 @@
+/**
+ * @date Sat 17 Oct 2026
+ *
+ * @brief Counters of the arrays created and of the data they copy
+ */
+
+#define BOB_BLITZ_MODULE
+#include <bob.blitz/capi.h>
+#include <bob.blitz/cleanup.h>
+#include "internal.h"
+
+#include <atomic>
+
+/**
+ * Always on: counters are only ever incremented (relaxed), so they cost
+ * about as much as the function call updating them
+ */
+static std::atomic<unsigned long long> arrays(0);
+static std::atomic<unsigned long long> allocated(0);
+static std::atomic<long long> live(0);
+static std::atomic<unsigned long long> copies[PyBlitzArray_COPY_REASONS];
+static std::atomic<unsigned long long> copied(0);
+static std::atomic<unsigned long long> casts(0);
+static std::atomic<unsigned long long> cast_bytes(0);
+static std::atomic<unsigned long long> wraps(0);
+
+static const char* const reason_names[PyBlitzArray_COPY_REASONS] = {
+  "non_contiguous", "misaligned", "dtype"
+};
+
+/**
+ * Copies (and casts) of at least this many bytes have their Python traceback
+ * recorded, if not negative. Only the latest traces are kept.
+ */
+static Py_ssize_t trace_threshold = -1;
+static PyObject* traces = 0;
+static const Py_ssize_t MAX_TRACES = 100;
+
+static void record_trace(const char* reason, size_t bytes) {
+
+  if (trace_threshold < 0 || bytes < (size_t)trace_threshold) return;
+
+  // a failure to record a trace must not change the outcome of the copy
+  PyObject *type, *value, *tb;
+  PyErr_Fetch(&type, &value, &tb);
+
+  PyObject* traceback = PyImport_ImportModule("traceback");
+  PyObject* stack = traceback ?
+    PyObject_CallMethod(traceback, const_cast<char*>("format_stack"), 0) : 0;
+  PyObject* entry = stack ? Py_BuildValue("{sssnsO}", "reason", reason,
+      "bytes", (Py_ssize_t)bytes, "traceback", stack) : 0;
+  if (entry && traces) {
+    if (PyList_GET_SIZE(traces) >= MAX_TRACES)
+      PyList_SetSlice(traces, 0, PyList_GET_SIZE(traces) - MAX_TRACES + 1, 0);
+    PyList_Append(traces, entry);
+  }
+  Py_XDECREF(entry);
+  Py_XDECREF(stack);
+  Py_XDECREF(traceback);
+
+  PyErr_Clear();
+  PyErr_Restore(type, value, tb);
+
+}
+
+void PyBlitzStats_Created() {
+  arrays.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PyBlitzStats_Allocated(size_t bytes) {
+  allocated.fetch_add(bytes, std::memory_order_relaxed);
+  live.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void PyBlitzStats_Released(size_t bytes) {
+  live.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void PyBlitzStats_Copied(int reason, size_t bytes) {
+  copies[reason].fetch_add(1, std::memory_order_relaxed);
+  copied.fetch_add(bytes, std::memory_order_relaxed);
+  record_trace(reason_names[reason], bytes);
+}
+
+void PyBlitzStats_Cast(size_t bytes) {
+  casts.fetch_add(1, std::memory_order_relaxed);
+  cast_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  record_trace("cast", bytes);
+}
+
+void PyBlitzStats_Wrapped() {
+  wraps.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PyBlitzArray_GetStats(PyBlitzArrayStats* stats) {
+  stats->arrays = arrays.load(std::memory_order_relaxed);
+  stats->allocated = allocated.load(std::memory_order_relaxed);
+  stats->live = live.load(std::memory_order_relaxed);
+  for (int i=0; i<PyBlitzArray_COPY_REASONS; ++i)
+    stats->copies[i] = copies[i].load(std::memory_order_relaxed);
+  stats->copied = copied.load(std::memory_order_relaxed);
+  stats->casts = casts.load(std::memory_order_relaxed);
+  stats->cast_bytes = cast_bytes.load(std::memory_order_relaxed);
+  stats->wraps = wraps.load(std::memory_order_relaxed);
+}
+
+/* Not part of the C-API: used by the Python bindings */
+PyObject* PyBlitzStats_AsDict() {
+
+  PyBlitzArrayStats s;
+  PyBlitzArray_GetStats(&s);
+
+  PyObject* copies = Py_BuildValue("{sKsKsK}",
+      reason_names[PyBlitzArray_COPY_NONCONTIGUOUS], s.copies[PyBlitzArray_COPY_NONCONTIGUOUS],
+      reason_names[PyBlitzArray_COPY_MISALIGNED], s.copies[PyBlitzArray_COPY_MISALIGNED],
+      reason_names[PyBlitzArray_COPY_DTYPE], s.copies[PyBlitzArray_COPY_DTYPE]);
+  if (!copies) return 0;
+  auto copies_ = make_safe(copies);
+
+  PyObject* recorded = traces ? PyList_GetSlice(traces, 0, PyList_GET_SIZE(traces)) : PyList_New(0);
+  if (!recorded) return 0;
+  auto recorded_ = make_safe(recorded);
+
+  return Py_BuildValue("{sKsKsLsOsKsKsKsKsO}",
+      "arrays", s.arrays,
+      "bytes_allocated", s.allocated,
+      "live_bytes", s.live,
+      "copies", copies,
+      "bytes_copied", s.copied,
+      "casts", s.casts,
+      "bytes_cast", s.cast_bytes,
+      "numpy_wraps", s.wraps,
+      "traces", recorded);
+
+}
+
+/* Not part of the C-API: used by the Python bindings */
+int PyBlitzStats_TraceCopies(Py_ssize_t threshold) {
+
+  if (threshold >= 0) {
+    PyObject* fresh = PyList_New(0);
+    if (!fresh) return -1;
+    Py_XDECREF(traces);
+    traces = fresh;
+  }
+  trace_threshold = threshold < 0 ? -1 : threshold;
+  return 0;
+
+}
@@ -195,7 +195,7 @@ def test_s64d2_shallow_array():
   nose.tools.eq_(bz[0,1], nd[0,1])
   nose.tools.eq_(bz[1,0], nd[1,0])
   nose.tools.eq_(bz[1,1], nd[1,1])
-  nose.tools.eq_(nd.base, bz)
+  assert nd.base is bz
   del bz
   assert nd.flags.behaved
   assert nd.flags.c_contiguous
@@ -228,7 +228,7 @@ def test_s64d2_indirect_array():
   bz[1,0] = 3
   bz[1,1] = -1
   nd = numpy.array(bz, copy=False)
-  nose.tools.eq_(nd.base, bz)
+  assert nd.base is bz
 
 @nose.tools.raises(ValueError)
 def test_s64d2_cannot_resize_shallow():
@@ -274,6 +274,44 @@ def test_from_3darray_transposed():
       for k in range(2):
         nose.tools.eq_(bz[k,i,j], nd[i,j,k])
 
+def test_from_ndarray_strided():
+
+  base = numpy.arange(60, dtype='float64').reshape(6,10)
+  views = [
+      base[::-1],
+      base[:, ::-1],
+      base[::-2, 1::3],
+      base.T[::-1],
+      numpy.asfortranarray(base),
+      ]
+  for nd in views:
+    bz = as_blitz(nd)
+
+    # shallow wrapping, with the same element ordering
+    nose.tools.eq_(id(bz.base), id(nd))
+    nose.tools.eq_(bz.shape, nd.shape)
+    for i in range(nd.shape[0]):
+      for j in range(nd.shape[1]):
+        nose.tools.eq_(bz[i,j], nd[i,j])
+    assert numpy.array_equal(bz.as_ndarray(), nd)
+
+    # writes go through the original memory
+    bz[0,0] = -1.
+    nose.tools.eq_(nd[0,0], -1.)
+    bz[nd.shape[0]-1,nd.shape[1]-1] = -2.
+    nose.tools.eq_(nd[-1,-1], -2.)
+
+def test_reversed_view_of_bzarray():
+
+  bz = bzarray((4,), 'int32')
+  nd = bz.as_ndarray()
+  nd[:] = range(4)
+
+  # reversed views of a bob.blitz.array are not the array itself
+  rev = as_blitz(nd[::-1])
+  assert rev is not bz
+  nose.tools.eq_([rev[k] for k in range(4)], [3, 2, 1, 0])
+
 @nose.tools.raises(ValueError)
 def test_detects_unsupported_dims():
 
@@ -361,7 +399,7 @@ def test_as_ndarray_nocast():
   bz[1,1] = 4
   if IS_32BIT: nd = bz.as_ndarray(numpy.int32)
   else: nd = bz.as_ndarray(numpy.int64)
-  nose.tools.eq_(nd.base, bz)
+  assert nd.base is bz
   if IS_32BIT: nose.tools.eq_(nd.dtype, numpy.int32)
   else: nose.tools.eq_(nd.dtype, numpy.int64)
   nose.tools.eq_(nd[0,0], nd[0,0])
@@ -384,3 +422,1092 @@ def test_array_cast():
   nose.tools.eq_(bz2[1,0], 2)
   nose.tools.eq_(bz2[1,1], 4)
 
+
+def test_buffer_protocol():
+
+  bz = bzarray((2,3), dtype='float32')
+  for i in range(2):
+    for j in range(3):
+      bz[i,j] = 3*i + j
+  mv = memoryview(bz)
+  nose.tools.eq_(mv.shape, (2,3))
+  nose.tools.eq_(mv.strides, bz.stride)
+  nose.tools.eq_(mv.format, 'f')
+  nose.tools.eq_(mv.itemsize, 4)
+  nose.tools.eq_(mv.readonly, False)
+  nose.tools.eq_(mv.tobytes(), numpy.arange(6, dtype='float32').tobytes())
+
+  # writes through the view reach the array
+  nd = numpy.frombuffer(mv, dtype='float32')
+  nd[4] = 42.
+  nose.tools.eq_(bz[1,1], 42.)
+
+def test_buffer_protocol_all_dtypes():
+
+  for dtype in ('bool', 'int8', 'int16', 'int32', 'int64', 'uint8', 'uint16',
+      'uint32', 'uint64', 'float32', 'float64', 'complex64', 'complex128'):
+    bz = bzarray((2,2), dtype=dtype)
+    nd = numpy.asarray(memoryview(bz))
+    nose.tools.eq_(nd.dtype, numpy.dtype(dtype))
+    nose.tools.eq_(nd.shape, bz.shape)
+
+def test_buffer_protocol_readonly():
+
+  nd = numpy.arange(4, dtype='uint8')
+  nd.flags.writeable = False
+  bz = as_blitz(nd)
+  mv = memoryview(bz)
+  nose.tools.eq_(mv.readonly, True)
+
+@nose.tools.raises(BufferError)
+def test_buffer_protocol_prevents_reinit():
+
+  bz = bzarray((2,2), dtype='uint8')
+  mv = memoryview(bz)
+  bz.__init__((3,3), 'uint8')
+
+def test_array_interface():
+
+  bz = bzarray((2,3), dtype='uint16')
+  bz[1,2] = 7
+  iface = bz.__array_interface__
+  nose.tools.eq_(iface['version'], 3)
+  nose.tools.eq_(iface['shape'], (2,3))
+  nose.tools.eq_(iface['strides'], bz.stride)
+  nose.tools.eq_(numpy.dtype(iface['typestr']), numpy.uint16)
+  nose.tools.eq_(iface['data'][1], False)
+
+  class Interface(object): pass
+  o = Interface()
+  o.__array_interface__ = iface
+  nd = numpy.asarray(o)
+  nose.tools.eq_(nd[1,2], 7)
+
+def test_array_struct():
+
+  bz = bzarray((2,2), dtype='complex128')
+  bz[0,1] = complex(1,2)
+  class Struct(object): pass
+  o = Struct()
+  o.__array_struct__ = bz.__array_struct__
+  del bz
+  nd = numpy.asarray(o)
+  nose.tools.eq_(nd.dtype, numpy.complex128)
+  nose.tools.eq_(nd[0,1], complex(1,2))
+
+def test_as_ndarray_reuses_view():
+
+  bz = bzarray((2,2), dtype='float64')
+  nd1 = bz.as_ndarray()
+  nd2 = bz.as_ndarray()
+  assert nd1 is nd2
+
+  # changing the view shape invalidates the cached view
+  nd1.shape = (4,)
+  nd3 = bz.as_ndarray()
+  assert nd3 is not nd1
+  nose.tools.eq_(nd3.shape, (2,2))
+
+def test_array_assign_and_read_f64d4():
+
+  bz = bzarray((2,3,4,5), dtype='float64')
+  bz[1,2,3,4] = 3.5
+  bz[0,1,2,3] = -1.
+  nose.tools.eq_(bz[1,2,3,4], 3.5)
+  nose.tools.eq_(bz[0,1,2,3], -1.)
+  nose.tools.eq_(bz[-1,-1,-1,-1], 3.5)
+  nd = bz.as_ndarray()
+  nose.tools.eq_(nd[1,2,3,4], 3.5)
+  nose.tools.eq_(nd[0,1,2,3], -1.)
+
+def test_setitem_scalar_conversions():
+
+  bz = bzarray(4, dtype='uint8')
+  bz[0] = True
+  bz[1] = 255
+  bz[2] = numpy.uint8(7)
+  bz[3] = numpy.int64(12)
+  nose.tools.eq_(list(bz.as_ndarray()), [1, 255, 7, 12])
+
+  bz = bzarray(4, dtype='float64')
+  bz[0] = 2
+  bz[1] = 0.25
+  bz[2] = numpy.float64(-1.5)
+  bz[3] = numpy.float32(0.5)
+  nose.tools.eq_(list(bz.as_ndarray()), [2., 0.25, -1.5, 0.5])
+
+  bz = bzarray(3, dtype='complex128')
+  bz[0] = 1+2j
+  bz[1] = 3.
+  bz[2] = -4
+  nose.tools.eq_(list(bz.as_ndarray()), [1+2j, 3+0j, -4+0j])
+
+  bz = bzarray(2, dtype='bool')
+  bz[0] = 1
+  bz[1] = False
+  nose.tools.eq_(list(bz.as_ndarray()), [True, False])
+
+def test_create_destroy_many():
+
+  # objects are recycled through a freelist: make sure contents are fresh
+  for i in range(200):
+    bz = bzarray((i%4+1, 3), dtype='int32' if i%2 else 'float64')
+    bz[0,0] = i
+    nose.tools.eq_(bz.shape, (i%4+1, 3))
+    nose.tools.eq_(bz[0,0], i)
+    del bz
+
+def test_reinit_replaces_contents():
+
+  bz = bzarray((2,2), dtype='float64')
+  bz.__init__((3,), 'uint8')
+  nose.tools.eq_(bz.shape, (3,))
+  nose.tools.eq_(bz.dtype, numpy.dtype('uint8'))
+  bz[2] = 5
+  nose.tools.eq_(bz[2], 5)
+
+def test_reinit_refused_while_viewed():
+
+  bz = bzarray((4,), dtype='uint8')
+  bz[...] = 3
+  for view in (lambda a: a.as_ndarray(), lambda a: a[1:]):
+    a = bzarray((4,), dtype='uint8')
+    a[...] = 3
+    v = view(a)
+    nose.tools.assert_raises(BufferError, a.__init__, (3,), 'uint8')
+    # the view still reads the original data
+    nose.tools.eq_(v[0], 3)
+    nose.tools.eq_(a.shape, (4,))
+    nose.tools.eq_(a.dtype, numpy.dtype('uint8'))
+
+  # whole-array operations do not count as views
+  c = bz + 1
+  bz[1:] = 0
+  bz.__init__((3,), 'float64')
+  nose.tools.eq_(bz.shape, (3,))
+  nose.tools.eq_(c[0], 4)
+
+  # the array no longer depends on where its previous data came from
+  w = as_blitz(numpy.zeros((2,)))
+  w.__init__((2,), 'uint8')
+  assert w.base is None
+
+def test_data_allocators():
+
+  from . import set_allocator, get_allocator
+  from .version import externals
+
+  nose.tools.eq_(get_allocator(), 'blitz')
+  assert 'Allocator' in externals
+
+  try:
+    for name in ('malloc', 'aligned64', 'hugepage', 'blitz'):
+      set_allocator(name)
+      nose.tools.eq_(get_allocator(), name)
+      bz = bzarray((3,7), dtype='float64')
+      bz[2,6] = 4.5
+      nose.tools.eq_(bz[2,6], 4.5)
+      if name == 'aligned64':
+        nose.tools.eq_(bz.__array_interface__['data'][0] % 64, 0)
+
+    set_allocator('hugepage', threshold=1024)
+    bz = bzarray((1024,), dtype='float32')
+    nose.tools.eq_(bz.__array_interface__['data'][0] % (2<<20), 0)
+
+    nose.tools.assert_raises(ValueError, set_allocator, 'nonexisting')
+    nose.tools.assert_raises(ValueError, set_allocator, 'malloc', 10)
+
+  finally:
+    set_allocator('blitz')
+
+def test_data_cache():
+
+  from . import set_allocator, set_cache_limit, cache_stats
+
+  try:
+    set_allocator('aligned64')
+    set_cache_limit(1 << 20)
+    start = cache_stats()
+    for i in range(10):
+      bz = bzarray((32,32), dtype='float64')
+      bz[31,31] = i
+      nose.tools.eq_(bz[31,31], i)
+      del bz
+    stats = cache_stats()
+    nose.tools.eq_(stats['limit'], 1 << 20)
+    assert stats['hits'] - start['hits'] >= 9
+    assert stats['bytes'] > 0
+
+    # blocks bigger than the limit are never kept
+    bzarray((1 << 18,), dtype='float64')
+    nose.tools.eq_(cache_stats()['dropped'] - stats['dropped'], 1)
+
+    set_cache_limit(0)
+    nose.tools.eq_(cache_stats()['bytes'], 0)
+    nose.tools.assert_raises(ValueError, set_cache_limit, -1)
+
+  finally:
+    set_cache_limit(0)
+    set_allocator('blitz')
+
+def test_from_file():
+
+  import tempfile, os
+  nd = numpy.arange(12, dtype='float64').reshape(3,4)
+  fd, path = tempfile.mkstemp()
+  try:
+    with os.fdopen(fd, 'wb') as f:
+      f.write(b'\0'*16)
+      f.write(nd.tobytes())
+
+    bz = bzarray.from_file(path, 'float64', (3,4), offset=16)
+    nose.tools.eq_(bz.shape, (3,4))
+    nose.tools.eq_(bz[2,3], 11.)
+    assert not bz.writeable
+    # views of read-only mappings are read-only too
+    assert not bz.as_ndarray().flags.writeable
+    assert not numpy.asarray(bz).flags.writeable
+    nose.tools.assert_raises(ValueError, bzarray.from_file, path, 'float64', (4,4), offset=16)
+    nose.tools.assert_raises(ValueError, bzarray.from_file, path, 'float64', (3,4), offset=3)
+    del bz
+
+    bz = bzarray.from_file(path, 'float64', (3,4), offset=16, mode='c', advice='random')
+    bz[0,0] = 42.
+    nose.tools.eq_(bz[0,0], 42.)
+    del bz
+
+    bz = bzarray.from_file(path, 'float64', (3,4), offset=16, mode='r+')
+    bz[0,0] = 7.
+    del bz
+    nose.tools.eq_(numpy.fromfile(path, dtype='float64')[2], 7.)
+
+  finally:
+    os.unlink(path)
+
+def test_from_npy():
+
+  import tempfile, os
+  fd, path = tempfile.mkstemp(suffix='.npy')
+  os.close(fd)
+  try:
+    for nd in (numpy.arange(24, dtype='int16').reshape(2,3,4),
+        numpy.asfortranarray(numpy.arange(6, dtype='complex64').reshape(2,3))):
+      numpy.save(path, nd)
+      bz = bzarray.from_npy(path)
+      nose.tools.eq_(bz.shape, nd.shape)
+      nose.tools.eq_(bz.dtype, nd.dtype)
+      assert numpy.array_equal(bz.as_ndarray(), nd)
+      assert not bz.as_ndarray().flags.writeable
+      del bz
+  finally:
+    os.unlink(path)
+
+def test_pickle():
+
+  import pickle
+  bz = bzarray((2,3), dtype='float32')
+  for i in range(2):
+    for j in range(3): bz[i,j] = 10*i + j
+
+  for protocol in range(pickle.HIGHEST_PROTOCOL+1):
+    copy = pickle.loads(pickle.dumps(bz, protocol=protocol))
+    nose.tools.eq_(copy.shape, bz.shape)
+    nose.tools.eq_(copy.dtype, bz.dtype)
+    assert numpy.array_equal(copy.as_ndarray(), bz.as_ndarray())
+    assert copy.writeable
+    copy[0,0] = -1. # independent copy
+    nose.tools.eq_(bz[0,0], 0.)
+
+def test_pickle_out_of_band():
+
+  import pickle
+  if pickle.HIGHEST_PROTOCOL < 5:
+    raise nose.plugins.skip.SkipTest("pickle protocol 5 is not available")
+
+  bz = bzarray(5, dtype='int64')
+  for i in range(5): bz[i] = i
+
+  buffers = []
+  data = pickle.dumps(bz, protocol=5, buffer_callback=buffers.append)
+  nose.tools.eq_(len(buffers), 1)
+  copy = pickle.loads(data, buffers=buffers)
+  nose.tools.eq_(list(copy.as_ndarray()), list(range(5)))
+  # zero-copy: both point to the same memory
+  copy[2] = 42
+  nose.tools.eq_(bz[2], 42)
+
+def test_pickle_fortran_order():
+
+  import pickle
+  nd = numpy.asfortranarray(numpy.arange(6, dtype='uint16').reshape(2,3))
+  bz = as_blitz(nd)
+  for protocol in range(pickle.HIGHEST_PROTOCOL+1):
+    copy = pickle.loads(pickle.dumps(bz, protocol=protocol))
+    assert numpy.array_equal(copy.as_ndarray(), nd)
+
+def test_shared_anonymous():
+
+  import os
+  bz = bzarray.shared((2,3), 'float64')
+  nose.tools.eq_(bz.shape, (2,3))
+  nose.tools.eq_(bz.base.name, None)
+  assert bz.base.fd >= 0
+  bz[1,2] = 3.5
+
+  other = bzarray.attach(bz.base.fd, (2,3), 'float64')
+  nose.tools.eq_(other[1,2], 3.5)
+  other[0,0] = -1.
+  nose.tools.eq_(bz[0,0], -1.)
+
+  # forked children write to the same physical memory
+  if hasattr(os, 'fork'):
+    pid = os.fork()
+    if pid == 0:
+      bz[0,1] = 42.
+      os._exit(0)
+    os.waitpid(pid, 0)
+    nose.tools.eq_(bz[0,1], 42.)
+
+def test_shared_named():
+
+  import os
+  name = 'bob.blitz.test.%d' % os.getpid()
+  bz = bzarray.shared(4, 'int32', name=name)
+  nose.tools.eq_(bz.base.name, '/' + name)
+  bz[3] = 7
+
+  ro = bzarray.attach(name, 4, 'int32', writeable=False)
+  nose.tools.eq_(ro[3], 7)
+  assert not ro.writeable
+  # the mapping is read-only, so are views of it
+  assert not ro.as_ndarray().flags.writeable
+  nose.tools.assert_raises(ValueError, bzarray.attach, name, 8, 'int32')
+  nose.tools.assert_raises(OSError, bzarray.shared, 4, 'int32', name=name)
+
+  del ro, bz
+  nose.tools.assert_raises(OSError, bzarray.attach, name, 4, 'int32')
+
+  # file descriptors out of the range of int are not truncated
+  for fd in (-1, 2**32 + 1, 2**70):
+    nose.tools.assert_raises(ValueError, bzarray.attach, fd, 4, 'int32')
+
+def test_getitem_slices():
+
+  nd = numpy.arange(60, dtype='int16').reshape(3,4,5)
+  bz = as_blitz(nd.copy())
+
+  for index in [
+      (1,),
+      (slice(None), 2),
+      (Ellipsis, 3),
+      (0, Ellipsis, slice(1, 4)),
+      (slice(None, None, -1), slice(1, None, 2), -1),
+      (-1, 2, slice(4, 0, -3)),
+      ]:
+    view = bz[index]
+    assert isinstance(view, bzarray)
+    nose.tools.eq_(view.shape, nd[index].shape)
+    assert numpy.array_equal(view.as_ndarray(), nd[index])
+    assert view.base is bz
+
+  nose.tools.eq_(bz[2,-1,-2], nd[2,-1,-2])
+  nose.tools.eq_(bz[2,-1][-2], nd[2,-1,-2])
+
+def test_getitem_slices_share_memory():
+
+  bz = bzarray((4,6), 'float32')
+  bz[...] = 0
+  roi = bz[1:3, 2:5]
+  roi[0,0] = 42
+  nose.tools.eq_(bz[1,2], 42)
+
+@nose.tools.raises(IndexError)
+def test_getitem_too_many_indices():
+
+  bz = bzarray((4,6), 'float32')
+  bz[0, 0, :]
+
+@nose.tools.raises(IndexError)
+def test_getitem_slices_out_of_range():
+
+  bz = bzarray((4,6), 'float32')
+  bz[:, 6]
+
+def test_setitem_slices():
+
+  nd = numpy.zeros((4,5), 'float64')
+  bz = as_blitz(nd)
+
+  bz[1] = 7
+  bz[2:, ::2] = [[1, 2, 3], [4, 5, 6]]
+  bz[..., -1] = numpy.array([9, 8, 7, 6], 'int8')
+  bz[0, :] = numpy.arange(5)[::-1]
+
+  ref = numpy.zeros((4,5), 'float64')
+  ref[1] = 7
+  ref[2:, ::2] = [[1, 2, 3], [4, 5, 6]]
+  ref[..., -1] = [9, 8, 7, 6]
+  ref[0, :] = numpy.arange(5)[::-1]
+  assert numpy.array_equal(nd, ref)
+
+def test_setitem_slices_broadcast():
+
+  bz = bzarray((3,4), 'int32')
+  bz[:] = [1, 2, 3, 4]
+  bz[:, 1:2] = [[0], [0], [0]]
+  assert numpy.array_equal(bz.as_ndarray(), [[1, 0, 3, 4]] * 3)
+
+@nose.tools.raises(ValueError)
+def test_setitem_slices_shape_mismatch():
+
+  bz = bzarray((3,4), 'int32')
+  bz[:, :2] = [1, 2, 3]
+
+def test_setitem_slices_overlap():
+
+  bz = bzarray((6,), 'int64')
+  bz[:] = numpy.arange(6)
+  bz[1:] = bz.as_ndarray()[:-1]
+  assert numpy.array_equal(bz.as_ndarray(), [0, 0, 1, 2, 3, 4])
+
+def test_take():
+
+  nd = numpy.arange(60, dtype='float32').reshape(6,10)
+  bz = as_blitz(nd)
+
+  for dtype in ('int8', 'uint16', 'int32', 'int64', 'uint64'):
+    positions = numpy.array([[0,0], [5,9], [2,3], [1,7]], dtype)
+    values = bz.take(positions)
+    assert isinstance(values, bzarray)
+    nose.tools.eq_(values.dtype, bz.dtype)
+    assert numpy.array_equal(values.as_ndarray(), nd[positions[:,0], positions[:,1]])
+
+  # negative positions and 1D arrays
+  nose.tools.eq_(list(bz.take([[-1,-1], [-6,0]]).as_ndarray()), [59, 0])
+  flat = as_blitz(numpy.arange(5, dtype='int16'))
+  nose.tools.eq_(list(flat.take([4, -5, 2]).as_ndarray()), [4, 0, 2])
+
+@nose.tools.raises(IndexError)
+def test_take_out_of_range():
+
+  bz = bzarray((3,4), 'uint8')
+  bz.take([[0,0], [3,0]])
+
+@nose.tools.raises(TypeError)
+def test_take_requires_integers():
+
+  bz = bzarray((3,4), 'uint8')
+  bz.take([[0.,0.]])
+
+@nose.tools.raises(ValueError)
+def test_take_requires_one_column_per_dimension():
+
+  bz = bzarray((3,4), 'uint8')
+  bz.take([[0,0,0]])
+
+def test_put():
+
+  nd = numpy.zeros((4,5), 'int32')
+  bz = as_blitz(nd)
+
+  bz.put(numpy.array([[0,1], [3,4], [-1,0]], 'uint8'), [7, 8, 9.7])
+  nose.tools.eq_(nd[0,1], 7)
+  nose.tools.eq_(nd[3,4], 8)
+  nose.tools.eq_(nd[3,0], 9)
+
+  bz.put([[1,1], [2,2]], -3)
+  nose.tools.eq_(nd[1,1], -3)
+  nose.tools.eq_(nd[2,2], -3)
+
+def test_put_is_atomic():
+
+  nd = numpy.zeros((4,5), 'int32')
+  bz = as_blitz(nd)
+  try:
+    bz.put([[0,0], [4,0]], 1)
+  except IndexError:
+    pass
+  nose.tools.eq_(nd[0,0], 0)
+
+@nose.tools.raises(ValueError)
+def test_put_values_mismatch():
+
+  bz = bzarray((4,5), 'int32')
+  bz.put([[0,0], [1,1]], [1, 2, 3])
+
+def test_iterate_rows():
+
+  nd = numpy.arange(24, dtype='uint16').reshape(4,3,2)
+  bz = as_blitz(nd)
+
+  rows = list(bz)
+  nose.tools.eq_(len(rows), 4)
+  for k, row in enumerate(rows):
+    assert isinstance(row, bzarray)
+    nose.tools.eq_(row.shape, (3,2))
+    assert row.base is bz
+    assert numpy.array_equal(row.as_ndarray(), nd[k])
+
+  # rows share memory with the array
+  rows[2][1,1] = 1000
+  nose.tools.eq_(nd[2,1,1], 1000)
+
+def test_iterate_1d():
+
+  bz = as_blitz(numpy.array([3., 1., 4.]))
+  nose.tools.eq_(list(bz), [3., 1., 4.])
+
+def test_chunks():
+
+  nd = numpy.arange(70, dtype='float64').reshape(7,10)
+  bz = as_blitz(nd)
+
+  chunks = list(bz.chunks(3))
+  nose.tools.eq_([c.shape for c in chunks], [(3,10), (3,10), (1,10)])
+  for k, c in enumerate(chunks):
+    assert c.base is bz
+    assert numpy.array_equal(c.as_ndarray(), nd[3*k:3*(k+1)])
+
+  nose.tools.eq_(len(list(bz.chunks(7))), 1)
+  nose.tools.eq_(len(list(bz.chunks(100))), 1)
+
+@nose.tools.raises(ValueError)
+def test_chunks_need_rows():
+
+  bz = bzarray((3,4), 'uint8')
+  bz.chunks(0)
+
+def test_arithmetic():
+
+  a = numpy.arange(12, dtype='float64').reshape(3,4)
+  b = numpy.linspace(1, 2, 12).reshape(3,4)
+  ba = as_blitz(a)
+  bb = as_blitz(b)
+
+  for result, expected in [
+      (ba + bb, a + b),
+      (ba - bb, a - b),
+      (ba * bb, a * b),
+      (ba / bb, a / b),
+      (ba * bb + ba, a * b + a),
+      (ba + 2, a + 2),
+      (3 * ba, 3 * a),
+      (1 - ba, 1 - a),
+      (ba / b, a / b),
+      (ba + numpy.arange(4), a + numpy.arange(4)),
+      ]:
+    assert isinstance(result, bzarray)
+    nose.tools.eq_(result.dtype, expected.dtype)
+    assert numpy.allclose(result.as_ndarray(), expected)
+
+def test_arithmetic_promotion():
+
+  a = as_blitz(numpy.arange(5, dtype='uint8'))
+  nose.tools.eq_((a + 1).dtype, numpy.uint8)
+  nose.tools.eq_((a + 1.5).dtype, numpy.float64)
+  nose.tools.eq_((a / a.cast('int32')).dtype, numpy.float64)
+  nose.tools.eq_((a * numpy.ones(5, 'int16')).dtype, numpy.int16)
+
+def test_arithmetic_inplace():
+
+  nd = numpy.arange(6, dtype='int32').reshape(2,3)
+  bz = as_blitz(nd)
+  same = bz
+
+  bz += 1
+  bz *= [1, 2, 3]
+  bz -= bz
+  assert bz is same
+  assert numpy.array_equal(nd, numpy.zeros((2,3)))
+
+  # operands sharing memory with the array are copied first
+  bz[0,:] = [1, 2, 3]
+  bz[1,:] = [4, 5, 6]
+  bz += bz.as_ndarray()[::-1]
+  assert numpy.array_equal(nd, [[5, 7, 9], [5, 7, 9]])
+
+@nose.tools.raises(TypeError)
+def test_arithmetic_inplace_same_kind():
+
+  bz = bzarray((2,3), 'int32')
+  bz /= 2
+
+def test_comparisons():
+
+  a = numpy.array([1, 5, 3, 7], 'int16')
+  b = numpy.array([2, 5, 1, 9], 'float32')
+  ba = as_blitz(a)
+
+  for result, expected in [
+      (ba < b, a < b),
+      (ba <= b, a <= b),
+      (ba > b, a > b),
+      (ba >= b, a >= b),
+      (ba == b, a == b),
+      (ba != 5, a != 5),
+      ]:
+    assert isinstance(result, bzarray)
+    nose.tools.eq_(result.dtype, numpy.bool_)
+    assert numpy.array_equal(result.as_ndarray(), expected)
+
+  c = as_blitz(numpy.array([1+2j, 3j]))
+  assert numpy.array_equal((c == 3j).as_ndarray(), [False, True])
+
+@nose.tools.raises(ValueError)
+def test_truth_value_is_ambiguous():
+
+  bz = as_blitz(numpy.arange(3))
+  if bz == bz: pass
+
+def test_expr_eval():
+
+  from . import expr
+
+  a = numpy.random.rand(7, 11)
+  mean = a.mean(axis=0)
+  std = a.std(axis=0)
+  w = numpy.linspace(0, 1, 11).astype('float32')
+
+  e = (expr(as_blitz(a)) - mean) / std * w
+  assert isinstance(e, expr)
+  nose.tools.eq_(e.shape, (7, 11))
+  nose.tools.eq_(e.dtype, numpy.float64)
+
+  result = e.eval()
+  assert isinstance(result, bzarray)
+  assert numpy.allclose(result.as_ndarray(), (a - mean) / std * w)
+
+  # mixing with arrays and scalars, on either side
+  bz = as_blitz(a)
+  for e, expected in [
+      (2 * expr(bz), 2 * a),
+      (bz + expr(bz), a + a),
+      (1 / (expr(bz) + 1), 1 / (a + 1)),
+      (numpy.ones(11) - expr(a), 1 - a),
+      ]:
+    assert isinstance(e, expr)
+    assert numpy.allclose(e.eval().as_ndarray(), expected)
+
+def test_expr_promotion():
+
+  from . import expr
+  a = as_blitz(numpy.arange(6, dtype='int16'))
+  nose.tools.eq_((expr(a) + 1).dtype, numpy.int16)
+  nose.tools.eq_((expr(a) * 0.5).dtype, numpy.float64)
+  nose.tools.eq_((expr(a) / 2).dtype, numpy.float64)
+  assert numpy.array_equal((expr(a) * 3 - a).eval().as_ndarray(), 2 * numpy.arange(6))
+
+def test_expr_assign():
+
+  from . import expr
+
+  nd = numpy.zeros((4, 6), 'float32')
+  out = as_blitz(nd)
+  x = numpy.arange(6, dtype='float64')
+
+  out[...] = expr(x) * 2 + 1
+  assert numpy.allclose(nd, numpy.tile(x * 2 + 1, (4, 1)))
+
+  out[1:3, ::2] = expr(x[::2]) - 10
+  assert numpy.allclose(nd[1:3, ::2], numpy.tile(x[::2] - 10, (2, 1)))
+
+  # in-place updates, including overlapping views
+  out[...] = expr(out) * 2
+  assert numpy.allclose(nd[0], 2 * (x * 2 + 1))
+  before = nd.copy()
+  out[:, 1:] = expr(out.as_ndarray()[:, :-1]) + 0
+  assert numpy.allclose(nd[:, 1:], before[:, :-1])
+
+def test_expr_large():
+
+  from . import expr
+
+  a = numpy.random.rand(300, 1000)
+  b = numpy.random.rand(1000)
+  shared = expr(a) * b
+  e = shared + shared * 3
+  assert numpy.allclose(e.eval().as_ndarray(), 4 * a * b)
+
+  out = as_blitz(numpy.zeros((1000, 300)))
+  out[...] = expr(a.T) - 1
+  assert numpy.allclose(out.as_ndarray(), a.T - 1)
+
+@nose.tools.raises(TypeError)
+def test_expr_assign_same_kind():
+
+  from . import expr
+  out = bzarray((3,), 'int32')
+  out[...] = expr(numpy.ones(3)) * 1.5
+
+@nose.tools.raises(ValueError)
+def test_expr_broadcast_errors():
+
+  from . import expr
+  expr(numpy.ones(3)) + numpy.ones(4)
+
+def test_reductions():
+
+  dtypes = ['bool', 'int8', 'int16', 'int32', 'int64', 'uint8', 'uint16',
+      'uint32', 'uint64', 'float32', 'float64', 'complex64', 'complex128']
+
+  for dtype in dtypes:
+    nd = (numpy.random.rand(13, 257) * 20).astype(dtype)
+    if numpy.dtype(dtype).kind == 'c': nd += 1j * nd[::-1]
+    bz = as_blitz(nd)
+
+    s = bz.sum()
+    nose.tools.eq_(numpy.asarray(s).dtype, nd.sum().dtype)
+    assert numpy.allclose(s, nd.sum(), rtol=1e-5)
+    m = bz.mean()
+    nose.tools.eq_(numpy.asarray(m).dtype, nd.mean().dtype)
+    assert numpy.allclose(m, nd.mean(), rtol=1e-5)
+    assert numpy.allclose(bz.norm(), numpy.linalg.norm(nd.flatten()), rtol=1e-5)
+    assert numpy.allclose(bz.dot(nd), numpy.dot(nd.flatten(), nd.flatten()), rtol=1e-5)
+
+    if numpy.dtype(dtype).kind != 'c':
+      nose.tools.eq_(bz.min(), nd.min())
+      nose.tools.eq_(bz.max(), nd.max())
+
+def test_reductions_strided():
+
+  nd = numpy.random.rand(40, 30, 20)
+  bz = as_blitz(nd)
+  for view in (bz[::-3, 1:, ::2], bz[..., 5], bz[:, ::-1]):
+    v = view.as_ndarray()
+    assert numpy.allclose(view.sum(), v.sum())
+    nose.tools.eq_(view.min(), v.min())
+    nose.tools.eq_(view.max(), v.max())
+    assert numpy.allclose(view.dot(v.copy()), (v * v).sum())
+
+def test_reductions_accuracy():
+
+  # pairwise summation keeps float32 sums accurate
+  nd = numpy.full((1000, 1000), 0.1, 'float32')
+  assert abs(as_blitz(nd).sum() - 1e5) < 1
+
+def test_reductions_nan():
+
+  nd = numpy.arange(300, dtype='float64')
+  nd[123] = numpy.nan
+  bz = as_blitz(nd)
+  assert numpy.isnan(bz.min())
+  assert numpy.isnan(bz.max())
+  assert numpy.isnan(bz.sum())
+
+def test_reductions_integer_overflow():
+
+  nd = numpy.full(1000, 100, 'int8')
+  nose.tools.eq_(as_blitz(nd).sum(), 100000)
+  nose.tools.eq_(as_blitz(nd).dot(nd), numpy.dot(nd, nd))
+
+@nose.tools.raises(TypeError)
+def test_reductions_complex_min():
+  as_blitz(numpy.ones(3, 'complex128')).min()
+
+@nose.tools.raises(ValueError)
+def test_dot_shape_mismatch():
+  as_blitz(numpy.ones(3)).dot(numpy.ones(4))
+
+def test_dot_promotes():
+  a = as_blitz(numpy.arange(4, dtype='int32'))
+  d = a.dot(numpy.ones(4))
+  nose.tools.eq_(numpy.asarray(d).dtype, numpy.float64)
+  nose.tools.eq_(d, 6.)
+
+def test_simd():
+  from . import simd
+  assert simd in ('generic', 'avx2', 'avx512')
+
+def test_num_threads():
+
+  from . import set_num_threads, get_num_threads
+  default = get_num_threads()
+  assert default >= 1
+  try:
+    set_num_threads(3)
+    nose.tools.eq_(get_num_threads(), 3)
+    set_num_threads(0)
+    nose.tools.eq_(get_num_threads(), default)
+  finally:
+    set_num_threads(0)
+
+def test_threads_same_results():
+
+  from . import set_num_threads, expr
+
+  nd = numpy.random.rand(517, 1031).astype('float32')
+  other = numpy.random.rand(1031).astype('float32')
+  bz = as_blitz(nd)
+
+  def run():
+    out = as_blitz(numpy.zeros_like(nd))
+    out[::-1] = expr(bz) * 2 - other
+    return [
+        (bz + other).as_ndarray(),
+        (bz > 0.5).as_ndarray(),
+        out.as_ndarray(),
+        bz.sum(), bz[:, ::3].sum(), bz.mean(), bz.norm(), bz.min(), bz.max(),
+        bz.dot(nd),
+        ]
+
+  try:
+    set_num_threads(1)
+    serial = run()
+    set_num_threads(4)
+    parallel = run()
+  finally:
+    set_num_threads(0)
+
+  for s, p in zip(serial, parallel):
+    assert numpy.array_equal(s, p)
+
+  assert numpy.allclose(serial[0], nd + other)
+  assert numpy.allclose(serial[2], (nd * 2 - other)[::-1])
+  assert numpy.allclose(serial[3], nd.sum(dtype='float64'), rtol=1e-6)
+
+def test_threads_fill_and_assign():
+
+  from . import set_num_threads
+  try:
+    set_num_threads(4)
+    bz = bzarray((300, 400), 'float64')
+    bz[...] = 3.5
+    assert (bz.as_ndarray() == 3.5).all()
+    src = numpy.random.rand(400, 300)
+    bz[...] = src.T
+    assert numpy.array_equal(bz.as_ndarray(), src.T)
+  finally:
+    set_num_threads(0)
+
+CAST_TYPES = ['bool', 'int8', 'int16', 'int32', 'int64', 'uint8', 'uint16',
+    'uint32', 'uint64', 'float32', 'float64', 'complex64', 'complex128']
+
+def test_cast_matrix():
+
+  import warnings
+  values = numpy.array([0, 1, 2, 7, 100, 0, 3, 127, 1, 0, 42, 5, 9, 64, 33, 0, 1])
+
+  for src in CAST_TYPES:
+    nd = values.astype(src)
+    bz = as_blitz(nd)
+    for dst in CAST_TYPES:
+      with warnings.catch_warnings():
+        warnings.simplefilter('ignore')
+        expected = nd.astype(dst)
+      cast = bz.cast(dst)
+      nose.tools.eq_(cast.dtype, numpy.dtype(dst))
+      assert numpy.array_equal(cast.as_ndarray(), expected), (src, dst)
+
+def test_cast_complex_parts():
+
+  bz = as_blitz(numpy.array([1.5+2j, -3-0.5j, 0j, 1j], 'complex128'))
+  assert numpy.array_equal(bz.cast('float64').as_ndarray(), [1.5, -3, 0, 0])
+  assert numpy.array_equal(bz.cast('bool').as_ndarray(), [True, True, False, True])
+  assert numpy.array_equal(bz.cast('complex64').as_ndarray(), bz.as_ndarray().astype('complex64'))
+  bz = as_blitz(numpy.array([0, numpy.nan, -0.5], 'float32'))
+  assert numpy.array_equal(bz.cast('bool').as_ndarray(), [False, True, True])
+
+def test_cast_strided():
+
+  from . import set_num_threads
+  nd = (numpy.random.rand(300, 500, 3) * 255).astype('uint8')
+  try:
+    for threads in (1, 4):
+      set_num_threads(threads)
+      for view in (nd, nd[::-1, ::2], nd.transpose(2, 0, 1), nd[:, 3:7, 1]):
+        bz = as_blitz(view)
+        assert numpy.array_equal(bz.cast('float32').as_ndarray(), view.astype('float32'))
+        out = numpy.zeros(view.shape[::-1], 'float64').T
+        bz.cast('float64', out=as_blitz(out))
+        assert numpy.array_equal(out, view.astype('float64'))
+  finally:
+    set_num_threads(0)
+
+def test_cast_out():
+
+  frame = as_blitz(numpy.arange(12, dtype='uint16').reshape(3, 4))
+  buf = bzarray((3, 4), 'float32')
+  assert frame.cast('float32', out=buf) is buf
+  assert frame.cast('float32', out=buf) is buf
+  assert numpy.array_equal(buf.as_ndarray(), numpy.arange(12).reshape(3, 4))
+
+  # same type: a plain copy
+  same = bzarray((3, 4), 'uint16')
+  assert frame.cast('uint16', out=same) is same
+  assert numpy.array_equal(same.as_ndarray(), frame.as_ndarray())
+
+  nose.tools.assert_raises(TypeError, frame.cast, 'float64', out=buf)
+  nose.tools.assert_raises(ValueError, frame.cast, 'float32', out=bzarray((4, 3), 'float32'))
+  nose.tools.assert_raises(TypeError, frame.cast, 'float32', out=numpy.zeros((3, 4), 'float32'))
+  readonly = numpy.zeros((3, 4), 'float32')
+  readonly.flags.writeable = False
+  nose.tools.assert_raises(RuntimeError, frame.cast, 'float32', out=as_blitz(readonly))
+
+def test_cast_overlap():
+
+  buf = numpy.arange(10, dtype='int32')
+  src = as_blitz(buf[:8])
+  expected = buf[:8].astype('float32')
+  src.cast('float32', out=as_blitz(buf[2:].view('float32')))
+  assert numpy.array_equal(buf[2:].view('float32'), expected)
+
+  # in place, element by element
+  buf = numpy.arange(10, dtype='int32')
+  as_blitz(buf).cast('float32', out=as_blitz(buf.view('float32')))
+  assert numpy.array_equal(buf.view('float32'), numpy.arange(10, dtype='float32'))
+
+def test_cast_modes():
+
+  nd = numpy.array([-300., -1.5, -0.5, 0.5, 1.5, 2.5, 127.6, 254.5, 255.5, 1e6, numpy.nan], 'float32')
+  bz = as_blitz(nd)
+
+  with numpy.errstate(invalid='ignore'):
+    part = as_blitz(nd[:8])
+    assert numpy.array_equal(part.cast('int16', mode='round_nearest').as_ndarray(), numpy.rint(nd[:8]).astype('int16'))
+    assert numpy.array_equal(bz.cast('uint8', mode='saturate').as_ndarray(), [0, 0, 0, 0, 1, 2, 127, 254, 255, 255, 0])
+    assert numpy.array_equal(bz.cast('uint8', mode='saturate_round').as_ndarray(), [0, 0, 0, 0, 2, 2, 128, 254, 255, 255, 0])
+    assert numpy.array_equal(bz.cast('int8', mode='saturate_round').as_ndarray(), [-128, -2, 0, 0, 2, 2, 127, 127, 127, 127, 0])
+    assert numpy.array_equal(bz.cast('int32', mode='saturate').as_ndarray(), numpy.nan_to_num(numpy.trunc(nd)).astype('int32'))
+
+  # integers into narrower integers
+  bz = as_blitz(numpy.array([-40000, -129, -1, 0, 200, 255, 256, 70000], 'int32'))
+  assert numpy.array_equal(bz.cast('uint8', mode='saturate').as_ndarray(), [0, 0, 0, 0, 200, 255, 255, 255])
+  assert numpy.array_equal(bz.cast('int16', mode='saturate_round').as_ndarray(), [-32768, -129, -1, 0, 200, 255, 256, 32767])
+  assert numpy.array_equal(bz.cast('uint8').as_ndarray(), bz.as_ndarray().astype('uint8'))
+  bz = as_blitz(numpy.array([2**64-1, 2**63, 5], 'uint64'))
+  assert numpy.array_equal(bz.cast('int64', mode='saturate').as_ndarray(), [2**63-1, 2**63-1, 5])
+
+  # floating-point destinations ignore the mode
+  bz = as_blitz(numpy.array([1.25, -2.5], 'float64'))
+  assert numpy.array_equal(bz.cast('float32', mode='saturate_round').as_ndarray(), [1.25, -2.5])
+
+  nose.tools.assert_raises(ValueError, bz.cast, 'uint8', mode='clip')
+  nose.tools.assert_raises(TypeError, bz.cast, 'uint8', mode=1)
+
+def test_cast_scale_offset():
+
+  from . import set_num_threads
+
+  img = numpy.random.rand(480, 640).astype('float32') * 1.2 - 0.1
+  bz = as_blitz(img)
+  expected = numpy.clip(numpy.rint(img * numpy.float32(255) + numpy.float32(0.5)), 0, 255).astype('uint8')
+  try:
+    for threads in (1, 4):
+      set_num_threads(threads)
+      out = bzarray(img.shape, 'uint8')
+      assert bz.cast('uint8', out=out, mode='saturate_round', scale=255, offset=0.5) is out
+      assert numpy.array_equal(out.as_ndarray(), expected)
+      assert numpy.array_equal(bz[::-1, ::3].cast('uint8', mode='saturate_round', scale=255, offset=0.5).as_ndarray(), expected[::-1, ::3])
+  finally:
+    set_num_threads(0)
+
+  # normalization of 8-bit images into floating-point ones
+  u8 = as_blitz(numpy.array([0, 51, 255], 'uint8'))
+  assert numpy.allclose(u8.cast('float32', scale=1./255, offset=-0.5).as_ndarray(), [-0.5, -0.3, 0.5])
+
+  # scale and offset apply even without changing the type
+  f = as_blitz(numpy.array([1., 2.]))
+  g = f.cast('float64', scale=2, offset=1)
+  assert g is not f
+  assert numpy.array_equal(g.as_ndarray(), [3., 5.])
+  assert f.cast('float64') is f
+
+  # complex numbers are scaled as such, and offset along the real axis
+  c = as_blitz(numpy.array([1+2j, -1j], 'complex64'))
+  assert numpy.array_equal(c.cast('complex128', scale=2, offset=1).as_ndarray(), [3+4j, 1-2j])
+
+def test_benchmark():
+
+  from .script import benchmark
+
+  results = benchmark.run(dtypes=('uint8', 'float64'), ranks=(2,),
+      sizes=(16,), min_time=1e-4, repeat=1)
+  records = results['results']
+  names = set((k['suite'], k['benchmark']) for k in records)
+  assert ('c++', 'from_numpy') in names
+  assert ('python', 'as_blitz') in names
+  for k in records:
+    assert k['shape'] == [4, 4]
+    assert k['seconds'] > 0
+  by_name = dict(((k['suite'], k['benchmark'], k['dtype']), k) for k in records)
+  # shallow conversions copy nothing, casts copy the results
+  assert by_name[('c++', 'from_numpy', 'uint8')]['bytes_copied'] == 0
+  assert by_name[('python', 'as_blitz', 'uint8')]['bytes_copied'] == 0
+  assert by_name[('c++', 'cast', 'uint8')]['bytes_copied'] == 16 * 8
+  assert by_name[('python', 'cast', 'float64')]['bytes_copied'] == 16 * 4
+
+  # against itself, only copying more bytes is a regression
+  import copy
+  baseline = copy.deepcopy(results)
+  assert benchmark.compare(results, baseline) == []
+  assert all(abs(k['speedup'] - 1.) < 1e-12 for k in records)
+  baseline['results'][0]['bytes_copied'] -= 1
+  baseline['results'][1]['seconds'] /= 10
+  regressions = benchmark.compare(results, baseline)
+  assert regressions == records[:2]
+
+def test_stats():
+
+  from . import stats, trace_copies, _benchmark
+
+  before = stats()
+  a = bzarray((1000,), 'float64')
+  during = stats()
+  assert during['arrays'] > before['arrays']
+  assert during['bytes_allocated'] - before['bytes_allocated'] >= 8000
+  assert during['live_bytes'] - before['live_bytes'] >= 8000
+  del a
+  assert stats()['live_bytes'] <= during['live_bytes'] - 8000
+
+  # converters copying non-contiguous inputs
+  x = numpy.zeros((4, 6))
+  _benchmark.measure('behaved_converter', x[:, ::2], 'float32', min_time=0, repeat=1)
+  after = stats()
+  assert after['copies']['non_contiguous'] > before['copies']['non_contiguous']
+  assert after['bytes_copied'] - before['bytes_copied'] >= 12 * 8
+  _benchmark.measure('behaved_converter', x, 'float32', min_time=0, repeat=1)
+  assert stats()['copies'] == after['copies']
+
+  _benchmark.measure('numpy_wrap', x, 'float32', min_time=0, repeat=1)
+  assert stats()['numpy_wraps'] > after['numpy_wraps']
+
+  # casts, including those of operands, with tracebacks of the large ones
+  trace_copies(100)
+  try:
+    b = as_blitz(numpy.ones(10, 'float32'))
+    b.cast('float64')
+    b.cast('float64', out=bzarray(10, 'float64'))
+    b.cast('uint8')
+    c = as_blitz(numpy.ones(100, 'int16')) + as_blitz(numpy.ones(100))
+    traces = stats()['traces']
+  finally:
+    trace_copies(-1)
+  assert stats()['casts'] - after['casts'] >= 4
+  assert [k['reason'] for k in traces] == ['cast']
+  assert traces[0]['bytes'] == 800
+  assert any('test_stats' in k for k in traces[0]['traceback'])
+
+def test_tracemalloc():
+
+  try:
+    import tracemalloc
+  except ImportError:
+    raise nose.plugins.skip.SkipTest("tracemalloc is not available")
+
+  from . import tracemalloc_domain
+
+  tracemalloc.start()
+  try:
+    a = bzarray((1000,), 'float64'); line = sys._getframe().f_lineno
+    snapshot = tracemalloc.take_snapshot()
+    del a
+    after = tracemalloc.take_snapshot()
+  finally:
+    tracemalloc.stop()
+
+  only_data = [tracemalloc.DomainFilter(True, tracemalloc_domain)]
+  stats = snapshot.filter_traces(only_data).statistics('lineno')
+  assert len(stats) == 1
+  assert stats[0].size >= 8000
+  assert stats[0].traceback[0].lineno == line
+  assert not after.filter_traces(only_data).statistics('lineno')
@@ -0,0 +1,264 @@
+/**
+ * @date Fri 16 Oct 2026
+ *
+ * @brief A pool of threads splitting work on large arrays into tiles
+ */
+
+#define BOB_BLITZ_MODULE
+#include <bob.blitz/capi.h>
+#include "internal.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <pthread.h>
+
+/**
+ * Arrays with less bytes than this are processed serially: below it, waking
+ * up other threads costs more than what they would save
+ */
+static const size_t PARALLEL_THRESHOLD = 1 << 18;
+
+/**
+ * Size of the tiles large arrays are split into, in bytes: small enough for
+ * all operands of a tile to stay in the (L2) cache of the core processing it
+ */
+static const size_t TILE_BYTES = 1 << 16;
+
+typedef std::function<void(Py_ssize_t, int)> tile_function;
+
+/**
+ * Threads waiting for tiles to process. The thread submitting the work also
+ * processes tiles, as worker 0, until all tiles have been taken.
+ */
+class thread_pool {
+
+  public:
+
+    thread_pool(int threads): m_threads(threads), m_job(0), m_tiles(0),
+      m_workers(0), m_next(0), m_pending(0), m_generation(0), m_stop(false) {}
+
+    int threads() const { return m_threads; }
+
+    /**
+     * Stops all threads, which are started again (as many as requested) on
+     * the next run. Waits for the current run to finish, if any.
+     */
+    void resize(int threads) {
+      std::lock_guard<std::mutex> run(m_run);
+      stop();
+      m_threads = threads;
+    }
+
+    void run(Py_ssize_t tiles, int workers, const tile_function& work) {
+
+      // one parallel run at a time, others are serial
+      std::unique_lock<std::mutex> run(m_run, std::try_to_lock);
+      if (run.owns_lock()) workers = std::min(workers, m_threads.load());
+      if (tiles < 2 || workers < 2 || !run.owns_lock()) {
+        for (Py_ssize_t t=0; t<tiles; ++t) work(t, 0);
+        return;
+      }
+
+      try {
+        while ((int)m_pool.size() < m_threads - 1) {
+          // new threads only wait for the runs to come
+          const int id = m_pool.size() + 1;
+          m_pool.emplace_back(&thread_pool::loop, this, id, m_generation);
+        }
+      }
+      catch (...) {
+        // no more threads available: uses those already there
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &work;
+        m_tiles = tiles;
+        m_workers = workers;
+        m_next = 0;
+        m_pending = m_pool.size();
+        ++m_generation;
+      }
+      m_wake.notify_all();
+
+      drain(work, 0);
+
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_done.wait(lock, [this] { return m_pending == 0; });
+      m_job = 0;
+
+    }
+
+  private:
+
+    void drain(const tile_function& work, int worker) {
+      for (Py_ssize_t t = m_next++; t < m_tiles; t = m_next++) work(t, worker);
+    }
+
+    void loop(int id, unsigned long seen) {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      for (;;) {
+        m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+        if (m_stop) return;
+        seen = m_generation;
+        const tile_function* job = m_job;
+        const bool participate = id < m_workers;
+        lock.unlock();
+        if (participate) drain(*job, id);
+        lock.lock();
+        if (--m_pending == 0) m_done.notify_one();
+      }
+    }
+
+    void stop() {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+      }
+      m_wake.notify_all();
+      for (auto& t : m_pool) t.join();
+      m_pool.clear();
+      m_stop = false;
+    }
+
+    std::atomic<int> m_threads; ///< number of threads to use, including the caller's
+    std::vector<std::thread> m_pool;
+    std::mutex m_run; ///< held during runs and resizes
+    std::mutex m_mutex; ///< protects the job description below
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const tile_function* m_job;
+    Py_ssize_t m_tiles;
+    int m_workers;
+    std::atomic<Py_ssize_t> m_next;
+    size_t m_pending;
+    unsigned long m_generation;
+    bool m_stop;
+
+};
+
+static int default_threads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * Never deleted: threads of a pool still alive at exit must not be joined
+ * (nor destroyed while joinable) from static destructors
+ */
+static thread_pool* pool = new thread_pool(default_threads());
+
+/**
+ * References dropped by threads not holding the GIL, waiting for the main
+ * thread to run pending calls, along with whether the objects (arrays) are
+ * to be unpinned (see PyBlitzArray_DeferRelease()) as well
+ */
+struct deferred_decrefs {
+  std::mutex mutex;
+  std::vector<std::pair<PyObject*, bool>> objects;
+  bool scheduled;
+  deferred_decrefs(): scheduled(false) {}
+};
+
+static deferred_decrefs* deferred = new deferred_decrefs();
+
+/**
+ * Threads are not inherited by children of fork(): they start with a new
+ * pool, the old one (and its possibly locked mutexes) is abandoned, along
+ * with the references still to be dropped
+ */
+static void pool_after_fork() {
+  pool = new thread_pool(pool->threads());
+  deferred = new deferred_decrefs();
+}
+
+int PyBlitzThreads_Get() {
+  return pool->threads();
+}
+
+void PyBlitzThreads_Set(int threads) {
+  if (threads < 1) threads = default_threads();
+  Py_BEGIN_ALLOW_THREADS
+  pool->resize(threads);
+  Py_END_ALLOW_THREADS
+}
+
+Py_ssize_t PyBlitzThreads_Tiles(Py_ssize_t elements, size_t itemsize) {
+  const size_t bytes = elements * itemsize;
+  if (bytes < PARALLEL_THRESHOLD || pool->threads() < 2) return 1;
+  return (bytes + TILE_BYTES - 1) / TILE_BYTES;
+}
+
+void PyBlitzThreads_Run(Py_ssize_t tiles, int workers, const tile_function& work) {
+  pool->run(tiles, workers, work);
+}
+
+/**
+ * Drops a reference to `o', after unpinning its data if `unpin'. Requires the
+ * GIL.
+ */
+static void release(PyObject* o, bool unpin) {
+  if (unpin) --reinterpret_cast<PyBlitzArrayObject*>(o)->exports;
+  Py_DECREF(o);
+}
+
+static int run_deferred_decrefs(void*) {
+
+  std::vector<std::pair<PyObject*, bool>> objects;
+  {
+    std::lock_guard<std::mutex> lock(deferred->mutex);
+    objects.swap(deferred->objects);
+    deferred->scheduled = false;
+  }
+  for (auto& o : objects) release(o.first, o.second);
+  return 0;
+
+}
+
+static void defer_release(PyObject* o, bool unpin) {
+
+#if PY_VERSION_HEX >= 0x03040000
+  if (PyGILState_Check()) {
+    release(o, unpin);
+    return;
+  }
+#endif
+
+  // objects still referenced when the interpreter is gone are just leaked
+  if (!Py_IsInitialized()) return;
+
+  std::lock_guard<std::mutex> lock(deferred->mutex);
+  try {
+    deferred->objects.push_back(std::make_pair(o, unpin));
+  }
+  catch (...) {
+    return; // out of memory: leaks the object instead
+  }
+  // if the queue of pending calls is full, the next deferral retries
+  if (!deferred->scheduled)
+    deferred->scheduled = Py_AddPendingCall(run_deferred_decrefs, 0) == 0;
+
+}
+
+void PyBlitzArray_DeferDecRef(PyObject* o) {
+  defer_release(o, false);
+}
+
+void PyBlitzArray_DeferRelease(PyBlitzArrayObject* o) {
+  defer_release(reinterpret_cast<PyObject*>(o), true);
+}
+
+bool init_Threads() {
+
+  if (pthread_atfork(0, 0, pool_after_fork) != 0) {
+    PyErr_SetString(PyExc_RuntimeError, "cannot register the thread pool reset for forked processes");
+    return false;
+  }
+  return true;
+
+}
@@ -9,6 +9,24 @@
 #define BOB_IMPORT_VERSION
 #include <bob.blitz/config.h>
 #include <bob.blitz/cleanup.h>
+#include <sys/mman.h>
+
+/**
+ * Data allocation policies built in, and the one new arrays use until
+ * bob.blitz.set_allocator() is called. This is fixed at build time: the
+ * policy in use is returned by bob.blitz.get_allocator().
+ */
+static PyObject* allocator_version() {
+  return Py_BuildValue("{sssssO}",
+      "initial policy", "blitz",
+      "built-in policies", "blitz, malloc, aligned64, hugepage",
+#     ifdef MADV_HUGEPAGE
+      "huge pages", Py_True
+#     else
+      "huge pages", Py_False
+#     endif
+      );
+}
 
 static PyObject* build_version_dictionary() {
 
@@ -21,6 +39,7 @@ static PyObject* build_version_dictionary() {
   if (!dict_steal(retval, "Compiler", compiler_version())) return 0;
   if (!dict_steal(retval, "Python", python_version())) return 0;
   if (!dict_steal(retval, "NumPy", numpy_version())) return 0;
+  if (!dict_steal(retval, "Allocator", allocator_version())) return 0;
 
   return Py_BuildValue("O", retval);
 }
@@ -31,6 +31,13 @@ from distutils.version import LooseVersion
 if LooseVersion(numpy.__version__) >= LooseVersion('1.7'):
   define_macros.append(("NPY_NO_DEPRECATED_API", "NPY_1_7_API_VERSION"))
 
+# Extensions using our C-API import it (and numpy's) themselves
+import_macros = [k for k in define_macros if k[0] != "NO_IMPORT_ARRAY"]
+
+# shm_open() lives in librt on older GNU/Linux systems
+import sys
+libraries = ['rt'] if sys.platform.startswith('linux') else []
+
 # Pkg-config requirements
 packages = [
     'blitz >= 0.10',
@@ -76,6 +83,13 @@ setup(
         [
           "bob/blitz/api.cpp",
           "bob/blitz/array.cpp",
+          "bob/blitz/shared.cpp",
+          "bob/blitz/iterator.cpp",
+          "bob/blitz/expr.cpp",
+          "bob/blitz/reduce.cpp",
+          "bob/blitz/threads.cpp",
+          "bob/blitz/cast.cpp",
+          "bob/blitz/stats.cpp",
           "bob/blitz/main.cpp",
         ],
         packages=packages,
@@ -83,9 +97,27 @@ setup(
         define_macros=define_macros,
         include_dirs=[include_dir],
         system_include_dirs=system_include_dirs,
+        libraries=libraries,
+      ),
+
+      Extension("bob.blitz._benchmark",
+        [
+          "bob/blitz/benchmark.cpp",
+        ],
+        packages=packages,
+        version=version,
+        define_macros=import_macros,
+        include_dirs=[include_dir],
+        system_include_dirs=system_include_dirs,
       ),
     ],
 
+    entry_points = {
+      'console_scripts': [
+        'bob_blitz_benchmark.py = bob.blitz.script.benchmark:main',
+      ],
+    },
+
     cmdclass = {
       'build_ext': build_ext
     },